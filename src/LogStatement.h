@@ -94,6 +94,15 @@ public:
         return line.str();
     }
 
+    static const std::string planRecursiveRule(const std::string& relationName, const std::size_t version,
+            const SrcLocation& srcLocation, const std::string& datalogText, const std::string& plans) {
+        const char* messageType = "@plan-recursive-rule";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << version << ";" << str(srcLocation) << ";"
+             << datalogText << ";" << plans << ";";
+        return line.str();
+    }
+
     static const std::string tRecursiveRelation(
             const std::string& relationName, const SrcLocation& srcLocation) {
         const char* messageType = "@t-recursive-relation";
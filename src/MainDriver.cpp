@@ -39,6 +39,7 @@
 #include "ast/transform/InlineRelations.h"
 #include "ast/transform/InsertLatticeOperations.h"
 #include "ast/transform/MagicSet.h"
+#include "ast/transform/MagicSubroutines.h"
 #include "ast/transform/MaterializeAggregationQueries.h"
 #include "ast/transform/MaterializeSingletonAggregation.h"
 #include "ast/transform/MinimiseProgram.h"
@@ -522,7 +523,8 @@ Own<ast::transform::PipelineTransformer> astTransformationPipeline(Global& glb)
             std::move(magicPipeline), mk<ast::transform::RemoveEmptyRelationsTransformer>(),
             mk<ast::transform::AddNullariesToAtomlessAggregatesTransformer>(),
             mk<ast::transform::ExecutionPlanChecker>(), std::move(provenancePipeline),
-            mk<ast::transform::IOAttributesTransformer>());
+            mk<ast::transform::IOAttributesTransformer>(),
+            mk<ast::transform::MagicSubroutinesTransformer>());
     // clang-format on
 
     return pipeline;
@@ -653,6 +655,9 @@ std::vector<MainOption> getMainOptions() {
     // clang-format off
   std::vector<MainOption> options{
       {"", 0, "", "", false, ""},
+      {"adaptive-join-order", nextOptChar++, "", "", false,
+          "Translate recursive rules with several join orders, of which the interpreter chooses "
+          "one in each iteration based on the current relation sizes."},
       {"auto-schedule", 'a', "FILE", "", false,
           "Use profile auto-schedule <FILE> for auto-scheduling."},
       {"compile", 'c', "", "", false,
@@ -682,12 +687,21 @@ std::vector<MainOption> getMainOptions() {
       {"generate-namespace", 'N', "NS", "", false,
        "The namespace of generated C++ source code. Empty name denotes the anonymous "
        "namespace."},
+      {"generic-relations", nextOptChar++, "", "", false,
+          "Store the relations of the interpreter in generic data structures instead of ones "
+          "specialised to their arity."},
       {"help", 'h', "", "", false,
           "Display this help message."},
       {"include-dir", 'I', "DIR", ".", true,
           "Specify directory for include files."},
+      {"incremental", nextOptChar++, "", "", false,
+          "Generate a subroutine that updates the relations after tuples were added to or "
+          "removed from the input relations."},
       {"inline-exclude", nextOptChar++, "RELATIONS", "", false,
           "Prevent the given relations from being inlined. Overrides any `inline` qualifiers."},
+      {"insert-buffers", nextOptChar++, "", "", false,
+          "Collect the tuples derived by parallel rules in thread-local buffers and "
+          "merge them into their relations at the end of each rule."},
       {"jobs", 'j', "N", "1", false,
           "Run interpreter/compiler in parallel using N threads, N=auto for system "
           "default."},
@@ -701,6 +715,9 @@ std::vector<MainOption> getMainOptions() {
           "Enable live profiling."},
       {"macro", 'M', "MACROS", "", false,
           "Set macro definitions for the pre-processor"},
+      {"magic-subroutines", nextOptChar++, "QUERIES", "", false,
+          "Generate a subroutine evaluating each given query on demand. Queries are given "
+          "as relation:pattern, marking each attribute as bound (b) or free (f)."},
       {"magic-transform", 'm', "RELATIONS", "", false,
           "Enable magic set transformation changes on the given relations, use '*' "
           "for all."},
@@ -723,6 +740,10 @@ std::vector<MainOption> getMainOptions() {
           "Enable profiling, and write profile data to <FILE>."},
       {"profile-frequency", nextOptChar++, "", "", false,
           "Enable the frequency counter in the profiler."},
+      {"profile-counters", nextOptChar++, "", "", false,
+          "Sample performance counters and scanned tuples for each rule in the profiler."},
+      {"profile-trace", nextOptChar++, "FILE", "", false,
+          "Write a timeline of the profiled evaluation to <FILE> in the Chrome trace-event format."},
       {"provenance", 't', "[ none | explain | explore ]", "", false,
           "Enable provenance instrumentation and interaction."},
       {"show", nextOptChar++, "[ <see-list> ]", "", true,
@@ -859,6 +880,26 @@ int main(Global& glb, const char* souffle_executable) {
             glb.config().set("profile");
         }
 
+        if (glb.config().has("incremental") && glb.config().has("provenance")) {
+            throw std::runtime_error("incremental evaluation cannot be combined with provenance");
+        }
+
+        if (glb.config().has("adaptive-join-order") && glb.config().has("provenance")) {
+            throw std::runtime_error("adaptive join orders cannot be combined with provenance");
+        }
+
+        /* if profile-counters is set then check that the profiler is also set */
+        if (glb.config().has("profile-counters")) {
+            if (!glb.config().has("profile"))
+                throw std::runtime_error("must be profiling to use profile-counters");
+        }
+
+        /* if profile-trace is set then check that the profiler is also set */
+        if (glb.config().has("profile-trace")) {
+            if (!glb.config().has("profile"))
+                throw std::runtime_error("must be profiling to use profile-trace");
+        }
+
         /* if emit-statistics is set then check that the profiler is also set */
         if (glb.config().has("emit-statistics")) {
             if (!glb.config().has("profile"))
@@ -15,6 +15,7 @@
  ***********************************************************************/
 
 #include "ast/analysis/IOType.h"
+#include "Global.h"
 #include "ast/Directive.h"
 #include "ast/Program.h"
 #include "ast/QualifiedName.h"
@@ -22,9 +23,12 @@
 #include "ast/TranslationUnit.h"
 #include "ast/utility/Utils.h"
 #include "ast/utility/Visitor.h"
+#include "souffle/utility/FunctionalUtil.h"
 #include "souffle/utility/StreamUtil.h"
+#include "souffle/utility/StringUtil.h"
 #include <cassert>
 #include <ostream>
+#include <string>
 #include <vector>
 
 namespace souffle::ast::analysis {
@@ -50,6 +54,39 @@ void IOTypeAnalysis::run(const TranslationUnit& translationUnit) {
                 break;
         }
     });
+
+    // Queries are given as relation:pattern, e.g. path:bf
+    const auto& config = translationUnit.global().config();
+    if (!config.has("magic-subroutines")) {
+        return;
+    }
+    for (const auto& queryStr : splitString(config.get("magic-subroutines"), ',')) {
+        if (queryStr.empty()) {
+            continue;
+        }
+        std::size_t separator = queryStr.rfind(':');
+        Query query;
+        query.relation = QualifiedName::fromString(queryStr.substr(0, separator));
+        query.pattern = separator == std::string::npos ? "" : queryStr.substr(separator + 1);
+
+        // relations only evaluated on demand are replaced by the answers of their queries
+        const Relation* relation = program.getRelation(query.relation);
+        const Relation* answer = relation;
+        if (answer == nullptr) {
+            answer = program.getRelation(query.getRelationName("@answer"));
+        }
+        if (answer == nullptr || answer->getArity() == 0 || answer->getArity() != query.pattern.size() ||
+                query.pattern.find_first_not_of("bf") != std::string::npos) {
+            malformedQueries.push_back(query);
+            continue;
+        }
+        if (relation != nullptr) {
+            queryRelations.insert(relation);
+        }
+        if (none_of(queries, [&](const Query& other) { return other.getName() == query.getName(); })) {
+            queries.push_back(query);
+        }
+    }
 }
 
 void IOTypeAnalysis::print(std::ostream& os) const {
@@ -58,6 +95,7 @@ void IOTypeAnalysis::print(std::ostream& os) const {
     os << "output relations: {" << join(outputRelations, ", ", show) << "}\n";
     os << "printsize relations: {" << join(printSizeRelations, ", ", show) << "}\n";
     os << "limitsize relations: {" << join(limitSizeRelations, ", ", show) << "}\n";
+    os << "query relations: {" << join(queryRelations, ", ", show) << "}\n";
 }
 
 }  // namespace souffle::ast::analysis
@@ -16,13 +16,16 @@
 
 #pragma once
 
+#include "ast/QualifiedName.h"
 #include "ast/Relation.h"
 #include "ast/TranslationUnit.h"
+#include <algorithm>
 #include <iosfwd>
 #include <map>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace souffle::ast {
 
@@ -34,6 +37,29 @@ class IOTypeAnalysis : public Analysis {
 public:
     static constexpr const char* name = "IO-type-analysis";
 
+    /** A relation queried on demand, with one 'b' (bound) or 'f' (free) per attribute */
+    struct Query {
+        QualifiedName relation;
+        std::string pattern;
+
+        /** Name of the subroutine answering the query */
+        std::string getName() const {
+            return "@query:" + relation.toString() + ":" + pattern;
+        }
+
+        /** Qualifier of the relations answering the query; a single segment, hence without dots */
+        std::string getPrefix() const {
+            std::string prefix = getName();
+            std::replace(prefix.begin(), prefix.end(), '.', ':');
+            return prefix;
+        }
+
+        /** Name of a relation of the program answering the query */
+        QualifiedName getRelationName(const std::string& name) const {
+            return getPrefix() + QualifiedName::fromString(name);
+        }
+    };
+
     IOTypeAnalysis() : Analysis(name) {}
 
     void run(const TranslationUnit& translationUnit) override;
@@ -64,8 +90,22 @@ public:
             return 0;
     }
 
+    bool isQuery(const Relation* relation) const {
+        return queryRelations.count(relation) != 0;
+    }
+
+    /** Queries given by the magic-subroutines option */
+    const std::vector<Query>& getQueries() const {
+        return queries;
+    }
+
+    /** Queries naming an undefined relation or with a pattern not matching its arity */
+    const std::vector<Query>& getMalformedQueries() const {
+        return malformedQueries;
+    }
+
     bool isIO(const Relation* relation) const {
-        return isInput(relation) || isOutput(relation) || isPrintSize(relation);
+        return isInput(relation) || isOutput(relation) || isPrintSize(relation) || isQuery(relation);
     }
 
 private:
@@ -74,6 +114,9 @@ private:
     RelationSet printSizeRelations;
     RelationSet limitSizeRelations;
     std::map<const Relation*, std::size_t> limitSize;
+    RelationSet queryRelations;
+    std::vector<Query> queries;
+    std::vector<Query> malformedQueries;
 };
 
 }  // namespace analysis
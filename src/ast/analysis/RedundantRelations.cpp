@@ -39,9 +39,9 @@ void RedundantRelationsAnalysis::run(const TranslationUnit& translationUnit) {
     Program& program = translationUnit.getProgram();
 
     const std::vector<Relation*>& relations = program.getRelations();
-    /* Add all output relations to the work set */
+    /* Add all output and query relations to the work set */
     for (const Relation* r : relations) {
-        if (ioType.isOutput(r)) {
+        if (ioType.isOutput(r) || ioType.isQuery(r)) {
             work.insert(r);
         }
     }
@@ -0,0 +1,191 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file MagicSubroutines.cpp
+ *
+ ***********************************************************************/
+
+#include "ast/transform/MagicSubroutines.h"
+#include "RelationTag.h"
+#include "ast/Atom.h"
+#include "ast/Attribute.h"
+#include "ast/Clause.h"
+#include "ast/Directive.h"
+#include "ast/Program.h"
+#include "ast/QualifiedName.h"
+#include "ast/Relation.h"
+#include "ast/TranslationUnit.h"
+#include "ast/Variable.h"
+#include "ast/analysis/IOType.h"
+#include "ast/analysis/PrecedenceGraph.h"
+#include "ast/transform/ExpandEqrels.h"
+#include "ast/transform/MagicSet.h"
+#include "ast/transform/Pipeline.h"
+#include "ast/transform/RemoveEmptyRelations.h"
+#include "ast/transform/RemoveRelationCopies.h"
+#include "ast/transform/ResolveAliases.h"
+#include "ast/utility/Utils.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/MiscUtil.h"
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace souffle::ast::transform {
+
+bool MagicSubroutinesTransformer::transform(TranslationUnit& translationUnit) {
+    Program& program = translationUnit.getProgram();
+    const auto& ioTypes = translationUnit.getAnalysis<analysis::IOTypeAnalysis>();
+    const auto& precedenceGraph = translationUnit.getAnalysis<analysis::PrecedenceGraphAnalysis>().graph();
+
+    // The main program evaluates the IO relations other than queries, and all relations they depend on
+    RelationSet roots;
+    for (const auto* rel : program.getRelations()) {
+        if (ioTypes.isIO(rel) && !ioTypes.isQuery(rel)) {
+            roots.insert(rel);
+        }
+    }
+    UnorderedQualifiedNameSet evaluated;
+    for (const auto* rel : precedenceGraph.reachableFromPred(roots)) {
+        evaluated.insert(rel->getQualifiedName());
+    }
+
+    VecOwn<Relation> queryRelations;
+    VecOwn<Clause> queryClauses;
+    UnorderedQualifiedNameSet demandedRelations;
+    for (const auto& query : ioTypes.getQueries()) {
+        // Queries on evaluated relations are answered from the relation itself
+        if (contains(evaluated, query.relation)) {
+            continue;
+        }
+        const Relation* relation = program.getRelation(query.relation);
+        assert(relation != nullptr && "query relation does not exist");
+        UnorderedQualifiedNameSet dependencies;
+        for (const auto* rel : precedenceGraph.reachableFromPred(relation)) {
+            dependencies.insert(rel->getQualifiedName());
+            if (!contains(evaluated, rel->getQualifiedName())) {
+                demandedRelations.insert(rel->getQualifiedName());
+            }
+        }
+
+        // The program of the query reads the evaluated relations and derives the others on demand
+        auto queryProgram = clone(program);
+        UnorderedQualifiedNameSet unrelated;
+        for (auto& [name, info] : queryProgram->getRelationInfo()) {
+            info.directives.clear();
+            if (!contains(dependencies, name)) {
+                unrelated.insert(name);
+            } else if (contains(evaluated, name)) {
+                info.clauses.clear();
+                info.directives.push_back(mk<Directive>(DirectiveType::input, name));
+                for (auto& decl : info.decls) {
+                    decl->setRepresentation(RelationRepresentation::DEFAULT);
+                }
+            } else {
+                for (auto& decl : info.decls) {
+                    decl->addQualifier(RelationQualifier::MAGIC);
+                }
+            }
+        }
+        for (const auto& name : unrelated) {
+            queryProgram->removeRelation(name);
+        }
+
+        // Answer the query for the seeded bindings, i.e., @answer(x0,...) :- @seed(xi,...), R(x0,...).
+        const auto seedName = QualifiedName::fromString("@seed");
+        const auto answerName = QualifiedName::fromString("@answer");
+        auto seed = mk<Relation>(seedName);
+        auto answer = mk<Relation>(answerName);
+        auto seedAtom = mk<Atom>(seedName);
+        auto queryAtom = mk<Atom>(query.relation);
+        auto answerClause = mk<Clause>(answerName);
+        for (std::size_t i = 0; i < query.pattern.size(); i++) {
+            const auto* attribute = relation->getAttributes()[i];
+            std::string var = "@var" + std::to_string(i);
+            answer->addAttribute(clone(attribute));
+            answerClause->getHead()->addArgument(mk<ast::Variable>(var));
+            queryAtom->addArgument(mk<ast::Variable>(var));
+            if (query.pattern[i] == 'b') {
+                seed->addAttribute(clone(attribute));
+                seedAtom->addArgument(mk<ast::Variable>(var));
+            }
+        }
+        answerClause->addToBody(std::move(seedAtom));
+        answerClause->addToBody(std::move(queryAtom));
+
+        // Keep the seed around, as it may be dropped if the query has no answers
+        auto seen = clone(seed);
+        seen->setQualifiedName(query.getRelationName("@seen"));
+        queryRelations.push_back(std::move(seen));
+        auto querySeed = clone(seed);
+        querySeed->setQualifiedName(query.getRelationName("@seed"));
+        queryRelations.push_back(std::move(querySeed));
+
+        queryProgram->addRelation(std::move(seed));
+        queryProgram->addRelation(std::move(answer));
+        queryProgram->addClause(std::move(answerClause));
+        queryProgram->addDirective(mk<Directive>(DirectiveType::input, seedName));
+        queryProgram->addDirective(mk<Directive>(DirectiveType::output, answerName));
+
+        // Apply the magic-set transformation
+        TranslationUnit queryUnit(translationUnit.global(), std::move(queryProgram),
+                translationUnit.getErrorReport(), translationUnit.getDebugReport());
+        auto magicPipeline = mk<PipelineTransformer>(mk<ExpandEqrelsTransformer>(),
+                mk<MagicSetTransformer>(), mk<ResolveAliasesTransformer>(),
+                mk<RemoveRelationCopiesTransformer>(), mk<RemoveEmptyRelationsTransformer>());
+        magicPipeline->apply(queryUnit);
+
+        // Move the relations the answer depends on into the namespace of the query
+        const Program& magicProgram = queryUnit.getProgram();
+        const auto& magicGraph = queryUnit.getAnalysis<analysis::PrecedenceGraphAnalysis>().graph();
+        UnorderedQualifiedNameMap<QualifiedName> renaming;
+        renaming[seedName] = query.getRelationName("@seed");
+        const Relation* magicAnswer = magicProgram.getRelation(answerName);
+        assert(magicAnswer != nullptr && "answer of query does not exist");
+        for (const auto* rel : magicGraph.reachableFromPred(magicAnswer)) {
+            const auto& name = rel->getQualifiedName();
+            if (name == seedName || contains(evaluated, name)) {
+                continue;
+            }
+            renaming[name] = query.getPrefix() + name;
+
+            auto queryRelation = clone(rel);
+            queryRelation->setQualifiedName(renaming[name]);
+            queryRelations.push_back(std::move(queryRelation));
+        }
+        for (const auto& [name, queryName] : renaming) {
+            for (const auto* clause : magicProgram.getClauses(name)) {
+                auto queryClause = clone(clause);
+                renameAtoms(queryClause, renaming);
+                queryClauses.push_back(std::move(queryClause));
+            }
+        }
+    }
+
+    if (queryRelations.empty()) {
+        return false;
+    }
+
+    // Relations only queries depend on are no longer evaluated by the main program
+    for (const auto& name : demandedRelations) {
+        program.removeRelation(name);
+    }
+    for (auto& rel : queryRelations) {
+        program.addRelation(std::move(rel));
+    }
+    for (auto& clause : queryClauses) {
+        program.addClause(std::move(clause));
+    }
+    return true;
+}
+
+}  // namespace souffle::ast::transform
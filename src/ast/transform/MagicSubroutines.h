@@ -0,0 +1,51 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file MagicSubroutines.h
+ *
+ * Transformation pass deriving demand-driven programs for queries.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ast/TranslationUnit.h"
+#include "ast/transform/Transformer.h"
+#include <string>
+
+namespace souffle::ast::transform {
+
+/**
+ * Derives the program answering each query given by the magic-subroutines option.
+ *
+ * A query on relation R with binding pattern P is answered by the relation
+ * @query:R:P.@answer, computed from the bound attributes inserted into
+ * @query:R:P.@seed. Its rules are the magic-set transformation of the part of
+ * the program R depends on, in which relations evaluated by the main program
+ * anyway are read rather than derived again. Relations only queries depend on
+ * are no longer evaluated by the main program.
+ *
+ * Queries on relations evaluated by the main program need no rules of their own.
+ */
+class MagicSubroutinesTransformer : public Transformer {
+public:
+    std::string getName() const override {
+        return "MagicSubroutinesTransformer";
+    }
+
+private:
+    MagicSubroutinesTransformer* cloning() const override {
+        return new MagicSubroutinesTransformer();
+    }
+
+    bool transform(TranslationUnit& translationUnit) override;
+};
+
+}  // namespace souffle::ast::transform
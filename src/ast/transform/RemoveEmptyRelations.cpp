@@ -53,7 +53,7 @@ bool RemoveEmptyRelationsTransformer::removeEmptyRelations(TranslationUnit& tran
         emptyRelations.insert(rel->getQualifiedName());
 
         bool usedInAggregate = contains(atoms_in_aggs, rel->getQualifiedName());
-        if (!usedInAggregate && !ioTypes.isOutput(rel)) {
+        if (!usedInAggregate && !ioTypes.isOutput(rel) && !ioTypes.isQuery(rel)) {
             program.removeRelation(*rel);
             changed = true;
         }
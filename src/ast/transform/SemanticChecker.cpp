@@ -841,6 +841,19 @@ void SemanticCheckerImpl::checkIO() {
     for (const auto* directive : program.getDirectives()) {
         checkIO(directive);
     }
+
+    for (const auto& query : ioTypes.getMalformedQueries()) {
+        std::string message = "Undefined query relation " + toString(query.relation);
+        const auto* relation = program.getRelation(query.relation);
+        if (relation != nullptr && relation->getArity() == 0) {
+            message = "Nullary relation " + toString(query.relation) + " cannot be queried";
+        } else if (relation != nullptr) {
+            message = "Query pattern '" + query.pattern + "' of relation " + toString(query.relation) +
+                      " must have one 'b' or 'f' for each of its " + std::to_string(relation->getArity()) +
+                      " attributes";
+        }
+        report.addDiagnostic(Diagnostic(Diagnostic::Type::ERROR, DiagnosticMessage(message)));
+    }
 }
 
 /**
@@ -38,6 +38,7 @@
 #include "ast2ram/utility/TranslatorContext.h"
 #include "ast2ram/utility/Utils.h"
 #include "ast2ram/utility/ValueIndex.h"
+#include "ram/AdaptivePlan.h"
 #include "ram/Aggregate.h"
 #include "ram/Break.h"
 #include "ram/Constraint.h"
@@ -64,7 +65,10 @@
 #include "ram/UserDefinedAggregator.h"
 #include "ram/utility/Utils.h"
 #include "souffle/TypeAttribute.h"
+#include "souffle/utility/StreamUtil.h"
 #include "souffle/utility/StringUtil.h"
+#include <algorithm>
+#include <iterator>
 #include <map>
 #include <unordered_set>
 #include <vector>
@@ -113,8 +117,13 @@ Own<ram::Statement> ClauseTranslator::translateRecursiveClause(
             [&](auto* atom) { return contains(scc, context.getProgram()->getRelation(*atom)); });
     this->version = version;
 
-    // Translate the resultant clause as would be done normally
-    Own<ram::Statement> rule = translateNonRecursiveClause(clause);
+    // Translate the resultant clause as would be done normally, possibly with alternative join orders
+    Own<ram::Statement> rule;
+    if (context.getGlobal()->config().has("adaptive-join-order")) {
+        rule = translateAdaptiveClause(clause);
+    } else {
+        rule = translateNonRecursiveClause(clause);
+    }
 
     // Add logging
     if (context.getGlobal()->config().has("profile")) {
@@ -140,6 +149,51 @@ Own<ram::Statement> ClauseTranslator::translateRecursiveClause(
     return mk<ram::Sequence>(std::move(rule));
 }
 
+Own<ram::Statement> ClauseTranslator::translateAdaptiveClause(const ast::Clause& clause) {
+    if (isFact(clause)) {
+        return translateNonRecursiveClause(clause);
+    }
+
+    VecOwn<ram::Statement> plans;
+    std::vector<std::string> planTexts;
+    for (const auto& order : getCandidateOrderings(clause)) {
+        // Translate the clause from scratch with the given order
+        valueIndex = mk<ValueIndex>();
+        generators.clear();
+        operators.clear();
+        atomOrder = order;
+        auto plan = createRamRuleQuery(clause);
+        atomOrder.clear();
+
+        // Orders that only differ in atoms without a scan level may result in the same plan
+        if (std::any_of(plans.begin(), plans.end(), [&](const auto& other) { return *other == *plan; })) {
+            continue;
+        }
+        plans.push_back(std::move(plan));
+
+        // Describe the order as an execution plan would
+        std::stringstream text;
+        text << "(";
+        for (std::size_t i = 0; i < order.size(); i++) {
+            text << (i > 0 ? "," : "") << order[i] + 1;
+        }
+        text << ")";
+        planTexts.push_back(text.str());
+    }
+
+    if (plans.size() == 1) {
+        return std::move(plans[0]);
+    }
+
+    std::string message;
+    if (context.getGlobal()->config().has("profile")) {
+        const std::string& relationName = getConcreteRelationName(clause.getHead()->getQualifiedName());
+        message = LogStatement::planRecursiveRule(relationName, version, clause.getSrcLoc(),
+                stringify(toString(clause)), toString(join(planTexts, " ")));
+    }
+    return mk<ram::AdaptivePlan>(std::move(plans), message);
+}
+
 Own<ram::Statement> ClauseTranslator::translateNonRecursiveClause(const ast::Clause& clause) {
     // Create the appropriate query
     if (isFact(clause)) {
@@ -666,6 +720,11 @@ Own<ram::Condition> ClauseTranslator::getFunctionalDependencies(const ast::Claus
 std::vector<ast::Atom*> ClauseTranslator::getAtomOrdering(const ast::Clause& clause) const {
     auto atoms = ast::getBodyLiterals<ast::Atom>(clause);
 
+    // stick to the order under translation if one is imposed
+    if (!atomOrder.empty()) {
+        return reorderAtoms(atoms, atomOrder);
+    }
+
     // stick to the plan if we have one set
     auto* plan = clause.getExecutionPlan();
     if (plan != nullptr) {
@@ -688,6 +747,39 @@ std::vector<ast::Atom*> ClauseTranslator::getAtomOrdering(const ast::Clause& cla
     return reorderAtoms(atoms, newOrder);
 }
 
+std::vector<std::vector<std::size_t>> ClauseTranslator::getCandidateOrderings(
+        const ast::Clause& clause) const {
+    // the number of candidates, and thus the size of the program, grows with the number of atoms
+    constexpr std::size_t maxAtoms = 8;
+    const auto atoms = ast::getBodyLiterals<ast::Atom>(clause);
+
+    // the order chosen at compile time comes first
+    std::vector<std::size_t> staticOrder;
+    for (const auto* atom : getAtomOrdering(clause)) {
+        staticOrder.push_back(static_cast<std::size_t>(
+                std::distance(atoms.begin(), std::find(atoms.begin(), atoms.end(), atom))));
+    }
+    std::vector<std::vector<std::size_t>> orders{staticOrder};
+
+    // orders given by an execution plan are not changed
+    const auto* plan = clause.getExecutionPlan();
+    if ((plan != nullptr && contains(plan->getOrders(), version)) || atoms.size() > maxAtoms) {
+        return orders;
+    }
+
+    // each other atom may become the outermost one, followed by the remaining atoms in the static order
+    for (std::size_t i = 1; i < staticOrder.size(); i++) {
+        std::vector<std::size_t> order{staticOrder[i]};
+        for (std::size_t j = 0; j < staticOrder.size(); j++) {
+            if (j != i) {
+                order.push_back(staticOrder[j]);
+            }
+        }
+        orders.push_back(order);
+    }
+    return orders;
+}
+
 std::size_t ClauseTranslator::addOperatorLevel(const ast::Node* node) {
     std::size_t nodeLevel = operators.size() + generators.size();
     operators.push_back(node);
@@ -63,6 +63,9 @@ protected:
     std::size_t version{0};
     std::vector<ast::Atom*> sccAtoms{};
 
+    /** Order imposed on the body atoms, if not empty; v[i] = j iff atom j moves to pos i */
+    std::vector<std::size_t> atomOrder{};
+
     bool isRecursive() const;
 
     std::string getClauseString(const ast::Clause& clause) const;
@@ -84,6 +87,8 @@ protected:
     virtual Own<ram::Condition> createCondition(const ast::Clause& clause) const;
 
     std::vector<ast::Atom*> getAtomOrdering(const ast::Clause& clause) const;
+    std::vector<std::vector<std::size_t>> getCandidateOrderings(const ast::Clause& clause) const;
+    Own<ram::Statement> translateAdaptiveClause(const ast::Clause& clause);
 
     /** Indexing */
     void indexClause(const ast::Clause& clause);
@@ -16,12 +16,17 @@
 #include "Global.h"
 #include "LogStatement.h"
 #include "RelationTag.h"
+#include "ast/Aggregator.h"
+#include "ast/Atom.h"
 #include "ast/Clause.h"
+#include "ast/Counter.h"
 #include "ast/Directive.h"
+#include "ast/Negation.h"
 #include "ast/Relation.h"
 #include "ast/SubsumptiveClause.h"
 #include "ast/TranslationUnit.h"
 #include "ast/UserDefinedFunctor.h"
+#include "ast/analysis/IOType.h"
 #include "ast/analysis/TopologicallySortedSCCGraph.h"
 #include "ast/utility/Utils.h"
 #include "ast/utility/Visitor.h"
@@ -50,6 +55,7 @@
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
 #include "ram/MergeExtend.h"
+#include "ram/MergeInsert.h"
 #include "ram/Negation.h"
 #include "ram/Parallel.h"
 #include "ram/Program.h"
@@ -60,8 +66,11 @@
 #include "ram/Sequence.h"
 #include "ram/SignedConstant.h"
 #include "ram/Statement.h"
+#include "ram/SubroutineArgument.h"
+#include "ram/SubroutineReturn.h"
 #include "ram/Swap.h"
 #include "ram/TranslationUnit.h"
+#include "ram/True.h"
 #include "ram/TupleElement.h"
 #include "ram/UndefValue.h"
 #include "ram/UnsignedConstant.h"
@@ -176,27 +185,7 @@ Own<ram::Statement> UnitTranslator::generateStratum(std::size_t scc) const {
     }
 
     // Compute the current stratum
-    const auto& sccRelations = context->getRelationsInSCC(scc);
-    if (context->isRecursiveSCC(scc)) {
-        appendStmt(current, generateRecursiveStratum(sccRelations, scc));
-    } else {
-        assert(sccRelations.size() == 1 && "only one relation should exist in non-recursive stratum");
-        const auto* rel = *sccRelations.begin();
-        appendStmt(current, generateNonRecursiveRelation(*rel));
-
-        // lub auxiliary arities using the @lub relation
-        if (rel->getAuxiliaryArity() > 0) {
-            std::string mainRelation = getConcreteRelationName(rel->getQualifiedName());
-            std::string newRelation = getNewRelationName(rel->getQualifiedName());
-            std::string deltaRelation = getDeltaRelationName(rel->getQualifiedName());
-            appendStmt(current, generateStratumLubSequence(*rel, false));
-            std::map<std::string, std::string> directives;
-            appendStmt(current, mk<ram::Clear>(newRelation));
-        }
-
-        // issue delete sequence for non-recursive subsumptions
-        appendStmt(current, generateNonRecursiveDelete(*rel));
-    }
+    appendStmt(current, generateStratumComputation(scc));
 
     // Get all non-recursive relation statements
     auto nonRecursiveJoinSizeStatements = context->getNonRecursiveJoinSizeStatementsInSCC(scc);
@@ -211,6 +200,29 @@ Own<ram::Statement> UnitTranslator::generateStratum(std::size_t scc) const {
     return mk<ram::Sequence>(std::move(current));
 }
 
+Own<ram::Statement> UnitTranslator::generateStratumComputation(std::size_t scc) const {
+    const auto& sccRelations = context->getRelationsInSCC(scc);
+    if (context->isRecursiveSCC(scc)) {
+        return generateRecursiveStratum(sccRelations, scc);
+    }
+
+    VecOwn<ram::Statement> current;
+    assert(sccRelations.size() == 1 && "only one relation should exist in non-recursive stratum");
+    const auto* rel = *sccRelations.begin();
+    appendStmt(current, generateNonRecursiveRelation(*rel));
+
+    // lub auxiliary arities using the @lub relation
+    if (rel->getAuxiliaryArity() > 0) {
+        std::string newRelation = getNewRelationName(rel->getQualifiedName());
+        appendStmt(current, generateStratumLubSequence(*rel, false));
+        appendStmt(current, mk<ram::Clear>(newRelation));
+    }
+
+    // issue delete sequence for non-recursive subsumptions
+    appendStmt(current, generateNonRecursiveDelete(*rel));
+    return mk<ram::Sequence>(std::move(current));
+}
+
 Own<ram::Statement> UnitTranslator::generateClearExpiredRelations(
         const ast::RelationSet& expiredRelations) const {
     VecOwn<ram::Statement> stmts;
@@ -275,6 +287,10 @@ Own<ram::Statement> UnitTranslator::generateMergeRelations(
     if (rel->getRepresentation() == RelationRepresentation::EQREL) {
         return mk<ram::MergeExtend>(destRelation, srcRelation);
     }
+    // Merge as sorted batches unless lattice values need to be combined tuple by tuple
+    if (rel->getAuxiliaryArity() == 0) {
+        return mk<ram::MergeInsert>(destRelation, srcRelation);
+    }
     for (std::size_t i = 0; i < rel->getArity(); i++) {
         values.push_back(mk<ram::TupleElement>(0, i));
     }
@@ -283,6 +299,47 @@ Own<ram::Statement> UnitTranslator::generateMergeRelations(
     return stmt;
 }
 
+Own<ram::Statement> UnitTranslator::generateCopyRelation(
+        const ast::Relation* rel, const std::string& destRelation, const std::string& srcRelation) const {
+    // Equivalence relations are snapshotted into plain relations, so merge them tuple by tuple
+    if (rel->getArity() == 0 || rel->getRepresentation() != RelationRepresentation::EQREL) {
+        return generateMergeRelations(rel, destRelation, srcRelation);
+    }
+    VecOwn<ram::Expression> values;
+    for (std::size_t i = 0; i < rel->getArity(); i++) {
+        values.push_back(mk<ram::TupleElement>(0, i));
+    }
+    auto insertion = mk<ram::Insert>(destRelation, std::move(values));
+    return mk<ram::Query>(mk<ram::Scan>(srcRelation, 0, std::move(insertion)));
+}
+
+Own<ram::Statement> UnitTranslator::generateRelationDifference(const ast::Relation* rel,
+        const std::string& destRelation, const std::string& srcRelation,
+        const std::string& subtrahendRelation) const {
+    VecOwn<ram::Expression> values;
+    VecOwn<ram::Expression> values2;
+
+    // Proposition - insert if only the source holds
+    if (rel->getArity() == 0) {
+        auto insertion = mk<ram::Insert>(destRelation, std::move(values));
+        return mk<ram::Query>(mk<ram::Filter>(
+                mk<ram::Conjunction>(mk<ram::Negation>(mk<ram::EmptinessCheck>(srcRelation)),
+                        mk<ram::EmptinessCheck>(subtrahendRelation)),
+                std::move(insertion)));
+    }
+
+    // Predicate - insert all values missing from the subtrahend
+    for (std::size_t i = 0; i < rel->getArity(); i++) {
+        values.push_back(mk<ram::TupleElement>(0, i));
+        values2.push_back(mk<ram::TupleElement>(0, i));
+    }
+    auto insertion = mk<ram::Insert>(destRelation, std::move(values));
+    auto filtered = mk<ram::Filter>(
+            mk<ram::Negation>(mk<ram::ExistenceCheck>(subtrahendRelation, std::move(values2))),
+            std::move(insertion));
+    return mk<ram::Query>(mk<ram::Scan>(srcRelation, 0, std::move(filtered)));
+}
+
 Own<ram::Statement> UnitTranslator::generateDebugRelation(const ast::Relation* rel,
         const std::string& destRelation, const std::string& srcRelation,
         Own<ram::Expression> iteration) const {
@@ -567,13 +624,16 @@ Own<ram::Statement> UnitTranslator::generateStratumLoopBody(const ast::RelationS
         return stmt;
     };
 
-    // first translate regular recursive clauses
+    // first translate regular recursive clauses; each relation only writes its own
+    // @new relation, so the clauses of different relations may run in parallel
+    VecOwn<ram::Statement> recursiveClauses;
     for (const ast::Relation* rel : scc) {
         auto relClauses = translateRecursiveClauses(scc, rel);
         // add profiling information
         relClauses = addProfiling(rel, std::move(relClauses));
-        appendStmt(loopBody, mk<ram::Sequence>(std::move(relClauses)));
+        appendStmt(recursiveClauses, mk<ram::Sequence>(std::move(relClauses)));
     }
+    appendStmt(loopBody, mk<ram::Parallel>(std::move(recursiveClauses)));
 
     // translating subsumptive clauses
     for (const ast::Relation* rel : scc) {
@@ -782,6 +842,258 @@ Own<ram::Statement> UnitTranslator::generateRecursiveStratum(
     return mk<ram::Sequence>(std::move(result));
 }
 
+/**
+ * Incremental evaluation
+ *
+ * With --incremental the program gets an additional subroutine that brings the
+ * relations up to date after tuples were added to (or removed from) the input
+ * relations of a completed run. Each relation R has two companions:
+ *  - @prev_R holds the last evaluated state of input relations, and the state
+ *    before recomputation of derived ones,
+ *  - @diff_R holds the tuples R gained in the current increment.
+ *
+ * A stratum is skipped if none of the relations it depends on changed. Monotone
+ * strata whose dependencies only gained tuples are updated semi-naively from the
+ * @diff relations of their dependencies; all other changed strata are
+ * recomputed from scratch.
+ */
+bool UnitTranslator::isIncrementalSCC(std::size_t scc) const {
+    for (const ast::Relation* rel : context->getRelationsInSCC(scc)) {
+        if (rel->getAuxiliaryArity() > 0 || context->hasSubsumptiveClause(rel->getQualifiedName()) ||
+                rel->getRepresentation() == RelationRepresentation::EQREL || context->hasSizeLimit(rel) ||
+                !rel->getFunctionalDependencies().empty()) {
+            return false;
+        }
+
+        // negations, aggregates and counters may retract or change derived tuples
+        bool isMonotone = true;
+        for (const auto* clause : context->getProgram()->getClauses(*rel)) {
+            visit(*clause, [&](const ast::Negation&) { isMonotone = false; });
+            visit(*clause, [&](const ast::Aggregator&) { isMonotone = false; });
+            visit(*clause, [&](const ast::Counter&) { isMonotone = false; });
+        }
+        if (!isMonotone) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ast::RelationSet UnitTranslator::getIncrementalDependencies(std::size_t scc) const {
+    const auto& sccRelations = context->getRelationsInSCC(scc);
+    ast::RelationSet dependencies;
+    for (const ast::Relation* rel : sccRelations) {
+        for (const auto* clause : context->getProgram()->getClauses(*rel)) {
+            visit(*clause, [&](const ast::Atom& atom) {
+                const auto* dependency = context->getProgram()->getRelation(atom);
+                if (!contains(sccRelations, dependency)) {
+                    dependencies.insert(dependency);
+                }
+            });
+        }
+    }
+    return dependencies;
+}
+
+Own<ram::Statement> UnitTranslator::translateIncrementalClauses(
+        const ast::RelationSet& dependencies, const ast::Relation* rel) const {
+    VecOwn<ram::Statement> code;
+
+    // one version per dependency atom, reading the new tuples of the dependency from its @delta
+    for (auto&& clause : context->getProgram()->getClauses(*rel)) {
+        const auto& dependencyAtoms = getSccAtoms(clause, dependencies);
+        for (std::size_t version = 0; version < dependencyAtoms.size(); version++) {
+            appendStmt(code, context->translateRecursiveClause(*clause, dependencies, version));
+        }
+    }
+    return mk<ram::Sequence>(std::move(code));
+}
+
+Own<ram::Statement> UnitTranslator::generateIncrementalUpdate(
+        std::size_t scc, const ast::RelationSet& dependencies) const {
+    VecOwn<ram::Statement> update;
+    const auto& sccRelations = context->getRelationsInSCC(scc);
+
+    // expose the new tuples of the dependencies and inputs as deltas
+    for (const ast::Relation* rel : dependencies) {
+        appendStmt(update, generateCopyRelation(rel, getDeltaRelationName(rel->getQualifiedName()),
+                                   getDiffRelationName(rel->getQualifiedName())));
+    }
+    for (const ast::Relation* rel : context->getInputRelationsInSCC(scc)) {
+        appendStmt(update, generateCopyRelation(rel, getNewRelationName(rel->getQualifiedName()),
+                                   getDiffRelationName(rel->getQualifiedName())));
+    }
+
+    // derive the tuples depending on at least one new tuple of a dependency
+    for (const ast::Relation* rel : sccRelations) {
+        appendStmt(update, translateIncrementalClauses(dependencies, rel));
+    }
+    for (const ast::Relation* rel : dependencies) {
+        appendStmt(update, mk<ram::Clear>(getDeltaRelationName(rel->getQualifiedName())));
+    }
+
+    for (const ast::Relation* rel : sccRelations) {
+        std::string mainRelation = getConcreteRelationName(rel->getQualifiedName());
+        std::string newRelation = getNewRelationName(rel->getQualifiedName());
+        std::string diffRelation = getDiffRelationName(rel->getQualifiedName());
+        appendStmt(update, generateMergeRelations(rel, mainRelation, newRelation));
+        appendStmt(update, generateMergeRelations(rel, diffRelation, newRelation));
+    }
+
+    // continue with the regular fixpoint from the new tuples, recording every round in @diff
+    if (context->isRecursiveSCC(scc)) {
+        for (const ast::Relation* rel : sccRelations) {
+            std::string newRelation = getNewRelationName(rel->getQualifiedName());
+            appendStmt(update, mk<ram::Swap>(getDeltaRelationName(rel->getQualifiedName()), newRelation));
+            appendStmt(update, mk<ram::Clear>(newRelation));
+        }
+
+        const std::string loop_counter = "loop_counter";
+        VecOwn<ram::Expression> inc;
+        inc.push_back(mk<ram::Variable>(loop_counter));
+        inc.push_back(mk<ram::UnsignedConstant>(1));
+        auto increment_counter = mk<ram::Assign>(mk<ram::Variable>(loop_counter),
+                mk<ram::IntrinsicOperator>(FunctorOp::UADD, std::move(inc)), false);
+
+        VecOwn<ram::Statement> recordDiff;
+        for (const ast::Relation* rel : sccRelations) {
+            appendStmt(recordDiff, generateMergeRelations(rel, getDiffRelationName(rel->getQualifiedName()),
+                                           getDeltaRelationName(rel->getQualifiedName())));
+        }
+        auto fixpointLoop = mk<ram::Loop>(mk<ram::Sequence>(generateStratumLoopBody(sccRelations),
+                generateStratumExitSequence(sccRelations), generateStratumTableUpdates(sccRelations),
+                mk<ram::Sequence>(std::move(recordDiff)), std::move(increment_counter)));
+
+        appendStmt(update,
+                mk<ram::Assign>(mk<ram::Variable>(loop_counter), mk<ram::UnsignedConstant>(1), true));
+        appendStmt(update, std::move(fixpointLoop));
+    }
+    appendStmt(update, generateStratumPostamble(sccRelations));
+    return mk<ram::Sequence>(std::move(update));
+}
+
+Own<ram::Statement> UnitTranslator::generateIncrementalRecompute(std::size_t scc) const {
+    VecOwn<ram::Statement> recompute;
+    const auto& sccRelations = context->getRelationsInSCC(scc);
+    const auto& inputRelations = context->getInputRelationsInSCC(scc);
+
+    // keep the old content of derived relations to compute their differences afterwards;
+    // relations are copied rather than swapped as the interface holds on to them
+    for (const ast::Relation* rel : sccRelations) {
+        if (!contains(inputRelations, rel)) {
+            std::string mainRelation = getConcreteRelationName(rel->getQualifiedName());
+            appendStmt(recompute,
+                    generateCopyRelation(rel, getPrevRelationName(rel->getQualifiedName()), mainRelation));
+            appendStmt(recompute, mk<ram::Clear>(mainRelation));
+        }
+    }
+
+    appendStmt(recompute, generateStratumComputation(scc));
+
+    for (const ast::Relation* rel : sccRelations) {
+        std::string diffRelation = getDiffRelationName(rel->getQualifiedName());
+        appendStmt(recompute, mk<ram::Clear>(diffRelation));
+        std::string mainRelation = getConcreteRelationName(rel->getQualifiedName());
+        appendStmt(recompute, generateRelationDifference(rel, diffRelation, mainRelation,
+                                      getPrevRelationName(rel->getQualifiedName())));
+    }
+    return mk<ram::Sequence>(std::move(recompute));
+}
+
+Own<ram::Statement> UnitTranslator::generateIncrementalStratum(std::size_t scc) const {
+    // Helper function to add a new term to a conjunctive condition
+    auto addCondition = [&](Own<ram::Condition>& cond, Own<ram::Condition> term) {
+        cond = (cond == nullptr) ? std::move(term) : mk<ram::Conjunction>(std::move(cond), std::move(term));
+    };
+
+    // Helper function to run a statement only if the given condition holds
+    auto makeConditional = [](Own<ram::Condition> cond, Own<ram::Statement> stmt) -> Own<ram::Statement> {
+        return mk<ram::Loop>(mk<ram::Sequence>(mk<ram::Exit>(mk<ram::Negation>(std::move(cond))),
+                std::move(stmt), mk<ram::Exit>(mk<ram::True>())));
+    };
+
+    // A relation lost tuples iff it is smaller than its previous state plus the tuples it gained
+    const auto& dependencies = getIncrementalDependencies(scc);
+    ast::RelationSet sources = dependencies;
+    for (const ast::Relation* rel : context->getInputRelationsInSCC(scc)) {
+        sources.insert(rel);
+    }
+    Own<ram::Condition> noneGained;
+    Own<ram::Condition> noneLost;
+    for (const ast::Relation* rel : sources) {
+        std::string mainRelation = getConcreteRelationName(rel->getQualifiedName());
+        std::string diffRelation = getDiffRelationName(rel->getQualifiedName());
+        VecOwn<ram::Expression> sizes;
+        sizes.push_back(mk<ram::RelationSize>(getPrevRelationName(rel->getQualifiedName())));
+        sizes.push_back(mk<ram::RelationSize>(diffRelation));
+        addCondition(noneGained, mk<ram::EmptinessCheck>(diffRelation));
+        auto expectedSize = mk<ram::IntrinsicOperator>(FunctorOp::ADD, std::move(sizes));
+        addCondition(noneLost, mk<ram::Constraint>(BinaryConstraintOp::GE,
+                                       mk<ram::RelationSize>(mainRelation), std::move(expectedSize)));
+    }
+
+    // Strata without rules or without any relations to depend on have nothing to update
+    const auto& sccRelations = context->getRelationsInSCC(scc);
+    const bool hasClauses = any_of(sccRelations,
+            [&](const ast::Relation* rel) { return !context->getProgram()->getClauses(*rel).empty(); });
+    if (!hasClauses || noneLost == nullptr) {
+        return nullptr;
+    }
+
+    if (!isIncrementalSCC(scc)) {
+        auto unchanged = mk<ram::Conjunction>(std::move(noneGained), std::move(noneLost));
+        return makeConditional(mk<ram::Negation>(std::move(unchanged)), generateIncrementalRecompute(scc));
+    }
+
+    // Monotone strata only need to be recomputed if a dependency lost tuples
+    auto recompute = makeConditional(mk<ram::Negation>(clone(noneLost)), generateIncrementalRecompute(scc));
+    auto gained = mk<ram::Conjunction>(std::move(noneLost), mk<ram::Negation>(std::move(noneGained)));
+    auto update = makeConditional(std::move(gained), generateIncrementalUpdate(scc, dependencies));
+    return mk<ram::Sequence>(std::move(recompute), std::move(update));
+}
+
+Own<ram::Statement> UnitTranslator::generateIncrementalProgram(
+        const std::vector<std::size_t>& sccOrdering) const {
+    VecOwn<ram::Statement> res;
+
+    // Collect the tuples added to the input relations since the last evaluation
+    for (const auto& scc : sccOrdering) {
+        for (const ast::Relation* rel : context->getInputRelationsInSCC(scc)) {
+            appendStmt(res, generateRelationDifference(rel, getDiffRelationName(rel->getQualifiedName()),
+                                    getConcreteRelationName(rel->getQualifiedName()),
+                                    getPrevRelationName(rel->getQualifiedName())));
+        }
+    }
+
+    for (const auto& scc : sccOrdering) {
+        appendStmt(res, generateIncrementalStratum(scc));
+    }
+
+    // Remember the evaluated inputs and drop the bookkeeping of this increment
+    for (const auto& scc : sccOrdering) {
+        const auto& inputRelations = context->getInputRelationsInSCC(scc);
+        for (const ast::Relation* rel : context->getRelationsInSCC(scc)) {
+            std::string mainRelation = getConcreteRelationName(rel->getQualifiedName());
+            std::string prevRelation = getPrevRelationName(rel->getQualifiedName());
+            std::string diffRelation = getDiffRelationName(rel->getQualifiedName());
+            if (contains(inputRelations, rel)) {
+                appendStmt(res, generateCopyRelation(rel, prevRelation, diffRelation));
+                // take a fresh snapshot if tuples were removed from the input
+                auto isComplete = mk<ram::Constraint>(BinaryConstraintOp::EQ,
+                        mk<ram::RelationSize>(prevRelation), mk<ram::RelationSize>(mainRelation));
+                appendStmt(res, mk<ram::Loop>(mk<ram::Sequence>(mk<ram::Exit>(std::move(isComplete)),
+                                        mk<ram::Clear>(prevRelation),
+                                        generateCopyRelation(rel, prevRelation, mainRelation),
+                                        mk<ram::Exit>(mk<ram::True>()))));
+            } else {
+                appendStmt(res, mk<ram::Clear>(prevRelation));
+            }
+            appendStmt(res, mk<ram::Clear>(diffRelation));
+        }
+    }
+    return mk<ram::Sequence>(std::move(res));
+}
+
 void UnitTranslator::addAuxiliaryArity(
         const ast::Relation* /* relation */, std::map<std::string, std::string>& directives) const {
     directives.insert(std::make_pair("auxArity", "0"));
@@ -875,14 +1187,15 @@ VecOwn<ram::Relation> UnitTranslator::createRamRelations(const std::vector<std::
                 ramRelations.push_back(createRamRelation(rel, lubName, auxiliaryRepresentation));
             }
 
-            if (isRecursive || rel->getAuxiliaryArity() > 0) {
+            const bool isIncremental = glb->config().has("incremental");
+            if (isRecursive || rel->getAuxiliaryArity() > 0 || isIncremental) {
                 // Add new relation
                 std::string newName = getNewRelationName(rel->getQualifiedName());
                 ramRelations.push_back(createRamRelation(rel, newName, auxiliaryRepresentation));
             }
 
             // Recursive relations also require @delta and @new variants, with the same signature
-            if (isRecursive) {
+            if (isRecursive || isIncremental) {
                 // Add delta relation
                 std::string deltaName = getDeltaRelationName(rel->getQualifiedName());
                 ramRelations.push_back(createRamRelation(rel, deltaName, auxiliaryRepresentation));
@@ -902,11 +1215,107 @@ VecOwn<ram::Relation> UnitTranslator::createRamRelations(const std::vector<std::
                 std::string toEraseName = getDeleteRelationName(rel->getQualifiedName());
                 ramRelations.push_back(createRamRelation(rel, toEraseName, auxiliaryRepresentation));
             }
+
+            // Incremental evaluation tracks the previous state and the new tuples of every relation
+            if (isIncremental) {
+                const RelationRepresentation snapshotRepresentation =
+                        (mainRepresentation == RelationRepresentation::EQREL ? RelationRepresentation::DEFAULT
+                                                                            : auxiliaryRepresentation);
+                std::string prevName = getPrevRelationName(rel->getQualifiedName());
+                ramRelations.push_back(createRamRelation(rel, prevName, snapshotRepresentation));
+                std::string diffName = getDiffRelationName(rel->getQualifiedName());
+                ramRelations.push_back(createRamRelation(rel, diffName, snapshotRepresentation));
+            }
         }
     }
     return ramRelations;
 }
 
+/**
+ * Demand-driven queries
+ *
+ * With --magic-subroutines the program gets a subroutine @query:R:P for each
+ * query on relation R with binding pattern P. It takes the values of the bound
+ * attributes as arguments, and returns the matching tuples of R.
+ *
+ * If R is evaluated by the main program anyway, the subroutine looks the tuples
+ * up in R. Otherwise the strata of the magic-set program of the query are
+ * evaluated for the arguments, which accumulates the matching tuples in
+ * @query:R:P.@answer. Arguments already evaluated are recorded in
+ * @query:R:P.@seen, so that repeated calls are answered from @answer directly;
+ * all other relations of the query are cleared after each evaluation.
+ */
+Own<ram::Statement> UnitTranslator::generateQuerySubroutine(
+        const ast::analysis::IOTypeAnalysis::Query& query, const std::vector<std::size_t>& strata) const {
+    const auto* program = context->getProgram();
+    std::vector<std::size_t> boundColumns;
+    for (std::size_t i = 0; i < query.pattern.size(); i++) {
+        if (query.pattern[i] == 'b') {
+            boundColumns.push_back(i);
+        }
+    }
+    auto getArguments = [&]() {
+        VecOwn<ram::Expression> arguments;
+        for (std::size_t i = 0; i < boundColumns.size(); i++) {
+            arguments.push_back(mk<ram::SubroutineArgument>(i));
+        }
+        return arguments;
+    };
+
+    VecOwn<ram::Statement> res;
+    std::string answerRelation = getConcreteRelationName(query.relation);
+    const auto* answer = program->getRelation(query.getRelationName("@answer"));
+    if (answer != nullptr) {
+        std::string seenRelation = getConcreteRelationName(query.getRelationName("@seen"));
+        answerRelation = getConcreteRelationName(answer->getQualifiedName());
+
+        // Seed the query with the arguments, unless they have been evaluated before
+        std::string seedRelation = getConcreteRelationName(query.getRelationName("@seed"));
+        Own<ram::Condition> unseen = mk<ram::EmptinessCheck>(seenRelation);
+        if (!boundColumns.empty()) {
+            unseen = mk<ram::Negation>(mk<ram::ExistenceCheck>(seenRelation, getArguments()));
+        }
+        appendStmt(res, mk<ram::Query>(mk<ram::Filter>(
+                                std::move(unseen), mk<ram::Insert>(seedRelation, getArguments()))));
+
+        // Evaluate the strata of a new seed, and release their relations except for the answers
+        VecOwn<ram::Statement> evaluation;
+        appendStmt(evaluation, mk<ram::Exit>(mk<ram::EmptinessCheck>(seedRelation)));
+        for (std::size_t scc : strata) {
+            const ast::Relation* rel = *context->getRelationsInSCC(scc).begin();
+            appendStmt(evaluation, mk<ram::Call>("stratum_" + rel->getQualifiedName().toString()));
+        }
+        appendStmt(evaluation, mk<ram::Query>(mk<ram::Insert>(seenRelation, getArguments())));
+        for (std::size_t scc : strata) {
+            for (const ast::Relation* rel : context->getRelationsInSCC(scc)) {
+                if (rel != answer && rel->getQualifiedName() != query.getRelationName("@seen")) {
+                    appendStmt(evaluation, generateClearRelation(rel));
+                }
+            }
+        }
+        appendStmt(evaluation, mk<ram::Exit>(mk<ram::True>()));
+        appendStmt(res, mk<ram::Loop>(mk<ram::Sequence>(std::move(evaluation))));
+    }
+
+    // Return the tuples matching the arguments
+    VecOwn<ram::Expression> values;
+    for (std::size_t i = 0; i < query.pattern.size(); i++) {
+        values.push_back(mk<ram::TupleElement>(0, i));
+    }
+    Own<ram::Operation> op = mk<ram::SubroutineReturn>(std::move(values));
+    Own<ram::Condition> condition;
+    for (std::size_t i = 0; i < boundColumns.size(); i++) {
+        condition = addConjunctiveTerm(std::move(condition),
+                mk<ram::Constraint>(BinaryConstraintOp::EQ, mk<ram::TupleElement>(0, boundColumns[i]),
+                        mk<ram::SubroutineArgument>(i)));
+    }
+    if (condition != nullptr) {
+        op = mk<ram::Filter>(std::move(condition), std::move(op));
+    }
+    appendStmt(res, mk<ram::Query>(mk<ram::Scan>(answerRelation, 0, std::move(op))));
+    return mk<ram::Sequence>(std::move(res));
+}
+
 Own<ram::Sequence> UnitTranslator::generateProgram(const ast::TranslationUnit& translationUnit) {
     // Check if trivial program
     if (context->getNumberOfSCCs() == 0) {
@@ -914,27 +1323,107 @@ Own<ram::Sequence> UnitTranslator::generateProgram(const ast::TranslationUnit& t
     }
     const auto& sccOrdering =
             translationUnit.getAnalysis<ast::analysis::TopologicallySortedSCCGraphAnalysis>().order();
+    const auto& ioTypes = translationUnit.getAnalysis<ast::analysis::IOTypeAnalysis>();
     VecOwn<ram::Statement> res;
 
+    // Relations of demand-driven queries are qualified by the prefix of their query
+    std::set<std::string> queryPrefixes;
+    for (const auto& query : ioTypes.getQueries()) {
+        queryPrefixes.insert(query.getPrefix());
+    }
+    auto getQueryPrefix = [&](const ast::Relation* rel) -> std::string {
+        const auto& qualifiers = rel->getQualifiedName().getQualifiers();
+        return contains(queryPrefixes, qualifiers.front()) ? qualifiers.front() : "";
+    };
+
+    // Relations read by queries must not expire
+    ast::RelationSet queryInputs;
+    for (const auto& query : ioTypes.getQueries()) {
+        if (const auto* rel = context->getProgram()->getRelation(query.relation)) {
+            queryInputs.insert(rel);
+        }
+    }
+    for (std::size_t scc : sccOrdering) {
+        for (const ast::Relation* rel : context->getRelationsInSCC(scc)) {
+            if (getQueryPrefix(rel).empty()) {
+                continue;
+            }
+            for (const auto* clause : context->getProgram()->getClauses(*rel)) {
+                visit(*clause, [&](const ast::Atom& atom) {
+                    const auto* dependency = context->getProgram()->getRelation(atom);
+                    if (getQueryPrefix(dependency).empty()) {
+                        queryInputs.insert(dependency);
+                    }
+                });
+            }
+        }
+    }
+
     // Create subroutines for each SCC according to topological order
+    std::vector<std::size_t> mainOrdering;
+    std::map<std::string, std::vector<std::size_t>> queryStrata;
     for (std::size_t i = 0; i < sccOrdering.size(); i++) {
+        const ast::Relation* rel = *context->getRelationsInSCC(sccOrdering.at(i)).begin();
+        std::string stratumID = rel->getQualifiedName().toString();
+
+        // Strata of queries are only invoked by their query
+        std::string queryPrefix = getQueryPrefix(rel);
+        if (!queryPrefix.empty()) {
+            addRamSubroutine(stratumID, generateStratum(sccOrdering.at(i)));
+            queryStrata[queryPrefix].push_back(sccOrdering.at(i));
+            continue;
+        }
+        mainOrdering.push_back(sccOrdering.at(i));
+
         // Generate the main stratum code
         auto stratum = generateStratum(sccOrdering.at(i));
 
-        // Clear expired relations
-        const auto& expiredRelations = context->getExpiredRelations(i);
-        stratum = mk<ram::Sequence>(std::move(stratum), generateClearExpiredRelations(expiredRelations));
+        // Clear expired relations, unless they are needed by later increments or queries
+        if (!glb->config().has("incremental")) {
+            ast::RelationSet expiredRelations;
+            for (const ast::Relation* expired : context->getExpiredRelations(i)) {
+                if (!contains(queryInputs, expired) && getQueryPrefix(expired).empty()) {
+                    expiredRelations.insert(expired);
+                }
+            }
+            stratum = mk<ram::Sequence>(std::move(stratum), generateClearExpiredRelations(expiredRelations));
+        }
 
         // Add the subroutine
-        const ast::Relation* rel = *context->getRelationsInSCC(sccOrdering.at(i)).begin();
-
-        std::string stratumID = rel->getQualifiedName().toString();
         addRamSubroutine(stratumID, std::move(stratum));
 
         // invoke the strata
         appendStmt(res, mk<ram::Call>("stratum_" + stratumID));
     }
 
+    // Add the subroutines answering queries
+    for (const auto& query : ioTypes.getQueries()) {
+        addRamSubroutine(query.getName(), generateQuerySubroutine(query, queryStrata[query.getPrefix()]));
+    }
+
+    // Snapshot the evaluated inputs and add the subroutine updating the program after they changed
+    if (glb->config().has("incremental")) {
+        for (const auto& scc : mainOrdering) {
+            for (const ast::Relation* rel : context->getInputRelationsInSCC(scc)) {
+                std::string prevRelation = getPrevRelationName(rel->getQualifiedName());
+                appendStmt(res, mk<ram::Clear>(prevRelation));
+                appendStmt(res, generateCopyRelation(
+                                        rel, prevRelation, getConcreteRelationName(rel->getQualifiedName())));
+            }
+        }
+
+        // Answers of queries are evaluated again on demand
+        VecOwn<ram::Statement> update;
+        appendStmt(update, generateIncrementalProgram(mainOrdering));
+        for (const auto& query : ioTypes.getQueries()) {
+            if (const auto* answer = context->getProgram()->getRelation(query.getRelationName("@answer"))) {
+                appendStmt(update, generateClearRelation(answer));
+                appendStmt(update, mk<ram::Clear>(getConcreteRelationName(query.getRelationName("@seen"))));
+            }
+        }
+        addRamSubroutine("@incremental", mk<ram::Sequence>(std::move(update)));
+    }
+
     // Add main timer if profiling
     if (!res.empty() && glb->config().has("profile")) {
         auto newStmt = mk<ram::LogTimer>(mk<ram::Sequence>(std::move(res)), LogStatement::runtime());
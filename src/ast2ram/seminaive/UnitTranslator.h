@@ -16,6 +16,7 @@
 
 #include "RelationTag.h"
 #include "ast/Relation.h"
+#include "ast/analysis/IOType.h"
 #include "ast2ram/UnitTranslator.h"
 #include "ram/Expression.h"
 #include "souffle/utility/ContainerUtil.h"
@@ -87,6 +88,22 @@ protected:
     Own<ram::Statement> generateStratumTableUpdates(const ast::RelationSet& scc) const;
     Own<ram::Statement> generateStratumExitSequence(const ast::RelationSet& scc) const;
     Own<ram::Statement> generateStratumLubSequence(const ast::Relation& rel, bool inRecursiveLoop) const;
+    Own<ram::Statement> generateStratumComputation(std::size_t scc) const;
+
+    /** Incremental evaluation */
+    bool isIncrementalSCC(std::size_t scc) const;
+    ast::RelationSet getIncrementalDependencies(std::size_t scc) const;
+    Own<ram::Statement> generateIncrementalProgram(const std::vector<std::size_t>& sccOrdering) const;
+    Own<ram::Statement> generateIncrementalStratum(std::size_t scc) const;
+    Own<ram::Statement> generateIncrementalUpdate(
+            std::size_t scc, const ast::RelationSet& dependencies) const;
+    Own<ram::Statement> generateIncrementalRecompute(std::size_t scc) const;
+    Own<ram::Statement> translateIncrementalClauses(
+            const ast::RelationSet& dependencies, const ast::Relation* rel) const;
+
+    /** Demand-driven queries */
+    Own<ram::Statement> generateQuerySubroutine(
+            const ast::analysis::IOTypeAnalysis::Query& query, const std::vector<std::size_t>& strata) const;
 
     /** Other helper generations */
     virtual Own<ram::Statement> generateClearExpiredRelations(const ast::RelationSet& expiredRelations) const;
@@ -96,6 +113,11 @@ protected:
     virtual Own<ram::Statement> generateMergeRelationsWithFilter(const ast::Relation* rel,
             const std::string& destRelation, const std::string& srcRelation,
             const std::string& filterRelation) const;
+    virtual Own<ram::Statement> generateCopyRelation(
+            const ast::Relation* rel, const std::string& destRelation, const std::string& srcRelation) const;
+    virtual Own<ram::Statement> generateRelationDifference(const ast::Relation* rel,
+            const std::string& destRelation, const std::string& srcRelation,
+            const std::string& subtrahendRelation) const;
     virtual Own<ram::Statement> generateEraseTuples(
             const ast::Relation* rel, const std::string& destRelation, const std::string& srcRelation) const;
     virtual Own<ram::Statement> generateDebugRelation(const ast::Relation* rel,
@@ -116,6 +116,14 @@ std::string getDeleteRelationName(const ast::QualifiedName& name) {
     return getConcreteRelationName(name, "@delete_");
 }
 
+std::string getDiffRelationName(const ast::QualifiedName& name) {
+    return getConcreteRelationName(name, "@diff_");
+}
+
+std::string getPrevRelationName(const ast::QualifiedName& name) {
+    return getConcreteRelationName(name, "@prev_");
+}
+
 const std::string& getRelationName(const ast::QualifiedName& name) {
     return name.toString();
 }
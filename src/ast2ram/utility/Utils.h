@@ -63,6 +63,12 @@ std::string getRejectRelationName(const ast::QualifiedName& name);
 /** Get the corresponding RAM 'delete' relation name for the relation */
 std::string getDeleteRelationName(const ast::QualifiedName& name);
 
+/** Get the corresponding RAM 'diff' relation name for the relation */
+std::string getDiffRelationName(const ast::QualifiedName& name);
+
+/** Get the corresponding RAM 'prev' relation name for the relation */
+std::string getPrevRelationName(const ast::QualifiedName& name);
+
 /** Get base relation name, strip off any possible prefix */
 std::string getBaseRelationName(const ast::QualifiedName& name);
 
@@ -62,6 +62,11 @@ protected:
      */
     std::string profile_name;
 
+    /**
+     * profile trace filename; empty if no trace is written
+     */
+    std::string profile_trace_name;
+
     /**
      * number of threads
      */
@@ -69,8 +74,10 @@ protected:
 
 public:
     // all argument constructor
-    CmdOptions(const char* s, const char* id, const char* od, bool pe, const char* pfn, std::size_t nj)
-            : src(s), input_dir(id), output_dir(od), profiling(pe), profile_name(pfn), num_jobs(nj) {}
+    CmdOptions(const char* s, const char* id, const char* od, bool pe, const char* pfn, std::size_t nj,
+            const char* ptn = "")
+            : src(s), input_dir(id), output_dir(od), profiling(pe), profile_name(pfn),
+              profile_trace_name(ptn), num_jobs(nj) {}
 
     /**
      * get source code name
@@ -107,6 +114,13 @@ public:
         return profile_name;
     }
 
+    /**
+     * get filename of profile trace
+     */
+    const std::string& getProfileTraceName() const {
+        return profile_trace_name;
+    }
+
     /**
      * get number of jobs
      */
@@ -129,9 +143,11 @@ public:
         std::string fact_dir = input_dir;
         std::string out_dir = output_dir;
 
-        // long options
+        // long options; the profile trace has no short option
+        const int profileTraceOpt = 256;
         option longOptions[] = {{"facts", true, nullptr, 'F'}, {"output", true, nullptr, 'D'},
-                {"profile", true, nullptr, 'p'}, {"jobs", true, nullptr, 'j'}, {"index", true, nullptr, 'i'},
+                {"profile", true, nullptr, 'p'}, {"profile-trace", true, nullptr, profileTraceOpt},
+                {"jobs", true, nullptr, 'j'}, {"index", true, nullptr, 'i'},
                 // the terminal option -- needs to be null
                 {nullptr, false, nullptr, 0}};
 
@@ -165,6 +181,14 @@ public:
                     }
                     profile_name = optarg;
                     break;
+                case profileTraceOpt:
+                    if (!profiling) {
+                        std::cerr << "\nError: profiling was not enabled in compilation\n\n";
+                        printHelpPage(exec_name);
+                        exit(EXIT_FAILURE);
+                    }
+                    profile_trace_name = optarg;
+                    break;
                 case 'j':
 #ifdef _OPENMP
                     if (std::string(optarg) == "auto") {
@@ -211,6 +235,10 @@ private:
         if (profiling) {
             std::cerr << "    -p <file>, --profile=<file>  -- Specify filename for profiling\n";
             std::cerr << "                                    (default: " << profile_name << ")\n";
+            std::cerr << "    --profile-trace=<file>       -- Specify filename for the profile trace\n";
+            if (!profile_trace_name.empty()) {
+                std::cerr << "                                    (default: " << profile_trace_name << ")\n";
+            }
         }
 #ifdef _OPENMP
         std::cerr << "    -j <NUM>, --jobs=<NUM>       -- Specify number of threads\n";
@@ -33,6 +33,7 @@
 #include "souffle/io/IOSystem.h"
 #include "souffle/io/WriteStream.h"
 #include "souffle/utility/EvaluatorUtil.h"
+#include "souffle/utility/WorkStealing.h"
 
 #if defined(_OPENMP)
 #include <omp.h>
@@ -117,6 +118,13 @@ public:
         }
         relation.insert(t);
     }
+    void insertBatch(std::vector<RamDomain>& tuples) override {
+        if constexpr (detail::has_insert_batch<RelType>::value) {
+            relation.insertBatch(tuples);
+        } else {
+            Relation::insertBatch(tuples);
+        }
+    }
     bool contains(const tuple& arg) const override {
         TupleType t;
         assert(arg.size() == Arity && "wrong tuple arity");
@@ -20,18 +20,22 @@
 #include "souffle/RecordTable.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/datastructure/ConcurrentCache.h"
+#include "souffle/utility/FileUtil.h"
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/StringUtil.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <initializer_list>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <optional>
 #include <regex>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -428,6 +432,16 @@ public:
      * in the table, set the next element pointer points to the current element itself.
      */
     virtual void purge() = 0;
+
+    /**
+     * Insert a batch of tuples stored one after another.
+     *
+     * Each tuple occupies getArity() consecutive elements of the batch. The content of the batch is
+     * unspecified afterwards.
+     *
+     * @param tuples The tuples to be inserted
+     */
+    virtual void insertBatch(std::vector<RamDomain>& tuples);
 };
 
 /**
@@ -691,6 +705,20 @@ public:
     }
 };
 
+inline void Relation::insertBatch(std::vector<RamDomain>& tuples) {
+    const arity_type arity = getArity();
+    if (arity == 0) {
+        return;
+    }
+    for (std::size_t i = 0; i + arity <= tuples.size(); i += arity) {
+        tuple t(this);
+        for (std::size_t j = 0; j < arity; ++j) {
+            t[j] = tuples[i + j];
+        }
+        insert(t);
+    }
+}
+
 /**
  * Abstract base class for generated Datalog programs.
  */
@@ -931,6 +959,39 @@ public:
         fatal("unknown subroutine");
     }
 
+    /**
+     * Bring the relations up to date after tuples were inserted into or removed
+     * from input relations since the last run.
+     *
+     * Only available in programs built with --incremental; strata whose inputs
+     * merely gained tuples are updated semi-naively, others are recomputed.
+     */
+    void runIncremental() {
+        std::vector<RamDomain> args;
+        std::vector<RamDomain> ret;
+        executeSubroutine("@incremental", args, ret);
+    }
+
+    /**
+     * Look up the tuples of a relation matching the values of its bound attributes.
+     *
+     * Only available for queries the program was built for with --magic-subroutines,
+     * e.g. path:bf; relations not needed by outputs are evaluated on demand for each
+     * new binding. The tuples are returned one after another with all their attributes.
+     *
+     * Not thread-safe: a query may evaluate and clear relations of the program, hence
+     * must not run concurrently with other queries, run() or runIncremental().
+     *
+     * @param relation Name of the queried relation
+     * @param pattern Pattern of bound (b) and free (f) attributes of the query
+     * @param args Values of the bound attributes
+     * @param ret Matching tuples
+     */
+    void query(const std::string& relation, const std::string& pattern, const std::vector<RamDomain>& args,
+            std::vector<RamDomain>& ret) {
+        executeSubroutine("@query:" + relation + ":" + pattern, args, ret);
+    }
+
     /**
      * Get the symbol table of the program.
      */
@@ -1038,6 +1099,234 @@ public:
     void setPruneImdtRels(bool pruneImdtRelsArg) {
         pruneImdtRels = pruneImdtRelsArg;
     }
+
+    /**
+     * Save the evaluation state to a snapshot file.
+     *
+     * The snapshot holds the symbol table, the record table and the tuples of all relations, so that a
+     * fresh instance of the same program can be brought back to this state with loadSnapshot().
+     * Relation data is stored as aligned arrays of RamDomain values in native byte order.
+     *
+     * @param filename The snapshot file
+     */
+    void saveSnapshot(const std::string& filename) {
+        std::ofstream file(filename, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open snapshot file " + filename);
+        }
+
+        // symbols in the order of their ordinals
+        SymbolTable& symbolTable = getSymbolTable();
+        std::vector<std::string> symbols;
+        std::size_t symbolCount = 0;
+        for (const auto& entry : symbolTable) {
+            if (entry.second >= symbols.size()) {
+                symbols.resize(entry.second + 1);
+            }
+            symbols[entry.second] = entry.first;
+            ++symbolCount;
+        }
+        if (symbolCount != symbols.size()) {
+            throw std::runtime_error("Cannot save a symbol table with gaps");
+        }
+
+        // records of each arity in the order of their references
+        std::vector<std::pair<std::size_t, RamDomain>> records;
+        std::vector<const RamDomain*> recordData;
+        getRecordTable().enumerate([&](const RamDomain* data, std::size_t arity, RamDomain key) {
+            records.emplace_back(arity, key);
+            recordData.push_back(data);
+        });
+        std::vector<std::size_t> recordOrder(records.size());
+        for (std::size_t i = 0; i < recordOrder.size(); ++i) {
+            recordOrder[i] = i;
+        }
+        std::sort(recordOrder.begin(), recordOrder.end(),
+                [&](std::size_t a, std::size_t b) { return records[a] < records[b]; });
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SnapshotHeader::expectedMagic, sizeof(header.magic));
+        header.version = SnapshotHeader::currentVersion;
+        header.domainSize = sizeof(RamDomain);
+        header.symbols = symbols.size();
+        header.records = records.size();
+        header.relations = allRelations.size();
+        writeSnapshotValue(file, header);
+
+        for (const std::string& symbol : symbols) {
+            writeSnapshotString(file, symbol);
+        }
+
+        for (std::size_t i : recordOrder) {
+            const auto [arity, key] = records[i];
+            writeSnapshotValue(file, static_cast<uint64_t>(arity));
+            writeSnapshotValue(file, key);
+            file.write(reinterpret_cast<const char*>(recordData[i]), arity * sizeof(RamDomain));
+        }
+
+        std::vector<RamDomain> data;
+        for (const Relation* relation : allRelations) {
+            const std::size_t arity = relation->getArity();
+            data.clear();
+            std::size_t size = 0;
+            for (const tuple& t : *relation) {
+                for (std::size_t i = 0; i < arity; ++i) {
+                    data.push_back(t[i]);
+                }
+                ++size;
+            }
+            writeSnapshotString(file, relation->getName());
+            writeSnapshotValue(file, static_cast<uint64_t>(arity));
+            writeSnapshotValue(file, static_cast<uint64_t>(size));
+            writeSnapshotPadding(file);
+            file.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(RamDomain));
+        }
+
+        if (!file) {
+            throw std::runtime_error("Cannot write snapshot file " + filename);
+        }
+    }
+
+    /**
+     * Restore the evaluation state from a snapshot file written by saveSnapshot().
+     *
+     * The program must be the one the snapshot was taken from and its symbol and record tables must not
+     * have grown beyond the initial program constants. Tuples are added to the current content of the
+     * relations.
+     *
+     * @param filename The snapshot file
+     */
+    void loadSnapshot(const std::string& filename) {
+        MappedFile mapping(filename);
+        std::string contents;
+        const char* pos = mapping.begin();
+        const char* end = mapping.end();
+        if (!mapping.isMapped()) {
+            std::ifstream file(filename, std::ios::in | std::ios::binary);
+            if (!file.is_open()) {
+                throw std::runtime_error("Cannot open snapshot file " + filename);
+            }
+            contents.assign(std::istreambuf_iterator<char>(file), {});
+            pos = contents.data();
+            end = pos + contents.size();
+        }
+        const char* const begin = pos;
+
+        auto read = [&](void* destination, std::size_t size) {
+            if (static_cast<std::size_t>(end - pos) < size) {
+                throw std::runtime_error("Truncated snapshot file " + filename);
+            }
+            std::memcpy(destination, pos, size);
+            pos += size;
+        };
+        auto readString = [&]() {
+            uint64_t size;
+            read(&size, sizeof(size));
+            if (static_cast<std::size_t>(end - pos) < size) {
+                throw std::runtime_error("Truncated snapshot file " + filename);
+            }
+            std::string value(pos, size);
+            pos += size;
+            return value;
+        };
+
+        SnapshotHeader header;
+        read(&header, sizeof(header));
+        if (std::memcmp(header.magic, SnapshotHeader::expectedMagic, sizeof(header.magic)) != 0 ||
+                header.version != SnapshotHeader::currentVersion || header.domainSize != sizeof(RamDomain)) {
+            throw std::runtime_error("Incompatible snapshot file " + filename);
+        }
+
+        // symbols and records must come back with the references stored in the relations
+        SymbolTable& symbolTable = getSymbolTable();
+        for (std::size_t i = 0; i < header.symbols; ++i) {
+            if (symbolTable.encode(readString()) != static_cast<RamDomain>(i)) {
+                throw std::runtime_error("Snapshot does not match the symbol table of the program");
+            }
+        }
+
+        RecordTable& recordTable = getRecordTable();
+        std::vector<RamDomain> record;
+        for (std::size_t i = 0; i < header.records; ++i) {
+            uint64_t arity;
+            RamDomain key;
+            read(&arity, sizeof(arity));
+            read(&key, sizeof(key));
+            if (static_cast<std::size_t>(end - pos) / sizeof(RamDomain) < arity) {
+                throw std::runtime_error("Truncated snapshot file " + filename);
+            }
+            record.resize(arity);
+            read(record.data(), arity * sizeof(RamDomain));
+            if (recordTable.pack(record.data(), arity) != key) {
+                throw std::runtime_error("Snapshot does not match the record table of the program");
+            }
+        }
+
+        std::vector<RamDomain> data;
+        for (std::size_t i = 0; i < header.relations; ++i) {
+            const std::string name = readString();
+            uint64_t arity;
+            uint64_t size;
+            read(&arity, sizeof(arity));
+            read(&size, sizeof(size));
+            const std::size_t padding = (8 - static_cast<std::size_t>(pos - begin) % 8) % 8;
+            if (static_cast<std::size_t>(end - pos) < padding) {
+                throw std::runtime_error("Truncated snapshot file " + filename);
+            }
+            pos += padding;
+
+            Relation* relation = getRelation(name);
+            if (relation == nullptr || relation->getArity() != arity) {
+                throw std::runtime_error("Snapshot relation " + name + " does not match the program");
+            }
+            if (arity > 0 && static_cast<std::size_t>(end - pos) / sizeof(RamDomain) / arity < size) {
+                throw std::runtime_error("Truncated snapshot file " + filename);
+            }
+            if (arity == 0) {
+                if (size > 0) {
+                    relation->insert(tuple(relation));
+                }
+                continue;
+            }
+            data.resize(arity * size);
+            read(data.data(), data.size() * sizeof(RamDomain));
+            relation->insertBatch(data);
+        }
+    }
+
+private:
+    /**
+     * Header of a snapshot file.
+     *
+     * It is followed by the symbols, the records and the relations; relation data starts at a multiple of 8
+     * bytes from the beginning of the file.
+     */
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t domainSize;
+        uint64_t symbols;
+        uint64_t records;
+        uint64_t relations;
+
+        static constexpr char expectedMagic[8] = {'S', 'O', 'U', 'F', 'S', 'N', 'A', 'P'};
+        static constexpr uint32_t currentVersion = 1;
+    };
+
+    template <typename T>
+    static void writeSnapshotValue(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static void writeSnapshotString(std::ostream& out, const std::string& value) {
+        writeSnapshotValue(out, static_cast<uint64_t>(value.size()));
+        out.write(value.data(), value.size());
+    }
+
+    static void writeSnapshotPadding(std::ostream& out) {
+        static const char zeros[8] = {};
+        out.write(zeros, (8 - static_cast<std::size_t>(out.tellp()) % 8) % 8);
+    }
 };
 
 /**
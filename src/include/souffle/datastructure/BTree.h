@@ -23,6 +23,7 @@
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/ParallelUtil.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -38,6 +39,15 @@ namespace souffle {
 
 namespace detail {
 
+/**
+ * The number of b-tree operations restarted due to a concurrent modification
+ * of the nodes they visited, accumulated over all trees of this process.
+ */
+inline std::atomic<std::size_t>& btreeLockRestarts() {
+    static std::atomic<std::size_t> restarts{0};
+    return restarts;
+}
+
 /**
  * The actual implementation of a b-tree data structure.
  *
@@ -980,6 +990,47 @@ public:
             return *this;
         }
 
+        /**
+         * Obtains a position splitting the range from this iterator up to the given end
+         * into two non-empty halves. The position is the median of the elements within the
+         * range stored in the highest node covering it, such that both halves cover
+         * sub-trees of similar size.
+         *
+         * @param end .. the end of the range to be split
+         * @return an iterator strictly within the range, or end if it cannot be split
+         */
+        iterator split(const iterator& end) const {
+            if (cur == nullptr || *this == end) {
+                return end;
+            }
+
+            // the split position is searched top-down starting at the root
+            node const* n = cur;
+            while (n->getParent() != nullptr) {
+                n = n->getParent();
+            }
+
+            Comparator cmp;
+            const Key& low = **this;
+            while (true) {
+                auto a = &(n->keys[0]);
+                auto b = &(n->keys[n->getNumElements()]);
+
+                // candidates are the keys greater than the first and less than the end of the range
+                auto lo = search.upper_bound(low, a, b, cmp);
+                auto hi = (end.cur == nullptr) ? b : search.lower_bound(*end, a, b, cmp);
+                if (lo < hi) {
+                    return iterator(n, static_cast<field_index_type>((lo - a) + (hi - lo) / 2));
+                }
+
+                // otherwise all elements within the range are located in a single sub-tree
+                if (n->isLeaf()) {
+                    return end;
+                }
+                n = n->getChild(static_cast<size_type>(lo - a));
+            }
+        }
+
         // prints a textual representation of this iterator to the given stream (mainly for debugging)
         void print(std::ostream& out = std::cout) const {
             out << cur << "[" << (int)pos << "]";
@@ -1221,14 +1272,14 @@ public:
                     // validate results
                     if (!cur->lock.validate(cur_lease)) {
                         // start over again
-                        return insert(k, hints);
+                        return restartInsert(k, hints);
                     }
 
                     // update provenance information
                     if (typeid(Comparator) != typeid(WeakComparator)) {
                         if (!cur->lock.try_upgrade_to_write(cur_lease)) {
                             // start again
-                            return insert(k, hints);
+                            return restartInsert(k, hints);
                         }
                         bool updated = update(*pos, k);
                         cur->lock.end_write();
@@ -1248,7 +1299,7 @@ public:
                 // check whether there was a write
                 if (!cur->lock.end_read(cur_lease)) {
                     // start over
-                    return insert(k, hints);
+                    return restartInsert(k, hints);
                 }
 
                 // go to next
@@ -1276,14 +1327,14 @@ public:
                 // validate result
                 if (!cur->lock.validate(cur_lease)) {
                     // start over again
-                    return insert(k, hints);
+                    return restartInsert(k, hints);
                 }
 
                 // update provenance information
                 if (typeid(Comparator) != typeid(WeakComparator)) {
                     if (!cur->lock.try_upgrade_to_write(cur_lease)) {
                         // start again
-                        return insert(k, hints);
+                        return restartInsert(k, hints);
                     }
                     bool updated = update(*(pos - 1), k);
                     cur->lock.end_write();
@@ -1298,7 +1349,7 @@ public:
             if (!cur->lock.try_upgrade_to_write(cur_lease)) {
                 // something has changed => restart
                 hints.last_insert.access(cur);
-                return insert(k, hints);
+                return restartInsert(k, hints);
             }
 
             if (cur->numElements >= node::maxKeys) {
@@ -1365,7 +1416,7 @@ public:
                     cur->lock.end_write();
 
                     // insert in sibling
-                    return insert(k, hints);
+                    return restartInsert(k, hints);
                 }
             }
 
@@ -1509,6 +1560,85 @@ public:
         }
     }
 
+    /**
+     * Inserts the given range of elements, sorted w.r.t. the order of this
+     * tree, into this tree. An empty tree is bulk-loaded; if the range is
+     * large compared to the content of the tree, the present elements and the
+     * range are merged in a single linear pass and the tree is rebuilt;
+     * otherwise the range is split into contiguous key ranges which are
+     * inserted in parallel, each utilizing its own operation hints.
+     *
+     * This operation must not run concurrently with other operations on this tree.
+     *
+     * @tparam Iter .. the type of iterator specifying the range
+     *                     it must be a random-access iterator
+     */
+    template <typename Iter>
+    void insertSorted(const Iter& a, const Iter& b) {
+        // quick exit - empty range
+        if (a == b) {
+            return;
+        }
+        const auto length = static_cast<size_type>(b - a);
+        const size_type present = size();
+        auto lessKey = [&](const Key& x, const Key& y) { return less(x, y); };
+        auto equalKey = [&](const Key& x, const Key& y) { return equal(x, y); };
+
+        // rebuilding is only possible if no element is subject to the updater
+        constexpr bool canRebuild = std::is_same<Comparator, WeakComparator>::value;
+
+        // bulk-load an empty tree if the range does not contain any duplicates
+        if (canRebuild && present == 0 && (!isSet || std::adjacent_find(a, b, equalKey) == b)) {
+            root = buildPackedTree(a, b);
+            leftmost = findLeftmost();
+            return;
+        }
+
+        // merge present elements and the given range, and rebuild the tree
+        if (canRebuild && length * 8 >= present) {
+            std::vector<Key> keys;
+            keys.reserve(present + length);
+            std::merge(begin(), end(), a, b, std::back_inserter(keys), lessKey);
+            if (isSet) {
+                keys.erase(std::unique(keys.begin(), keys.end(), equalKey), keys.end());
+            }
+            clear();
+            root = buildPackedTree(keys.begin(), keys.end());
+            leftmost = findLeftmost();
+            return;
+        }
+
+        // insert contiguous key ranges in parallel
+        const size_type numChunks = std::min<size_type>(MAX_THREADS, length / max_keys_per_node + 1);
+        PARALLEL_START
+            operation_hints hints;
+            pfor(size_type i = 0; i < numChunks; ++i) {
+                const Iter lower = a + (length * i) / numChunks;
+                const Iter upper = a + (length * (i + 1)) / numChunks;
+                for (auto it = lower; it != upper; ++it) {
+                    insert(*it, hints);
+                }
+            }
+        PARALLEL_END
+    }
+
+    /**
+     * Inserts the given range of elements, in arbitrary order, into this tree.
+     * The elements are collected in a buffer, which is sorted in parallel
+     * unless already sorted, and spliced into the tree by insertSorted.
+     *
+     * This operation must not run concurrently with other operations on this tree.
+     */
+    template <typename Iter>
+    void insertAll(const Iter& a, const Iter& b) {
+        std::vector<Key> buffer(a, b);
+        auto lessKey = [&](const Key& x, const Key& y) { return less(x, y); };
+        if (!std::is_sorted(buffer.begin(), buffer.end(), lessKey)) {
+            sortKeys(buffer);
+        }
+        insertSorted(buffer.begin(), buffer.end());
+    }
+
     // Obtains an iterator referencing the first element of the tree.
     iterator begin() const {
         return iterator(leftmost, 0);
@@ -1871,6 +2001,7 @@ public:
             << hint_stats.lower_bound.getMisses() << "/" << hint_stats.lower_bound.getAccesses() << "\n";
         out << "  upper-bound-hint (hits/misses/total):" << hint_stats.upper_bound.getHits() << "/"
             << hint_stats.upper_bound.getMisses() << "/" << hint_stats.upper_bound.getAccesses() << "\n";
+        out << "  lock restarts (all trees):       " << btreeLockRestarts() << "\n";
         out << " ---------------------------------\n";
     }
 
@@ -1888,7 +2019,8 @@ public:
     /**
      * A static member enabling the bulk-load of ordered data into an empty
      * tree. This function is much more efficient in creating a index over
-     * an ordered set of elements than an iterative insertion of values.
+     * an ordered set of elements than an iterative insertion of values. The
+     * resulting tree is built in linear time and its leaves are filled up.
      *
      * @tparam Iter .. the type of iterator specifying the range
      *                     it must be a random-access iterator
@@ -1904,7 +2036,7 @@ public:
         }
 
         // resolve tree recursively
-        auto root = buildSubTree(a, b - 1);
+        auto root = buildPackedTree(a, b);
 
         // find leftmost node
         node* leftmost = root;
@@ -1947,70 +2079,128 @@ protected:
 
 private:
     /**
-     * Determines whether the range covered by this node covers
-     * the upper bound of the given key.
+     * Sorts the given keys w.r.t. the order of this tree. Each thread sorts a
+     * contiguous part of the keys, and neighbouring parts are merged pairwise.
      */
-    bool coversUpperBound(const node* node, const Key& k) const {
-        // ignore edges
-        return !node->isEmpty() && !less(k, node->keys[0]) && less(k, node->keys[node->numElements - 1]);
-    }
-
-    // Utility function for the load operation above.
-    template <typename Iter>
-    static node* buildSubTree(const Iter& a, const Iter& b) {
-        const int N = node::maxKeys;
-
-        // divide range in N+1 sub-ranges
-        int64_t length = (b - a) + 1;
-
-        // terminal case: length is less then maxKeys
-        if (length <= N) {
-            // create a leaf node
-            node* res = new leaf_node();
-            res->numElements = length;
+    void sortKeys(std::vector<Key>& keys) const {
+        auto lessKey = [&](const Key& x, const Key& y) { return less(x, y); };
+        const size_type length = keys.size();
+        const size_type numParts = std::min<size_type>(MAX_THREADS, length / max_keys_per_node + 1);
+        auto bound = [&](size_type part) {
+            return keys.begin() + (length * std::min(part, numParts)) / numParts;
+        };
 
-            for (int i = 0; i < length; ++i) {
-                res->keys[i] = a[i];
+        PARALLEL_START
+            pfor(size_type i = 0; i < numParts; ++i) {
+                std::sort(bound(i), bound(i + 1), lessKey);
             }
+        PARALLEL_END
 
-            return res;
+        for (size_type width = 1; width < numParts; width *= 2) {
+            PARALLEL_START
+                pfor(size_type i = 0; i < numParts; i += 2 * width) {
+                    std::inplace_merge(bound(i), bound(i + width), bound(i + 2 * width), lessKey);
+                }
+            PARALLEL_END
         }
+    }
 
-        // recursive case - compute step size
-        int numKeys = N;
-        int64_t step = ((length - numKeys) / (numKeys + 1));
-
-        while (numKeys > 1 && (step < N / 2)) {
-            numKeys--;
-            step = ((length - numKeys) / (numKeys + 1));
+    // Utility function locating the left-most leaf of a non-empty tree.
+    leaf_node* findLeftmost() const {
+        node* cur = root;
+        while (!cur->isLeaf()) {
+            cur = cur->getChild(0);
         }
+        return static_cast<leaf_node*>(cur);
+    }
 
-        // create inner node
-        node* res = new inner_node();
-        res->numElements = numKeys;
+    // Utility function restarting an insertion invalidated by a concurrent modification.
+    bool restartInsert(const Key& k, operation_hints& hints) {
+        btreeLockRestarts().fetch_add(1, std::memory_order_relaxed);
+        return insert(k, hints);
+    }
 
-        Iter c = a;
-        for (int i = 0; i < numKeys; i++) {
-            // get dividing key
-            res->keys[i] = c[step];
+    /**
+     * Determines whether the range covered by this node covers
+     * the upper bound of the given key.
+     */
+    bool coversUpperBound(const node* node, const Key& k) const {
+        // ignore edges
+        return !node->isEmpty() && !less(k, node->keys[0]) && less(k, node->keys[node->numElements - 1]);
+    }
 
-            // get sub-tree
-            auto child = buildSubTree(c, c + (step - 1));
-            child->parent = res;
-            child->position = i;
-            res->getChildren()[i] = child;
+    /**
+     * Utility function for the load operation above. Builds a tree bottom-up
+     * from the given non-empty sorted range in a single pass: all nodes of a
+     * level are filled completely, except for the last two nodes sharing the
+     * remainder, and the separating keys form the keys of the next level.
+     */
+    template <typename Iter>
+    static node* buildPackedTree(const Iter& a, const Iter& b) {
+        const size_type N = node::maxKeys;
+
+        // the number of keys per node for a level covering the given number of keys
+        auto nodeSizes = [&](size_type length) {
+            // n nodes hold length - (n - 1) keys, the others separate them
+            const size_type numNodes = (length + N + 1) / (N + 1);
+            std::vector<size_type> sizes(numNodes, N);
+            sizes.back() = length - (numNodes - 1) * (N + 1);
+            if (numNodes > 1) {
+                // the last two nodes share the remainder evenly
+                const size_type remainder = sizes[numNodes - 2] + sizes.back();
+                sizes[numNodes - 2] = remainder - remainder / 2;
+                sizes.back() = remainder / 2;
+            }
+            return sizes;
+        };
 
-            c = c + (step + 1);
+        // create the leaf level
+        std::vector<node*> nodes;
+        std::vector<Key> separators;
+        Iter cur = a;
+        for (size_type numKeys : nodeSizes(b - a)) {
+            if (!nodes.empty()) {
+                separators.push_back(*cur);
+                ++cur;
+            }
+            node* leaf = new leaf_node();
+            leaf->numElements = numKeys;
+            for (size_type i = 0; i < numKeys; ++i) {
+                leaf->keys[i] = cur[i];
+            }
+            cur = cur + numKeys;
+            nodes.push_back(leaf);
+        }
+
+        // create inner levels until a single root remains
+        while (nodes.size() > 1) {
+            std::vector<node*> parents;
+            std::vector<Key> parentSeparators;
+            size_type key = 0;
+            size_type child = 0;
+            for (size_type numKeys : nodeSizes(separators.size())) {
+                if (!parents.empty()) {
+                    parentSeparators.push_back(separators[key++]);
+                }
+                node* inner = new inner_node();
+                inner->numElements = numKeys;
+                for (size_type i = 0; i <= numKeys; ++i) {
+                    if (i < numKeys) {
+                        inner->keys[i] = separators[key + i];
+                    }
+                    node* next = nodes[child++];
+                    next->parent = inner;
+                    next->position = i;
+                    inner->getChildren()[i] = next;
+                }
+                key += numKeys;
+                parents.push_back(inner);
+            }
+            nodes.swap(parents);
+            separators.swap(parentSeparators);
         }
 
-        // and the remaining part
-        auto child = buildSubTree(c, b);
-        child->parent = res;
-        child->position = numKeys;
-        res->getChildren()[numKeys] = child;
-
-        // done
-        return res;
+        return nodes.front();
     }
 };  // namespace souffle
 
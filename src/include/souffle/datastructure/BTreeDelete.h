@@ -1032,6 +1032,47 @@ public:
             return *this;
         }
 
+        /**
+         * Obtains a position splitting the range from this iterator up to the given end
+         * into two non-empty halves. The position is the median of the elements within the
+         * range stored in the highest node covering it, such that both halves cover
+         * sub-trees of similar size.
+         *
+         * @param end .. the end of the range to be split
+         * @return an iterator strictly within the range, or end if it cannot be split
+         */
+        iterator split(const iterator& end) const {
+            if (cur == nullptr || *this == end) {
+                return end;
+            }
+
+            // the split position is searched top-down starting at the root
+            node const* n = cur;
+            while (n->getParent() != nullptr) {
+                n = n->getParent();
+            }
+
+            Comparator cmp;
+            const Key& low = **this;
+            while (true) {
+                auto a = &(n->keys[0]);
+                auto b = &(n->keys[n->getNumElements()]);
+
+                // candidates are the keys greater than the first and less than the end of the range
+                auto lo = search.upper_bound(low, a, b, cmp);
+                auto hi = (end.cur == nullptr) ? b : search.lower_bound(*end, a, b, cmp);
+                if (lo < hi) {
+                    return iterator(n, static_cast<field_index_type>((lo - a) + (hi - lo) / 2));
+                }
+
+                // otherwise all elements within the range are located in a single sub-tree
+                if (n->isLeaf()) {
+                    return end;
+                }
+                n = n->getChild(static_cast<size_type>(lo - a));
+            }
+        }
+
         // prints a textual representation of this iterator to the given stream (mainly for debugging)
         void print(std::ostream& out = std::cout) const {
             out << cur << "[" << (int)pos << "]";
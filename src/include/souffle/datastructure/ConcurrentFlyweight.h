@@ -8,12 +8,86 @@
 #pragma once
 
 #include "ConcurrentInsertOnlyHashMap.h"
+#include "souffle/datastructure/PiggyList.h"
 #include "souffle/utility/ParallelUtil.h"
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 
 namespace souffle {
 
+namespace details {
+
+/**
+ * An array of atomic values that grows by segments of doubling size.
+ *
+ * Segments never move once allocated, so a value can be read without
+ * locking while other threads grow the array. Values are published with
+ * release semantics and read with acquire semantics; a value that was never
+ * stored reads as `T{}`.
+ */
+template <class T, std::size_t FirstSegmentBits = 3>
+class SegmentedArray {
+public:
+    SegmentedArray() = default;
+    SegmentedArray(const SegmentedArray&) = delete;
+    SegmentedArray& operator=(const SegmentedArray&) = delete;
+
+    ~SegmentedArray() {
+        for (auto& Segment : Segments) {
+            delete[] Segment.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// Return the value at index I.
+    T load(const std::size_t I) const {
+        const auto [S, Offset] = position(I);
+        const std::atomic<T>* Segment = Segments[S].load(std::memory_order_acquire);
+        if (Segment == nullptr) {
+            return T{};
+        }
+        return Segment[Offset].load(std::memory_order_acquire);
+    }
+
+    /// Store a value at index I, allocating its segment if needed.
+    void store(const std::size_t I, const T Value) {
+        const auto [S, Offset] = position(I);
+        std::atomic<T>* Segment = Segments[S].load(std::memory_order_acquire);
+        if (Segment == nullptr) {
+            Segment = allocate(S);
+        }
+        Segment[Offset].store(Value, std::memory_order_release);
+    }
+
+private:
+    static constexpr std::size_t FirstSegmentSize = std::size_t(1) << FirstSegmentBits;
+
+    // Segment S holds the indexes [FirstSegmentSize * (2^S - 1), FirstSegmentSize * (2^(S+1) - 1)).
+    std::array<std::atomic<std::atomic<T>*>, 64 - FirstSegmentBits> Segments{};
+
+    /// Return the segment and the offset within that segment of index I.
+    static std::pair<std::size_t, std::size_t> position(const std::size_t I) {
+        const std::size_t N = I + FirstSegmentSize;
+        const std::size_t Bit = 63 - __builtin_clzll(N);
+        return {Bit - FirstSegmentBits, N - (std::size_t(1) << Bit)};
+    }
+
+    /// Allocate segment S, unless another thread allocated it concurrently.
+    std::atomic<T>* allocate(const std::size_t S) {
+        std::atomic<T>* Fresh = new std::atomic<T>[FirstSegmentSize << S]();
+        std::atomic<T>* Current = nullptr;
+        if (!Segments[S].compare_exchange_strong(
+                    Current, Fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            delete[] Fresh;
+            return Current;
+        }
+        return Fresh;
+    }
+};
+
+}  // namespace details
+
 /**
  * A concurrent, almost lock-free associative datastructure that implements the
  * Flyweight pattern.  Assigns a unique index to each inserted key. Elements
@@ -23,9 +97,10 @@ namespace souffle {
  * Access to the datastructure is lock-free between different lanes.
  * Concurrent accesses through the same lane is sequential.
  *
- * Growing the datastructure requires to temporarily lock all lanes to let a
+ * Growing the hash map requires to temporarily lock all lanes to let a
  * single lane perform the growing operation. The global lock is amortized
- * thanks to an exponential growth strategy.
+ * thanks to an exponential growth strategy. The index-to-key slots are stored
+ * in segments that never move, so fetching the key of an index takes no lock.
  *
  */
 template <class LanesPolicy, class Key, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>,
@@ -136,13 +211,11 @@ public:
         }
 
         reference operator*() const {
-            const auto Guard = This->Lanes.guard(Lane);
-            return *This->Slots[index(Slot)];
+            return *This->Slots.load(index(Slot));
         }
 
         pointer operator->() const {
-            const auto Guard = This->Lanes.guard(Lane);
-            return This->Slots[index(Slot)];
+            return This->Slots.load(index(Slot));
         }
 
         Iterator& operator++() {
@@ -233,10 +306,8 @@ public:
             : Lanes(LaneCount), HandleCount(LaneCount),
               Mapping(LaneCount, InitialCapacity, hash, key_equal, key_factory),
               FirstSlotIsReserved(ReserveFirst) {
-        Slots = std::make_unique<const value_type*[]>(InitialCapacity);
         Handles = std::make_unique<Handle[]>(HandleCount);
         NextSlot = (FirstSlotIsReserved ? 1 : 0);
-        SlotCount = InitialCapacity;
     }
 
     /// Initialize the datastructure with a capacity of 8 elements.
@@ -291,10 +362,11 @@ public:
 
     /// Return the value associated with the given index.
     /// Assumption: the index is mapped in the datastructure.
-    const Key& fetch(const lane_id H, const index_type Idx) const {
-        const auto Lane = Lanes.guard(H);
-        assert(Idx < SlotCount.load(std::memory_order_relaxed));
-        return Slots[Idx]->first;
+    /// Does not lock, the lane is only kept for interface compatibility.
+    const Key& fetch(const lane_id, const index_type Idx) const {
+        const value_type* Value = Slots.load(Idx);
+        assert(Value != nullptr && "index is not mapped");
+        return Value->first;
     }
 
     /// Return the pair of the index for the given value and a boolean
@@ -307,43 +379,18 @@ public:
         node_type Node;
 
         slot_type Slot = Handles[H].NextSlot;
-
-        // Getting the next insertion slot for the current lane may require
-        // more than one attempts if the datastructure must grow and other
-        // threads are waiting for the same lane @p H.
-        while (true) {
-            if (Slot == NONE) {
-                // Reserve a slot for the lane, the datastructure might need to
-                // grow before the slot memory location becomes available.
-                Slot = NextSlot++;
-                Handles[H].NextSlot = Slot;
-                Handles[H].NextNode = Mapping.node(static_cast<index_type>(Slot));
-            }
-
-            if (Slot >= SlotCount.load(std::memory_order_relaxed)) {
-                // The slot memory location is not yet available, try to
-                // grow the datastructure. Other threads in other lanes might
-                // be attempting to grow the datastructure concurrently.
-                //
-                // Anyway when this call returns the Slot memory location is
-                // available.
-                tryGrow(H);
-
-                // Reload the Slot for the current lane since another thread
-                // using the same lane may take-over the lane during tryGrow()
-                // and consume the slot before the current thread is
-                // rescheduled on the lane.
-                Slot = Handles[H].NextSlot;
-            } else {
-                // From here the slot is known, allocated and available.
-                break;
-            }
+        if (Slot == NONE) {
+            // Reserve a slot for the lane.
+            Slot = NextSlot++;
+            Handles[H].NextSlot = Slot;
+            Handles[H].NextNode = Mapping.node(static_cast<index_type>(Slot));
         }
 
         Node = Handles[H].NextNode;
 
-        // Insert key in the index in advance.
-        Slots[Slot] = &Node->value();
+        // Insert key in the index in advance, allocating the segment of the
+        // slot if needed; the key is published before the mapping below.
+        Slots.store(Slot, &Node->value());
 
         auto Res = Mapping.get(H, Node, std::forward<Args>(Xs)...);
         if (Res.second) {
@@ -358,7 +405,7 @@ public:
             // The reserved slot and node remains in the lane state so that
             // they can be consumed by the next insertion operation on this
             // lane.
-            Slots[Slot] = nullptr;
+            Slots.store(Slot, nullptr);
             return std::make_pair(Res.first->second, false);
         }
     }
@@ -389,7 +436,7 @@ private:
     std::unique_ptr<Handle[]> Handles;
 
     // Slots[I] points to the value associated with index I.
-    std::unique_ptr<const value_type*[]> Slots;
+    details::SegmentedArray<const value_type*> Slots;
 
     // The map from keys to index.
     map_type Mapping;
@@ -397,48 +444,8 @@ private:
     // Next available slot.
     std::atomic<slot_type> NextSlot;
 
-    // Number of slots.
-    std::atomic<slot_type> SlotCount;
-
     /// If true, the first slot (index 0) is not a valid entry.
     const bool FirstSlotIsReserved;
-
-    /// Grow the datastructure if needed.
-    bool tryGrow(const lane_id H) {
-        // This call may release and re-acquire the lane to
-        // allow progress of a concurrent growing operation.
-        //
-        // It is possible that another thread is waiting to
-        // enter the same lane, and that other thread might
-        // take and leave the lane before the current thread
-        // re-acquires it.
-        Lanes.beforeLockAllBut(H);
-
-        if (NextSlot < SlotCount) {
-            // Current size is fine
-            Lanes.beforeUnlockAllBut(H);
-            return false;
-        }
-
-        Lanes.lockAllBut(H);
-
-        {  // safe section
-            const std::size_t CurrentSize = SlotCount;
-            std::size_t NewSize = (CurrentSize << 1);  // double size policy
-            while (NewSize < NextSlot) {
-                NewSize <<= 1;  // double size
-            }
-            std::unique_ptr<const value_type*[]> NewSlots = std::make_unique<const value_type*[]>(NewSize);
-            std::memcpy(NewSlots.get(), Slots.get(), sizeof(const value_type*) * CurrentSize);
-            Slots = std::move(NewSlots);
-            SlotCount = NewSize;
-        }
-
-        Lanes.beforeUnlockAllBut(H);
-        Lanes.unlockAllBut(H);
-
-        return true;
-    }
 };
 
 #ifdef _OPENMP
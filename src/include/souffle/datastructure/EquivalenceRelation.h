@@ -24,14 +24,13 @@
 #include "souffle/datastructure/UnionFind.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <functional>
 #include <iostream>
 #include <iterator>
-#include <set>
-#include <shared_mutex>
 #include <stdexcept>
 #include <tuple>
 #include <unordered_set>
@@ -43,21 +42,10 @@ template <typename TupleType>
 class EquivalenceRelation {
     using value_type = typename TupleType::value_type;
 
-    // mapping from representative to disjoint set
-    // just a cache, essentially, used for iteration over
-    using StatesList = souffle::PiggyList<value_type>;
-    using StatesBucket = StatesList*;
-    using StorePair = std::pair<value_type, StatesBucket>;
-    using StatesMap = souffle::LambdaBTreeSet<StorePair, std::function<StatesBucket(StorePair&)>,
-            souffle::EqrelMapComparator<StorePair>>;
-
 public:
     using element_type = TupleType;
 
-    EquivalenceRelation() : statesMapStale(false) {}
-    ~EquivalenceRelation() {
-        emptyPartition();
-    }
+    EquivalenceRelation() = default;
 
     /**
      * A collection of operation hints speeding up some of the involved operations
@@ -99,8 +87,6 @@ public:
      * @return true if the pair is new to the data structure
      */
     bool insert(value_type x, value_type y, operation_hints) {
-        // indicate that iterators will have to generate on request
-        this->statesMapStale.store(true, std::memory_order_relaxed);
         bool retval = !contains(x, y);
         sds.unionNodes(x, y);
         return retval;
@@ -111,17 +97,11 @@ public:
      * @param other the binary relation from which to add elements from
      */
     void insertAll(const EquivalenceRelation<TupleType>& other) {
-        other.genAllDisjointSetLists();
-
-        // iterate over partitions at a time
-        for (auto&& [rep, pl] : other.equivalencePartition) {
-            const std::size_t ksize = pl->size();
-            for (std::size_t i = 0; i < ksize; ++i) {
-                this->sds.unionNodes(rep, pl->get(i));
-            }
+        // union every element with the representative of its set
+        const std::size_t numNodes = other.sds.size();
+        for (parent_t node = 0; node < numNodes; ++node) {
+            this->sds.unionNodes(other.sds.toSparse(other.sds.ds.findNode(node)), other.sds.toSparse(node));
         }
-        // invalidate iterators unconditionally
-        this->statesMapStale.store(true, std::memory_order_relaxed);
     }
 
     /**
@@ -214,27 +194,11 @@ public:
         return contains(tuple[0], tuple[1]);
     }
 
-    void emptyPartition() const {
-        // delete the beautiful values inside (they're raw ptrs, so they need to be.)
-        for (auto& pair : equivalencePartition) {
-            delete pair.second;
-        }
-        // invalidate it my dude
-        this->statesMapStale.store(true, std::memory_order_relaxed);
-
-        equivalencePartition.clear();
-    }
-
     /**
      * Empty the relation
      */
     void clear() {
-        statesLock.lock();
-
         sds.clear();
-        emptyPartition();
-
-        statesLock.unlock();
     }
 
     /**
@@ -242,24 +206,16 @@ public:
      * @return the sum of the number of pairs per disjoint set
      */
     std::size_t size() const {
-        genAllDisjointSetLists();
-
-        statesLock.lock_shared();
-
-        std::size_t retVal = 0;
-        for (auto& e : this->equivalencePartition) {
-            const std::size_t s = e.second->size();
-            retVal += s * s;
-        }
-
-        statesLock.unlock_shared();
-        return retVal;
+        return sds.ds.numPairs();
     }
 
     // an almighty iterator for several types of iteration.
     // Unfortunately, subclassing isn't an option with souffle
     //   - we don't deal with pointers (so no virtual)
     //   - and a single iter type is expected (see Relation::iterator e.g.) (i think)
+    //
+    // Elements are tracked by their dense encoding; the members of a set are enumerated by following
+    // the circular member list of the disjoint set from a starting member back to it.
     class iterator {
     public:
         typedef std::forward_iterator_tag iterator_category;
@@ -268,81 +224,28 @@ public:
         using pointer = value_type*;
         using reference = value_type&;
 
+        // all the different types of iterator this can be
+        enum IterType { ALL, ANTERIOR, ANTPOST, WITHIN };
+
         // one iterator for signalling the end (simplifies)
         explicit iterator(const EquivalenceRelation* br, bool /* signalIsEndIterator */)
                 : br(br), isEndVal(true) {}
 
-        explicit iterator(const EquivalenceRelation* br)
-                : br(br), ityp(IterType::ALL), djSetMapListIt(br->equivalencePartition.begin()),
-                  djSetMapListEnd(br->equivalencePartition.end()) {
-            // no need to fast forward if this iterator is empty
-            if (djSetMapListIt == djSetMapListEnd) {
-                isEndVal = true;
-                return;
-            }
-            // grab the pointer to the list, and make it our current list
-            djSetList = (*djSetMapListIt).second;
-            assert(djSetList->size() != 0);
-
-            updateAnterior();
-            updatePosterior();
-        }
-
-        // WITHIN: iterator for everything within the same DJset (used for EquivalenceRelation.partition())
-        explicit iterator(const EquivalenceRelation* br, const StatesBucket within)
-                : br(br), ityp(IterType::WITHIN), djSetList(within) {
-            // empty dj set
-            if (djSetList->size() == 0) {
-                isEndVal = true;
+        // ALL: iterator over all pairs of the disjoint sets whose representatives lie in [from, to)
+        explicit iterator(const EquivalenceRelation* br, parent_t from, parent_t to)
+                : br(br), ityp(IterType::ALL), cursor(from), last(to) {
+            if (seekSet()) {
+                update();
             }
-
-            updateAnterior();
-            updatePosterior();
         }
 
-        // ANTERIOR: iterator that yields all (former, _) \in djset(former) (djset(former) === within)
-        explicit iterator(const EquivalenceRelation* br, const typename TupleType::value_type former,
-                const StatesBucket within)
-                : br(br), ityp(IterType::ANTERIOR), djSetList(within) {
-            if (djSetList->size() == 0) {
-                isEndVal = true;
-            }
-
-            setAnterior(former);
-            updatePosterior();
-        }
-
-        // ANTPOST: iterator that yields all (former, latter) \in djset(former), (djset(former) ==
-        // djset(latter) == within)
-        explicit iterator(const EquivalenceRelation* br, const typename TupleType::value_type former,
-                typename TupleType::value_type latter, const StatesBucket within)
-                : br(br), ityp(IterType::ANTPOST), djSetList(within) {
-            if (djSetList->size() == 0) {
-                isEndVal = true;
-            }
-
-            setAnterior(former);
-            setPosterior(latter);
-        }
-
-        /** explicit set first half of cPair */
-        inline void setAnterior(const typename TupleType::value_type a) {
-            this->cPair[0] = a;
-        }
-
-        /** quick update to whatever the current index is pointing to */
-        inline void updateAnterior() {
-            this->cPair[0] = this->djSetList->get(this->cAnteriorIndex);
-        }
-
-        /** explicit set second half of cPair */
-        inline void setPosterior(const typename TupleType::value_type b) {
-            this->cPair[1] = b;
-        }
-
-        /** quick update to whatever the current index is pointing to */
-        inline void updatePosterior() {
-            this->cPair[1] = this->djSetList->get(this->cPosteriorIndex);
+        // WITHIN: all pairs of the dj set of the given member (used for EquivalenceRelation.partition())
+        // ANTERIOR: all (anterior, _) \in djset(anterior), where posterior == anterior
+        // ANTPOST: exactly (anterior, posterior), both being in the same djset
+        explicit iterator(
+                const EquivalenceRelation* br, IterType ityp, parent_t anterior, parent_t posterior)
+                : br(br), ityp(ityp), first(posterior), anterior(anterior), posterior(posterior) {
+            update();
         }
 
         // copy ctor
@@ -377,78 +280,33 @@ public:
 
             switch (ityp) {
                 case IterType::ALL:
-                    // move posterior along one
-                    // see if we can't move the posterior along
-                    if (++cPosteriorIndex == djSetList->size()) {
-                        // move anterior along one
-                        // see if we can't move the anterior along one
-                        if (++cAnteriorIndex == djSetList->size()) {
-                            // move the djset it along one
-                            // see if we can't move it along one (we're at the end)
-                            if (++djSetMapListIt == djSetMapListEnd) {
+                case IterType::WITHIN:
+                    // move posterior along one, and once it went around the set, the anterior
+                    if ((posterior = br->nextMember(posterior)) == first) {
+                        if ((anterior = br->nextMember(anterior)) == first) {
+                            // the set is exhausted; ALL moves on to the next set
+                            if (ityp == IterType::WITHIN || (++cursor, !seekSet())) {
                                 isEndVal = true;
                                 return *this;
                             }
-
-                            // we can't iterate along this djset if it is empty
-                            djSetList = (*djSetMapListIt).second;
-                            if (djSetList->size() == 0) {
-                                throw std::out_of_range("error: encountered a zero size djset");
-                            }
-
-                            // update our cAnterior and cPosterior
-                            cAnteriorIndex = 0;
-                            cPosteriorIndex = 0;
-                            updateAnterior();
-                            updatePosterior();
                         }
-
-                        // we moved our anterior along one
-                        updateAnterior();
-
-                        cPosteriorIndex = 0;
-                        updatePosterior();
                     }
-                    // we just moved our posterior along one
-                    updatePosterior();
-
                     break;
                 case IterType::ANTERIOR:
-                    // step posterior along one, and if we can't, then we're done.
-                    if (++cPosteriorIndex == djSetList->size()) {
+                    // step posterior along one, and if it went around the set, then we're done.
+                    if ((posterior = br->nextMember(posterior)) == first) {
                         isEndVal = true;
                         return *this;
                     }
-                    updatePosterior();
-
                     break;
                 case IterType::ANTPOST:
                     // fixed anterior and posterior literally only points to one, so if we increment, its the
                     // end
                     isEndVal = true;
-                    break;
-                case IterType::WITHIN:
-                    // move posterior along one
-                    // see if we can't move the posterior along
-                    if (++cPosteriorIndex == djSetList->size()) {
-                        // move anterior along one
-                        // see if we can't move the anterior along one
-                        if (++cAnteriorIndex == djSetList->size()) {
-                            isEndVal = true;
-                            return *this;
-                        }
-
-                        // we moved our anterior along one
-                        updateAnterior();
-
-                        cPosteriorIndex = 0;
-                        updatePosterior();
-                    }
-                    // we just moved our posterior along one
-                    updatePosterior();
-                    break;
+                    return *this;
             }
 
+            update();
             return *this;
         }
 
@@ -457,21 +315,38 @@ public:
         // special tombstone value to notify that this iter represents the end
         bool isEndVal = false;
 
-        // all the different types of iterator this can be
-        enum IterType { ALL, ANTERIOR, ANTPOST, WITHIN };
         IterType ityp;
 
         TupleType cPair;
 
-        // the disjoint set that we're currently iterating through
-        StatesBucket djSetList;
-        typename StatesMap::iterator djSetMapListIt;
-        typename StatesMap::iterator djSetMapListEnd;
+        // the member at which the iteration of the current set started and ends
+        parent_t first = 0;
+        // the dense encodings of the current pair
+        parent_t anterior = 0;
+        parent_t posterior = 0;
+
+        // used for ALL, the candidate representative and the end of the range of representatives
+        parent_t cursor = 0;
+        parent_t last = 0;
 
-        // used for ALL, and POSTERIOR (just a current index in the cList)
-        std::size_t cAnteriorIndex = 0;
-        // used for ALL, and ANTERIOR (just a current index in the cList)
-        std::size_t cPosteriorIndex = 0;
+        /** update the current pair to whatever the anterior and posterior are pointing to */
+        inline void update() {
+            cPair[0] = br->sds.toSparse(anterior);
+            cPair[1] = br->sds.toSparse(posterior);
+        }
+
+        /** fast forward to the first set whose representative is not before the cursor */
+        bool seekSet() {
+            while (cursor < last && !br->isRepresentative(cursor)) {
+                ++cursor;
+            }
+            if (cursor == last) {
+                isEndVal = true;
+                return false;
+            }
+            first = anterior = posterior = cursor;
+            return true;
+        }
     };
 
 public:
@@ -480,8 +355,7 @@ public:
      * @return the iterator that corresponds to the beginning of the binary relation
      */
     iterator begin() const {
-        genAllDisjointSetLists();
-        return iterator(this);
+        return iterator(this, 0, sds.size());
     }
 
     /**
@@ -619,14 +493,8 @@ public:
      * @return the iterator representing this.
      */
     iterator anteriorIt(value_type anteriorVal) const {
-        genAllDisjointSetLists();
-
-        // locate the blocklist that the anterior val resides in
-        auto found = equivalencePartition.find({sds.findNode(anteriorVal), nullptr});
-        assert(found != equivalencePartition.end() && "iterator called on partition that doesn't exist");
-
-        return iterator(static_cast<const EquivalenceRelation*>(this),
-                static_cast<const value_type>(anteriorVal), static_cast<const StatesBucket>((*found).second));
+        const parent_t anterior = sds.toDense(anteriorVal);
+        return iterator(this, iterator::IterType::ANTERIOR, anterior, anterior);
     }
 
     /**
@@ -641,13 +509,8 @@ public:
         // obv if they're in diff sets, then iteration for this pair just ends.
         if (!sds.sameSet(anteriorVal, posteriorVal)) return end();
 
-        genAllDisjointSetLists();
-
-        // locate the blocklist that the val resides in
-        auto found = equivalencePartition.find({sds.findNode(posteriorVal), nullptr});
-        assert(found != equivalencePartition.end() && "iterator called on partition that doesn't exist");
-
-        return iterator(this, anteriorVal, posteriorVal, (*found).second);
+        return iterator(
+                this, iterator::IterType::ANTPOST, sds.toDense(anteriorVal), sds.toDense(posteriorVal));
     }
 
     /**
@@ -656,11 +519,8 @@ public:
      * @return an iterator that will generate all pairs within the disjoint set
      */
     iterator closure(value_type rep) const {
-        genAllDisjointSetLists();
-
-        // locate the blocklist that the val resides in
-        auto found = equivalencePartition.find({sds.findNode(rep), nullptr});
-        return iterator(this, (*found).second);
+        const parent_t member = sds.toDense(rep);
+        return iterator(this, iterator::IterType::WITHIN, member, member);
     }
 
     /**
@@ -672,36 +532,41 @@ public:
      * @return a list of the iterators as ranges
      */
     std::vector<souffle::range<iterator>> partition(std::size_t chunks) const {
-        // generate all reps
-        genAllDisjointSetLists();
-
         std::size_t numPairs = this->size();
         if (numPairs == 0) return {};
         if (numPairs == 1 || chunks <= 1) return {souffle::make_range(begin(), end())};
 
-        // if there's more dj sets than requested chunks, then just return an iter per dj set
+        // cut the dense encodings into intervals whose dj sets hold about numpairs/chunks pairs together;
+        // a dj set exceeding that on its own gets an anteriorIt per element instead
+        const std::size_t perchunk = std::max<std::size_t>(numPairs / chunks, 1);
+        const parent_t numNodes = sds.size();
         std::vector<souffle::range<iterator>> ret;
-        if (chunks <= equivalencePartition.size()) {
-            for (auto& p : equivalencePartition) {
-                ret.push_back(souffle::make_range(closure(p.first), end()));
-            }
-            return ret;
-        }
-
-        // keep it simple stupid
-        // just go through and if the size of the binrel is > numpairs/chunks, then generate an anteriorIt for
-        // each
-        const std::size_t perchunk = numPairs / chunks;
-        for (const auto& itp : equivalencePartition) {
-            const std::size_t s = itp.second->size();
+        parent_t from = 0;
+        std::size_t pairs = 0;
+        for (parent_t node = 0; node < numNodes; ++node) {
+            if (!isRepresentative(node)) continue;
+            const std::size_t s = sds.ds.setSize(node);
             if (s * s > perchunk) {
-                for (const auto& i : *itp.second) {
-                    ret.push_back(souffle::make_range(anteriorIt(i), end()));
+                if (pairs != 0) {
+                    ret.push_back(souffle::make_range(iterator(this, from, node), end()));
                 }
-            } else {
-                ret.push_back(souffle::make_range(closure(itp.first), end()));
+                parent_t member = node;
+                do {
+                    ret.push_back(souffle::make_range(
+                            iterator(this, iterator::IterType::ANTERIOR, member, member), end()));
+                    member = nextMember(member);
+                } while (member != node);
+                from = node + 1;
+                pairs = 0;
+            } else if ((pairs += s * s) >= perchunk) {
+                ret.push_back(souffle::make_range(iterator(this, from, node + 1), end()));
+                from = node + 1;
+                pairs = 0;
             }
         }
+        if (pairs != 0) {
+            ret.push_back(souffle::make_range(iterator(this, from, numNodes), end()));
+        }
 
         return ret;
     }
@@ -728,45 +593,14 @@ private:
     // const operations *may* safely change internal state (i.e. collapse djset forest)
     mutable souffle::SparseDisjointSet<value_type> sds;
 
-    // read/write lock on equivalencePartition
-    mutable std::shared_mutex statesLock;
-
-    mutable StatesMap equivalencePartition;
-    // whether the cache is stale
-    mutable std::atomic<bool> statesMapStale;
-
-    /**
-     * Generate a cache of the sets such that they can be iterated over efficiently.
-     * Each set is partitioned into a PiggyList.
-     */
-    void genAllDisjointSetLists() const {
-        statesLock.lock();
-
-        // no need to generate again, already done.
-        if (!this->statesMapStale.load(std::memory_order_acquire)) {
-            statesLock.unlock();
-            return;
-        }
-
-        // btree version
-        emptyPartition();
-
-        std::size_t dSetSize = this->sds.ds.a_blocks.size();
-        for (std::size_t i = 0; i < dSetSize; ++i) {
-            typename TupleType::value_type sparseVal = this->sds.toSparse(i);
-            parent_t rep = this->sds.findNode(sparseVal);
-
-            StorePair p = {static_cast<value_type>(rep), nullptr};
-            StatesList* mapList = equivalencePartition.insert(p, [&](StorePair& sp) {
-                auto* r = new StatesList(1);
-                sp.second = r;
-                return r;
-            });
-            mapList->append(sparseVal);
-        }
+    /** the next member of the dj set of the given dense encoding */
+    parent_t nextMember(parent_t node) const {
+        return sds.ds.nextInSet(node);
+    }
 
-        statesMapStale.store(false, std::memory_order_release);
-        statesLock.unlock();
+    /** whether the given dense encoding is the representative of its dj set */
+    bool isRepresentative(parent_t node) const {
+        return sds.ds.isRoot(node);
     }
 };
 }  // namespace souffle
@@ -19,10 +19,12 @@
 #include "souffle/datastructure/ConcurrentFlyweight.h"
 #include "souffle/utility/span.h"
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -506,27 +508,34 @@ public:
                     RamDomain /* key */)>&) const override {}
 };
 
-/** A concurrent Record Table with some specialized record maps. */
+/**
+ * A concurrent Record Table with some specialized record maps.
+ *
+ * The record maps are indexed by arity in segments that never move, so that
+ * unpacking a record takes no lock. Packing only locks to create the record
+ * map of an arity that has not been seen before.
+ */
 template <std::size_t... SpecializedArities>
 class SpecializedRecordTable : public RecordTable {
 private:
-    // The current size of the Maps vector.
-    std::size_t Size;
+    // One more than the largest arity with a record map.
+    std::atomic<std::size_t> Size;
 
     // The record maps, indexed by arity.
-    std::vector<RecordMap*> Maps;
+    details::SegmentedArray<RecordMap*> Maps;
 
-    // The concurrency manager.
-    mutable ConcurrentLanes Lanes;
+    // The number of concurrent access lanes of the record maps.
+    std::size_t LaneCount;
+
+    // Serialises the creation of record maps.
+    std::mutex CreateLock;
 
     template <std::size_t Arity, std::size_t... Arities>
     void CreateSpecializedMaps() {
         if (Arity >= Size) {
             Size = Arity + 1;
-            Maps.reserve(Size);
-            Maps.resize(Size);
         }
-        Maps[Arity] = new SpecializedRecordMap<Arity>(Lanes.lanes());
+        Maps.store(Arity, new SpecializedRecordMap<Arity>(LaneCount));
         if constexpr (sizeof...(Arities) > 0) {
             CreateSpecializedMaps<Arities...>();
         }
@@ -534,15 +543,15 @@ private:
 
 public:
     /** @brief Construct a record table with the number of concurrent access lanes. */
-    SpecializedRecordTable(const std::size_t LaneCount) : Size(0), Lanes(LaneCount) {
+    SpecializedRecordTable(const std::size_t LaneCount) : Size(0), LaneCount(LaneCount) {
         CreateSpecializedMaps<SpecializedArities...>();
     }
 
     SpecializedRecordTable() : SpecializedRecordTable(1) {}
 
     virtual ~SpecializedRecordTable() {
-        for (auto Map : Maps) {
-            delete Map;
+        for (std::size_t Arity = 0; Arity < Size; ++Arity) {
+            delete Maps.load(Arity);
         }
     }
 
@@ -551,9 +560,9 @@ public:
      * Not thread-safe, use only when the datastructure is not being used.
      */
     virtual void setNumLanes(const std::size_t NumLanes) override {
-        Lanes.setNumLanes(NumLanes);
-        for (auto& Map : Maps) {
-            if (Map) {
+        LaneCount = NumLanes;
+        for (std::size_t Arity = 0; Arity < Size; ++Arity) {
+            if (RecordMap* Map = Maps.load(Arity)) {
                 Map->setNumLanes(NumLanes);
             }
         }
@@ -561,27 +570,23 @@ public:
 
     /** @brief convert tuple to record reference */
     virtual RamDomain pack(const RamDomain* Tuple, const std::size_t Arity) override {
-        auto Guard = Lanes.guard();
         return lookupMap(Arity).pack(Tuple);
     }
 
     /** @brief convert tuple to record reference */
     virtual RamDomain pack(const std::initializer_list<RamDomain>& List) override {
-        auto Guard = Lanes.guard();
         return lookupMap(List.size()).pack(std::data(List));
     }
 
     /** @brief convert record reference to a record */
     virtual const RamDomain* unpack(const RamDomain Ref, const std::size_t Arity) const override {
-        auto Guard = Lanes.guard();
         return lookupMap(Arity).unpack(Ref);
     }
 
     void enumerate(const std::function<void(const RamDomain* /*tuple*/, std::size_t /* arity*/,
                     RamDomain /* key */)>& Callback) const override {
-        auto Guard = Lanes.guard();
-        for (std::size_t Arity = 0; Arity < Maps.size(); ++Arity) {
-            const RecordMap* Map = Maps.at(Arity);
+        for (std::size_t Arity = 0; Arity < Size; ++Arity) {
+            const RecordMap* Map = Maps.load(Arity);
             if (Map != nullptr) {
                 Map->enumerate(Callback);
             }
@@ -591,44 +596,32 @@ public:
 private:
     /** @brief lookup RecordMap for a given arity; the map for that arity must exist. */
     RecordMap& lookupMap(const std::size_t Arity) const {
-        assert(Arity < Size && "Lookup for an arity while there is no record for that arity.");
-        auto* Map = Maps[Arity];
+        auto* Map = Maps.load(Arity);
         assert(Map != nullptr && "Lookup for an arity while there is no record for that arity.");
         return *Map;
     }
 
     /** @brief lookup RecordMap for a given arity; if it does not exist, create new RecordMap */
     RecordMap& lookupMap(const std::size_t Arity) {
-        if (Arity < Size) {
-            auto* Map = Maps[Arity];
-            if (Map) {
-                return *Map;
-            }
+        if (auto* Map = Maps.load(Arity)) {
+            return *Map;
         }
-
-        createMap(Arity);
-        return *Maps[Arity];
+        return createMap(Arity);
     }
 
     /** @brief create the RecordMap for the given arity. */
-    void createMap(const std::size_t Arity) {
-        Lanes.beforeLockAllBut();
-        if (Arity < Size && Maps[Arity] != nullptr) {
+    RecordMap& createMap(const std::size_t Arity) {
+        std::lock_guard<std::mutex> Guard(CreateLock);
+        if (auto* Map = Maps.load(Arity)) {
             // Map of required arity has been created concurrently
-            Lanes.beforeUnlockAllBut();
-            return;
+            return *Map;
         }
-        Lanes.lockAllBut();
-
+        auto* Map = new GenericRecordMap(LaneCount, Arity);
+        Maps.store(Arity, Map);
         if (Arity >= Size) {
             Size = Arity + 1;
-            Maps.reserve(Size);
-            Maps.resize(Size);
         }
-        Maps[Arity] = new GenericRecordMap(Lanes.lanes(), Arity);
-
-        Lanes.beforeUnlockAllBut();
-        Lanes.unlockAllBut();
+        return *Map;
     }
 };
 
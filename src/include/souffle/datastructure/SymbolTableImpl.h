@@ -21,11 +21,16 @@
 #include "souffle/utility/StreamUtil.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <deque>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -37,12 +42,33 @@ namespace souffle {
  * @class SymbolTableImpl
  *
  * Implementation of the symbol table.
+ *
+ * Each thread keeps a small direct-mapped cache per table in front of the
+ * shared flyweight so that repeatedly encoding the same hot symbols does not
+ * hash the full string nor take the lane lock. Cache entries only point to
+ * interned strings, which never move while the table is alive. Decoding reads
+ * the lock-free slots of the flyweight directly.
  */
 class SymbolTableImpl : public SymbolTable, protected FlyweightImpl<std::string> {
 private:
     using Base = FlyweightImpl<std::string>;
+    using index_type = Base::index_type;
 
 public:
+    /** Hit and miss counts of the per-thread symbol caches */
+    struct CacheStatistics {
+        std::size_t encodeHits = 0;
+        std::size_t encodeMisses = 0;
+
+        std::size_t hits() const {
+            return encodeHits;
+        }
+
+        std::size_t misses() const {
+            return encodeMisses;
+        }
+    };
+
     class IteratorImpl : public SymbolTableIteratorInterface, private Base::iterator {
     public:
         IteratorImpl(Base::iterator&& it) : Base::iterator(it) {}
@@ -70,10 +96,10 @@ public:
     using iterator = SymbolTable::Iterator;
 
     /** @brief Construct a symbol table with the given number of concurrent access lanes. */
-    SymbolTableImpl(const std::size_t LaneCount = 1) : Base(LaneCount) {}
+    SymbolTableImpl(const std::size_t LaneCount = 1) : Base(LaneCount), id(nextId()) {}
 
     /** @brief Construct a symbol table with the given initial symbols. */
-    SymbolTableImpl(std::initializer_list<std::string> symbols) : Base(1, symbols.size()) {
+    SymbolTableImpl(std::initializer_list<std::string> symbols) : Base(1, symbols.size()), id(nextId()) {
         for (const auto& symbol : symbols) {
             findOrInsert(symbol);
         }
@@ -82,7 +108,7 @@ public:
     /** @brief Construct a symbol table with the given number of concurrent access lanes and initial symbols.
      */
     SymbolTableImpl(const std::size_t LaneCount, std::initializer_list<std::string> symbols)
-            : Base(LaneCount, symbols.size()) {
+            : Base(LaneCount, symbols.size()), id(nextId()) {
         for (const auto& symbol : symbols) {
             findOrInsert(symbol);
         }
@@ -109,7 +135,7 @@ public:
     }
 
     RamDomain encode(const std::string& symbol) override {
-        return Base::findOrInsert(symbol).first;
+        return findOrInsert(symbol).first;
     }
 
     const std::string& decode(const RamDomain index) const override {
@@ -125,9 +151,122 @@ public:
     }
 
     std::pair<RamDomain, bool> findOrInsert(const std::string& symbol) override {
+        ThreadCache& cache = threadCache();
+        Entry& entry = cache.encodes[slot(symbol)];
+        if (entry.symbol != nullptr && entry.symbol->size() == symbol.size() &&
+                std::memcmp(entry.symbol->data(), symbol.data(), symbol.size()) == 0) {
+            increment(cache.counters->encodeHits);
+            return std::make_pair(entry.index, false);
+        }
+        increment(cache.counters->encodeMisses);
         auto Res = Base::findOrInsert(symbol);
-        return std::make_pair(static_cast<RamDomain>(Res.first), Res.second);
+        const auto index = static_cast<RamDomain>(Res.first);
+        // Cache the interned copy, never the caller's string which may be a temporary
+        entry = {index, &Base::fetch(Res.first)};
+        return std::make_pair(index, Res.second);
     }
+
+    /**
+     * @brief Return the hit and miss counts of the symbol caches of all threads.
+     * The counts are only exact when no other thread is using the table.
+     */
+    CacheStatistics getCacheStatistics() const {
+        CacheStatistics total;
+        std::lock_guard<std::mutex> guard(countersMutex);
+        for (const auto& entry : counters) {
+            const Counters& c = entry.second;
+            total.encodeHits += c.encodeHits.load(std::memory_order_relaxed);
+            total.encodeMisses += c.encodeMisses.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    /** Number of entries of each direct-mapped cache; must be a power of two */
+    static constexpr std::size_t CacheSize = 256;
+
+    /** Number of tables each thread caches symbols of at the same time */
+    static constexpr std::size_t CachedTables = 4;
+
+    /** Counters of a single thread, only ever written by that thread */
+    struct Counters {
+        std::atomic<std::size_t> encodeHits{0};
+        std::atomic<std::size_t> encodeMisses{0};
+    };
+
+    /** Cache entry associating an interned symbol with its index */
+    struct Entry {
+        RamDomain index;
+        const std::string* symbol;
+    };
+
+    /** Cache of the current thread, valid for the symbol table with the given id only */
+    struct ThreadCache {
+        std::uint64_t owner = 0;
+        Counters* counters = nullptr;
+        std::array<Entry, CacheSize> encodes{};
+    };
+
+    /** Caches of the current thread for the tables it used last */
+    struct ThreadCaches {
+        std::array<ThreadCache, CachedTables> tables{};
+        // the cache to be reassigned next
+        std::size_t victim = 0;
+    };
+
+    /** Unique identifier of a symbol table; unlike its address it is never reused */
+    static std::uint64_t nextId() {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    /** Unique identifier of the current thread; unlike std::thread::id it is never reused */
+    static std::uint64_t threadId() {
+        static std::atomic<std::uint64_t> counter{0};
+        static thread_local const std::uint64_t id = ++counter;
+        return id;
+    }
+
+    /** Increment a counter owned by the current thread without a locked instruction */
+    static void increment(std::atomic<std::size_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /** Cheap hash of the length and the outer bytes of a symbol */
+    static std::size_t slot(const std::string& symbol) {
+        const std::size_t size = symbol.size();
+        std::uint64_t head = 0;
+        std::uint64_t tail = 0;
+        const std::size_t n = std::min<std::size_t>(size, sizeof(head));
+        std::memcpy(&head, symbol.data(), n);
+        std::memcpy(&tail, symbol.data() + size - n, n);
+        std::uint64_t h = (head ^ (tail * 0x9E3779B97F4A7C15ULL) ^ size) * 0xFF51AFD7ED558CCDULL;
+        return static_cast<std::size_t>(h >> 56) % CacheSize;
+    }
+
+    /** Return the cache of the current thread for this table, reassigning the oldest one on a miss */
+    ThreadCache& threadCache() const {
+        static thread_local ThreadCaches caches;
+        for (auto& cache : caches.tables) {
+            if (cache.owner == id) {
+                return cache;
+            }
+        }
+        ThreadCache& cache = caches.tables[caches.victim];
+        caches.victim = (caches.victim + 1) % CachedTables;
+        cache.encodes.fill({});
+        std::lock_guard<std::mutex> guard(countersMutex);
+        cache.counters = &counters[threadId()];
+        cache.owner = id;
+        return cache;
+    }
+
+    /** Identifier tagging the thread caches that belong to this table */
+    const std::uint64_t id;
+
+    /** Cache counters of each thread that accessed this table */
+    mutable std::unordered_map<std::uint64_t, Counters> counters;
+    mutable std::mutex countersMutex;
 };
 
 }  // namespace souffle
@@ -19,10 +19,13 @@
 #include "souffle/datastructure/LambdaBTree.h"
 #include "souffle/datastructure/PiggyList.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <mutex>
 #include <utility>
 
 namespace souffle {
@@ -45,6 +48,9 @@ constexpr block_t rank_mask = (1ul << split_size) - 1;
 
 /**
  * Structure that emulates a Disjoint Set, i.e. a data structure that supports efficient union-find operations
+ *
+ * Besides the union-find forest, the members of each set are kept in a circular list, which is
+ * spliced on union, so the sets can be enumerated without a rebuild.
  */
 class DisjointSet {
     template <typename TupleType>
@@ -52,6 +58,18 @@ class DisjointSet {
 
     PiggyList<std::atomic<block_t>> a_blocks;
 
+    // the next member of the set of each node, forming a circular list per set
+    RandomInsertPiggyList<parent_t> a_next;
+    // the number of members of the set of each root (stale for other nodes)
+    RandomInsertPiggyList<std::size_t> a_sizes;
+    // the number of ordered pairs of nodes in the same set
+    std::atomic<std::size_t> pairCount{0};
+
+    // locks of the roots being linked, striped by node, such that member lists and sizes are merged
+    // consistently while links of unrelated roots proceed concurrently
+    static constexpr std::size_t RootLockStripes = 64;
+    std::array<SpinLock, RootLockStripes> rootLocks;
+
 public:
     DisjointSet() = default;
 
@@ -73,6 +91,35 @@ public:
         return sz;
     };
 
+    /**
+     * Return the number of ordered pairs of nodes that are in the same set
+     */
+    inline std::size_t numPairs() const {
+        return pairCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Yield the next member of the set of the given node; following it from any member
+     * enumerates the whole set and returns to that member
+     */
+    inline parent_t nextInSet(parent_t node) const {
+        return a_next.get(node);
+    }
+
+    /**
+     * Return the number of members of the set of which the given node is the root
+     */
+    inline std::size_t setSize(parent_t root) const {
+        return a_sizes.get(root);
+    }
+
+    /**
+     * Check whether the given node is the root of its set
+     */
+    inline bool isRoot(parent_t node) const {
+        return b2p(get(node)) == node;
+    }
+
     /**
      * Yield reference to the node by its node index
      * @param node node to be searched
@@ -127,6 +174,35 @@ private:
         return this->get(x).compare_exchange_strong(oldState, newVal);
     }
 
+    /**
+     * Merge the member list and size of the set of root x into those of root y
+     * Splicing two circular lists only requires swapping the successors of one node of each.
+     */
+    void splice(const parent_t x, const parent_t y) {
+        std::swap(a_next.get(x), a_next.get(y));
+        const std::size_t xsize = a_sizes.get(x);
+        const std::size_t ysize = a_sizes.get(y);
+        a_sizes.get(y) = xsize + ysize;
+        pairCount += 2 * xsize * ysize;
+    }
+
+    /**
+     * Lock the two given roots; stripes are locked in ascending order to avoid deadlocks
+     */
+    std::pair<std::unique_lock<SpinLock>, std::unique_lock<SpinLock>> lockRoots(
+            const parent_t x, const parent_t y) {
+        std::size_t first = x % RootLockStripes;
+        std::size_t second = y % RootLockStripes;
+        if (first > second) {
+            std::swap(first, second);
+        }
+        std::unique_lock<SpinLock> firstGuard(rootLocks[first]);
+        if (first == second) {
+            return {std::move(firstGuard), std::unique_lock<SpinLock>()};
+        }
+        return {std::move(firstGuard), std::unique_lock<SpinLock>(rootLocks[second])};
+    }
+
 public:
     /**
      * Clears the DisjointSet of all nodes
@@ -134,6 +210,9 @@ public:
      */
     void clear() {
         a_blocks.clear();
+        a_next.clear();
+        a_sizes.clear();
+        pairCount.store(0);
     }
 
     /**
@@ -173,15 +252,16 @@ public:
                 std::swap(x, y);
                 std::swap(xrank, yrank);
             }
-            // join the trees together
-            // perhaps we can optimise the use of compare_exchange_strong here, as we're in a pessimistic loop
-            if (!updateRoot(x, xrank, y, yrank)) {
+            // join the trees together; y may have been linked in the interim as well
+            auto guards = lockRoots(x, y);
+            if (!isRoot(y) || !updateRoot(x, xrank, y, yrank)) {
                 continue;
             }
             // make sure that the ranks are orderable
             if (xrank == yrank) {
                 updateRoot(y, yrank, y, yrank + 1);
             }
+            splice(x, y);
             break;
         }
     }
@@ -194,6 +274,11 @@ public:
         // make node and find out where we've added it
         std::size_t nodeDetails = a_blocks.createNode();
 
+        // the node forms a set on its own
+        a_next.insertAt(nodeDetails, nodeDetails);
+        a_sizes.insertAt(nodeDetails, 1);
+        ++pairCount;
+
         a_blocks.get(nodeDetails).store(pr2b(nodeDetails, 0));
 
         return a_blocks.get(nodeDetails).load();
@@ -0,0 +1,84 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file BinaryFormat.h
+ *
+ * Layout of the binary columnar fact files read and written by IO=binary.
+ *
+ * A file consists of
+ *  - a fixed header (see BinaryFactsHeader),
+ *  - one type character per attribute, padded to a multiple of 8 bytes,
+ *  - the attribute columns, each holding `tuples` RamDomain values,
+ *  - the symbol dictionary: `symbols` strings, each stored as a 64 bit
+ *    length followed by its characters.
+ *
+ * Symbol columns hold indices into the dictionary rather than symbol table
+ * ordinals, so that files can be shared between programs. All values are
+ * stored in native byte order.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace souffle {
+
+struct BinaryFactsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t domainSize;
+    uint64_t arity;
+    uint64_t tuples;
+    uint64_t symbols;
+
+    static constexpr char expectedMagic[8] = {'S', 'O', 'U', 'F', 'F', 'L', 'E', 'B'};
+    static constexpr uint32_t currentVersion = 1;
+
+    /** Create the header of a file holding the given number of tuples and symbols */
+    static BinaryFactsHeader create(std::size_t arity, std::size_t tuples, std::size_t symbols) {
+        BinaryFactsHeader header{};
+        std::memcpy(header.magic, expectedMagic, sizeof(magic));
+        header.version = currentVersion;
+        header.domainSize = sizeof(RamDomain);
+        header.arity = arity;
+        header.tuples = tuples;
+        header.symbols = symbols;
+        return header;
+    }
+
+    bool hasValidMagic() const {
+        return std::memcmp(magic, expectedMagic, sizeof(magic)) == 0;
+    }
+
+    /** Records and ADTs refer to the record table and cannot be stored */
+    static bool isSupportedType(char type) {
+        return type == 'i' || type == 'u' || type == 'f' || type == 's';
+    }
+
+    /** Size of the attribute type block following the header */
+    static std::size_t typesSize(std::size_t arity) {
+        return (arity + 7) / 8 * 8;
+    }
+
+    /** Offset of the first column from the start of the file */
+    static std::size_t columnsOffset(std::size_t arity) {
+        return sizeof(BinaryFactsHeader) + typesSize(arity);
+    }
+};
+
+static_assert(sizeof(BinaryFactsHeader) % 8 == 0, "columns must stay aligned");
+
+}  // namespace souffle
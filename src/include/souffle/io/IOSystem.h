@@ -18,9 +18,11 @@
 #include "souffle/RecordTable.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/io/ReadStream.h"
+#include "souffle/io/ReadStreamBinary.h"
 #include "souffle/io/ReadStreamCSV.h"
 #include "souffle/io/ReadStreamJSON.h"
 #include "souffle/io/WriteStream.h"
+#include "souffle/io/WriteStreamBinary.h"
 #include "souffle/io/WriteStreamCSV.h"
 #include "souffle/io/WriteStreamJSON.h"
 
@@ -86,6 +88,8 @@ private:
         registerWriteStreamFactory(std::make_shared<WriteCoutPrintSizeFactory>());
         registerWriteStreamFactory(std::make_shared<WriteFileJSONFactory>());
         registerWriteStreamFactory(std::make_shared<WriteCoutJSONFactory>());
+        registerReadStreamFactory(std::make_shared<ReadFileBinaryFactory>());
+        registerWriteStreamFactory(std::make_shared<WriteFileBinaryFactory>());
 #ifdef USE_SQLITE
         registerReadStreamFactory(std::make_shared<ReadSQLiteFactory>());
         registerWriteStreamFactory(std::make_shared<WriteSQLiteFactory>());
@@ -29,10 +29,25 @@
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace souffle {
 
+namespace detail {
+
+/** Detects relations that accept batches of tuples stored one after another. */
+template <typename T, typename = void>
+struct has_insert_batch : std::false_type {};
+
+template <typename T>
+struct has_insert_batch<T,
+        std::void_t<decltype(std::declval<T&>().insertBatch(std::declval<std::vector<RamDomain>&>()))>>
+        : std::true_type {};
+
+}  // namespace detail
+
 class ReadStream : public SerialisationStream<false> {
 protected:
     ReadStream(
@@ -42,6 +57,17 @@ protected:
 public:
     template <typename T>
     void readAll(T& relation) {
+        // tuples with auxiliary attributes have to pass the relation's updater one by one
+        if constexpr (detail::has_insert_batch<T>::value) {
+            if (arity > 0 && auxiliaryArity == 0) {
+                std::vector<RamDomain> batch;
+                while (readNextBatch(batch)) {
+                    relation.insertBatch(batch);
+                    batch.clear();
+                }
+                return;
+            }
+        }
         while (const auto next = readNextTuple()) {
             const RamDomain* ramDomain = next.get();
             relation.insert(ramDomain);
@@ -381,6 +407,26 @@ protected:
     }
 
     virtual Own<RamDomain[]> readNextTuple() = 0;
+
+    /**
+     * Read the next tuples and append them, one after another, to the given batch.
+     *
+     * Returns false if no tuple was readable.
+     */
+    virtual bool readNextBatch(std::vector<RamDomain>& batch) {
+        const std::size_t width = typeAttributes.size();
+        for (std::size_t i = 0; i < batchSize; ++i) {
+            const auto next = readNextTuple();
+            if (!next) {
+                break;
+            }
+            batch.insert(batch.end(), next.get(), next.get() + width);
+        }
+        return !batch.empty();
+    }
+
+    /** The number of tuples read as one batch */
+    static constexpr std::size_t batchSize = 1 << 16;
 };
 
 class ReadStreamFactory {
@@ -0,0 +1,229 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ReadStreamBinary.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
+#include "souffle/SymbolTable.h"
+#include "souffle/io/BinaryFormat.h"
+#include "souffle/io/ReadStream.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/FileUtil.h"
+#include "souffle/utility/MiscUtil.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Reads a relation from a binary columnar fact file (see BinaryFormat.h).
+ *
+ * The file is memory mapped where possible; its dictionary is interned once
+ * and tuples are copied straight out of the columns in batches.
+ */
+class ReadFileBinary : public ReadStream {
+public:
+    ReadFileBinary(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
+            RecordTable& recordTable)
+            : ReadStream(rwOperation, symbolTable, recordTable),
+              baseName(souffle::baseName(getFileName(rwOperation))), mapping(getFileName(rwOperation)) {
+        if (mapping.isMapped()) {
+            data = mapping.begin();
+            length = mapping.size();
+        } else {
+            std::ifstream file(getFileName(rwOperation), std::ios::in | std::ios::binary);
+            if (!file.is_open()) {
+                // suppress error message in case file cannot be open when flag -w is set
+                if (getOr(rwOperation, "no-warn", "false") != "true") {
+                    throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
+                }
+                return;
+            }
+            contents.assign(std::istreambuf_iterator<char>(file), {});
+            data = contents.data();
+            length = contents.size();
+        }
+        try {
+            readHeader();
+        } catch (std::exception& e) {
+            throw std::invalid_argument(std::string(e.what()) + "cannot parse fact file " + baseName + "!\n");
+        }
+    }
+
+    ~ReadFileBinary() override = default;
+
+protected:
+    Own<RamDomain[]> readNextTuple() override {
+        if (next >= tuples) {
+            return nullptr;
+        }
+        Own<RamDomain[]> tuple = mk<RamDomain[]>(typeAttributes.size());
+        copyTuples(tuple.get(), next, 1);
+        ++next;
+        return tuple;
+    }
+
+    bool readNextBatch(std::vector<RamDomain>& batch) override {
+        const std::size_t count = std::min<std::size_t>(batchSize, tuples - next);
+        if (count == 0) {
+            return false;
+        }
+        const std::size_t offset = batch.size();
+        batch.resize(offset + count * typeAttributes.size());
+        copyTuples(batch.data() + offset, next, count);
+        next += count;
+        return true;
+    }
+
+    /**
+     * Return given filename or construct from relation name.
+     * Default name is [configured path]/[relation name].bin
+     *
+     * @param rwOperation map of IO configuration options
+     * @return input filename
+     */
+    static std::string getFileName(const std::map<std::string, std::string>& rwOperation) {
+        auto name = getOr(rwOperation, "filename", rwOperation.at("name") + ".bin");
+        if (name.front() != '/') {
+            name = getOr(rwOperation, "fact-dir", ".") + "/" + name;
+        }
+        return name;
+    }
+
+    std::string baseName;
+    MappedFile mapping;
+    std::string contents;
+    const char* data = nullptr;
+    std::size_t length = 0;
+
+    /** Start of the attribute columns */
+    const char* columns = nullptr;
+    /** Symbol table ordinals of the file's dictionary entries */
+    std::vector<RamDomain> symbols;
+    std::size_t tuples = 0;
+    std::size_t next = 0;
+
+private:
+    void readHeader() {
+        for (const auto& type : typeAttributes) {
+            if (!BinaryFactsHeader::isSupportedType(type[0])) {
+                throw std::invalid_argument("Binary IO does not support record or ADT attributes\n");
+            }
+        }
+
+        BinaryFactsHeader header;
+        if (length < sizeof(header)) {
+            throw std::invalid_argument("Truncated header\n");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (!header.hasValidMagic()) {
+            throw std::invalid_argument("Not a binary fact file\n");
+        }
+        if (header.version != BinaryFactsHeader::currentVersion) {
+            throw std::invalid_argument("Unsupported version " + std::to_string(header.version) + "\n");
+        }
+        if (header.domainSize != sizeof(RamDomain)) {
+            throw std::invalid_argument("File was written with " + std::to_string(header.domainSize * 8) +
+                                        " bit domains\n");
+        }
+        if (header.arity != arity) {
+            throw std::invalid_argument("Expected arity " + std::to_string(arity) + ", got " +
+                                        std::to_string(header.arity) + "\n");
+        }
+
+        const std::size_t columnsOffset = BinaryFactsHeader::columnsOffset(arity);
+        if (length < columnsOffset ||
+                (arity > 0 && (length - columnsOffset) / (arity * sizeof(RamDomain)) < header.tuples)) {
+            throw std::invalid_argument("Truncated columns\n");
+        }
+        const std::size_t columnsSize = arity * header.tuples * sizeof(RamDomain);
+        for (std::size_t i = 0; i < arity; ++i) {
+            const char type = data[sizeof(header) + i];
+            if (type != typeAttributes[i][0]) {
+                throw std::invalid_argument("Type mismatch in column " + std::to_string(i + 1) + "\n");
+            }
+        }
+
+        // intern the dictionary once; columns are remapped while copying
+        const char* pos = data + columnsOffset + columnsSize;
+        const char* end = data + length;
+        symbols.reserve(header.symbols);
+        for (std::size_t i = 0; i < header.symbols; ++i) {
+            uint64_t size;
+            if (static_cast<std::size_t>(end - pos) < sizeof(size)) {
+                throw std::invalid_argument("Truncated symbol dictionary\n");
+            }
+            std::memcpy(&size, pos, sizeof(size));
+            pos += sizeof(size);
+            if (static_cast<std::size_t>(end - pos) < size) {
+                throw std::invalid_argument("Truncated symbol dictionary\n");
+            }
+            symbols.push_back(symbolTable.encode(std::string(pos, size)));
+            pos += size;
+        }
+
+        columns = data + columnsOffset;
+        // a nullary relation holds at most the empty tuple
+        tuples = arity > 0 ? header.tuples : std::min<std::size_t>(header.tuples, 1);
+    }
+
+    /** Copy count tuples starting at row first into consecutive tuples of the destination */
+    void copyTuples(RamDomain* destination, std::size_t first, std::size_t count) {
+        const std::size_t width = typeAttributes.size();
+        for (std::size_t i = 0; i < arity; ++i) {
+            const char* column = columns + (i * tuples + first) * sizeof(RamDomain);
+            const bool isSymbol = typeAttributes[i][0] == 's';
+            for (std::size_t row = 0; row < count; ++row) {
+                RamDomain value;
+                std::memcpy(&value, column + row * sizeof(RamDomain), sizeof(RamDomain));
+                if (isSymbol) {
+                    if (value < 0 || static_cast<std::size_t>(value) >= symbols.size()) {
+                        throw std::invalid_argument("Symbol index out of range in fact file " + baseName +
+                                                    "\n");
+                    }
+                    value = symbols[value];
+                }
+                destination[row * width + i] = value;
+            }
+        }
+    }
+};
+
+class ReadFileBinaryFactory : public ReadStreamFactory {
+public:
+    Own<ReadStream> getReader(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
+            RecordTable& recordTable) override {
+        return mk<ReadFileBinary>(rwOperation, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+
+    ~ReadFileBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
@@ -20,6 +20,7 @@
 #include "souffle/io/ReadStream.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/FileUtil.h"
+#include "souffle/utility/ParallelUtil.h"
 #include "souffle/utility/StringUtil.h"
 
 #ifdef USE_LIBZ
@@ -35,9 +36,12 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace souffle {
@@ -48,7 +52,10 @@ public:
             SymbolTable& symbolTable, RecordTable& recordTable)
             : ReadStream(rwOperation, symbolTable, recordTable),
               rfc4180(getOr(rwOperation, "rfc4180", "false") == std::string("true")),
-              delimiter(getOr(rwOperation, "delimiter", (rfc4180 ? "," : "\t"))), file(file), lineNumber(0),
+              delimiter(getOr(rwOperation, "delimiter", (rfc4180 ? "," : "\t"))),
+              chunkSize(std::max<std::size_t>(
+                      1, std::stoull(getOr(rwOperation, "chunkSize", std::to_string(defaultChunkSize))))),
+              file(file), lineNumber(0),
               inputMap(getInputColumnMap(rwOperation, static_cast<unsigned int>(arity))) {
         if (rfc4180 && delimiter.find('"') != std::string::npos) {
             std::stringstream errorMessage;
@@ -96,57 +103,68 @@ protected:
         std::size_t start = 0;
         std::size_t columnsFilled = 0;
         for (uint32_t column = 0; columnsFilled < arity; column++) {
-            std::size_t charactersRead = 0;
             std::string element = nextElement(line, start, wasCRLF);
             if (inputMap.count(column) == 0) {
                 continue;
             }
             ++columnsFilled;
 
-            try {
-                auto&& ty = typeAttributes.at(inputMap[column]);
-                switch (ty[0]) {
-                    case 's': {
-                        tuple[inputMap[column]] = symbolTable.encode(element);
-                        charactersRead = element.size();
-                        break;
-                    }
-                    case 'r': {
-                        tuple[inputMap[column]] = readRecord(element, ty, 0, &charactersRead);
-                        break;
-                    }
-                    case '+': {
-                        tuple[inputMap[column]] = readADT(element, ty, 0, &charactersRead);
-                        break;
-                    }
-                    case 'i': {
-                        tuple[inputMap[column]] = RamSignedFromString(element, &charactersRead);
-                        break;
-                    }
-                    case 'u': {
-                        tuple[inputMap[column]] = ramBitCast(readRamUnsigned(element, charactersRead));
-                        break;
-                    }
-                    case 'f': {
-                        tuple[inputMap[column]] = ramBitCast(RamFloatFromString(element, &charactersRead));
-                        break;
-                    }
-                    default: fatal("invalid type attribute: `%c`", ty[0]);
+            const std::size_t attribute = inputMap[column];
+            tuple[attribute] = readElement(element, column, attribute, lineNumber);
+        }
+
+        return tuple;
+    }
+
+    /**
+     * Convert the element read from the given column and line to a value of the given attribute.
+     */
+    RamDomain readElement(
+            const std::string& element, std::size_t column, std::size_t attribute, std::size_t line) {
+        try {
+            std::size_t charactersRead = 0;
+            RamDomain value = 0;
+            auto&& ty = typeAttributes.at(attribute);
+            switch (ty[0]) {
+                case 's': {
+                    value = symbolTable.encode(element);
+                    charactersRead = element.size();
+                    break;
                 }
-                // Check if everything was read.
-                if (charactersRead != element.size()) {
-                    throw std::invalid_argument(
-                            "Expected: " + delimiter + " or \\n. Got: " + element[charactersRead]);
+                case 'r': {
+                    value = readRecord(element, ty, 0, &charactersRead);
+                    break;
                 }
-            } catch (...) {
-                std::stringstream errorMessage;
-                errorMessage << "Error converting <" + element + "> in column " << column + 1 << " in line "
-                             << lineNumber << "; ";
-                throw std::invalid_argument(errorMessage.str());
+                case '+': {
+                    value = readADT(element, ty, 0, &charactersRead);
+                    break;
+                }
+                case 'i': {
+                    value = RamSignedFromString(element, &charactersRead);
+                    break;
+                }
+                case 'u': {
+                    value = ramBitCast(readRamUnsigned(element, charactersRead));
+                    break;
+                }
+                case 'f': {
+                    value = ramBitCast(RamFloatFromString(element, &charactersRead));
+                    break;
+                }
+                default: fatal("invalid type attribute: `%c`", ty[0]);
             }
+            // Check if everything was read.
+            if (charactersRead != element.size()) {
+                throw std::invalid_argument(
+                        "Expected: " + delimiter + " or \\n. Got: " + element[charactersRead]);
+            }
+            return value;
+        } catch (...) {
+            std::stringstream errorMessage;
+            errorMessage << "Error converting <" + element + "> in column " << column + 1 << " in line "
+                         << line << "; ";
+            throw std::invalid_argument(errorMessage.str());
         }
-
-        return tuple;
     }
 
     /**
@@ -249,6 +267,13 @@ protected:
             }
         }
 
+        return std::string(nextField(line, start, lineNumber));
+    }
+
+    /**
+     * Return the next element of a line that is not in RFC 4180 format, without copying it.
+     */
+    std::string_view nextField(std::string_view line, std::size_t& start, std::size_t lineNo) const {
         std::size_t end = start;
         // Handle record/tuple delimiter coincidence.
         if (delimiter.find(',') != std::string::npos) {
@@ -281,7 +306,7 @@ protected:
             // Handle the end-of-the-line case where parenthesis are unbalanced.
             if (record_parens != 0) {
                 std::stringstream errorMessage;
-                errorMessage << "Unbalanced record parenthesis in line " << lineNumber << "; ";
+                errorMessage << "Unbalanced record parenthesis in line " << lineNo << "; ";
                 throw std::invalid_argument(errorMessage.str());
             }
         } else {
@@ -291,11 +316,11 @@ protected:
         // Check for missing value.
         if (start > end) {
             std::stringstream errorMessage;
-            errorMessage << "Values missing in line " << lineNumber << "; ";
+            errorMessage << "Values missing in line " << lineNo << "; ";
             throw std::invalid_argument(errorMessage.str());
         }
 
-        element = line.substr(start, end - start);
+        std::string_view element = line.substr(start, end - start);
         start = end + delimiter.size();
 
         return element;
@@ -325,8 +350,159 @@ protected:
         return inputColumnMap;
     }
 
+    /**
+     * The tuples parsed from a chunk of the input, which spans whole lines.
+     */
+    struct ParsedChunk {
+        ParsedChunk(const char* begin, const char* end) : begin(begin), end(end) {}
+
+        const char* begin;
+        const char* end;
+        // the number of the line preceding the chunk
+        std::size_t firstLine = 0;
+        // the number of lines of the chunk
+        std::size_t numLines = 0;
+        // the tuples, one after another
+        std::vector<RamDomain> tuples;
+        // the elements of symbol, record and ADT columns, not yet converted
+        std::vector<std::string_view> deferred;
+        // the first error found in the chunk
+        std::optional<std::string> error;
+    };
+
+    /**
+     * Read the next lines of the given memory range as one batch.
+     *
+     * The range is split into chunks of whole lines whose numeric columns are parsed in
+     * parallel. Symbols, records and ADTs are converted afterwards chunk by chunk, such that
+     * they are encoded in the order of the input, as if the lines were read one by one.
+     */
+    bool readChunks(const char*& cursor, const char* end, std::vector<RamDomain>& batch) {
+        if (cursor >= end) {
+            return false;
+        }
+
+        // map columns to attributes; columns of deferred attributes are kept in column order
+        std::vector<int> columnAttributes;
+        std::vector<std::pair<std::size_t, std::size_t>> deferredColumns;
+        for (const auto& [column, attribute] : inputMap) {
+            if (column >= static_cast<int>(columnAttributes.size())) {
+                columnAttributes.resize(column + 1, -1);
+            }
+            columnAttributes[column] = attribute;
+            if (isDeferred(attribute)) {
+                deferredColumns.emplace_back(column, attribute);
+            }
+        }
+
+        // split the next part of the range into chunks ending with a line break
+        std::vector<ParsedChunk> chunks;
+        const std::size_t numChunks = 4 * static_cast<std::size_t>(MAX_THREADS);
+        while (chunks.size() < numChunks && cursor < end) {
+            const char* chunkEnd = cursor + std::min<std::size_t>(chunkSize, end - cursor);
+            chunkEnd = std::find(chunkEnd, end, '\n');
+            if (chunkEnd != end) {
+                ++chunkEnd;
+            }
+            chunks.emplace_back(cursor, chunkEnd);
+            cursor = chunkEnd;
+        }
+
+        // number the lines of each chunk; a last line without line break counts as well
+        PARALLEL_START
+            pfor(std::size_t i = 0; i < chunks.size(); ++i) {
+                auto& chunk = chunks[i];
+                chunk.numLines = std::count(chunk.begin, chunk.end, '\n') + (chunk.end[-1] != '\n' ? 1 : 0);
+            }
+        PARALLEL_END
+        for (auto& chunk : chunks) {
+            chunk.firstLine = lineNumber;
+            lineNumber += chunk.numLines;
+        }
+
+        PARALLEL_START
+            std::string element;
+            pfor(std::size_t i = 0; i < chunks.size(); ++i) {
+                parseChunk(chunks[i], columnAttributes, element);
+            }
+        PARALLEL_END
+
+        // convert deferred elements in input order and report the first error
+        const std::size_t width = typeAttributes.size();
+        std::string element;
+        for (auto& chunk : chunks) {
+            for (std::size_t i = 0; i < chunk.deferred.size(); ++i) {
+                const auto& [column, attribute] = deferredColumns[i % deferredColumns.size()];
+                const std::size_t tuple = i / deferredColumns.size();
+                element.assign(chunk.deferred[i]);
+                chunk.tuples[tuple * width + attribute] =
+                        readElement(element, column, attribute, chunk.firstLine + tuple + 1);
+            }
+            if (chunk.error) {
+                throw std::invalid_argument(*chunk.error);
+            }
+            batch.insert(batch.end(), chunk.tuples.begin(), chunk.tuples.end());
+        }
+        return true;
+    }
+
+    /**
+     * Parse the lines of a chunk into tuples, leaving deferred attributes to the caller.
+     *
+     * Only numeric attributes are converted, hence chunks can be parsed concurrently.
+     */
+    void parseChunk(ParsedChunk& chunk, const std::vector<int>& columnAttributes, std::string& element) {
+        const std::size_t width = typeAttributes.size();
+        std::size_t line = chunk.firstLine;
+        try {
+            for (const char* pos = chunk.begin; pos < chunk.end;) {
+                const char* eol = std::find(pos, chunk.end, '\n');
+                std::string_view text(pos, eol - pos);
+                pos = (eol == chunk.end) ? eol : eol + 1;
+                // Handle Windows line endings on non-Windows systems
+                if (!text.empty() && text.back() == '\r') {
+                    text.remove_suffix(1);
+                }
+                ++line;
+
+                chunk.tuples.resize(chunk.tuples.size() + width);
+                RamDomain* tuple = chunk.tuples.data() + chunk.tuples.size() - width;
+                std::size_t start = 0;
+                std::size_t columnsFilled = 0;
+                for (std::size_t column = 0; columnsFilled < arity; column++) {
+                    std::string_view field = nextField(text, start, line);
+                    const int attribute = column < columnAttributes.size() ? columnAttributes[column] : -1;
+                    if (attribute < 0) {
+                        continue;
+                    }
+                    ++columnsFilled;
+
+                    if (isDeferred(attribute)) {
+                        chunk.deferred.push_back(field);
+                    } else {
+                        element.assign(field);
+                        tuple[attribute] = readElement(element, column, attribute, line);
+                    }
+                }
+            }
+        } catch (std::exception& e) {
+            chunk.error = e.what();
+        }
+    }
+
+    /** Whether an attribute is converted using the symbol or record table */
+    bool isDeferred(std::size_t attribute) const {
+        const char ty = typeAttributes[attribute][0];
+        return ty == 's' || ty == 'r' || ty == '+';
+    }
+
+    /** The default number of bytes parsed as one chunk */
+    static constexpr std::size_t defaultChunkSize = 1 << 22;
+
     const bool rfc4180;
     const std::string delimiter;
+    /** The number of bytes parsed as one chunk, extended to the end of its last line */
+    const std::size_t chunkSize;
     std::istream& file;
     std::size_t lineNumber;
     std::map<int, int> inputMap;
@@ -345,11 +521,36 @@ public:
                 throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
             }
         }
+#ifdef USE_LIBZ
+        // decompress files of independent gzip members concurrently
+        fileHandle.rdbuf()->setThreads(MAX_THREADS);
+        if (fileHandle.is_open()) {
+            // report corrupt compressed data rather than ending the input
+            fileHandle.exceptions(std::ios::badbit);
+        }
+#endif
         // Strip headers if we're using them
-        if (getOr(rwOperation, "headers", "false") == "true") {
+        const bool headers = getOr(rwOperation, "headers", "false") == "true";
+        if (headers) {
             std::string line;
             getline(file, line);
         }
+
+        // Parse uncompressed files without quoted fields from a memory mapping
+        if (!rfc4180 && fileHandle.is_open()) {
+            mapping = mk<MappedFile>(getFileName(rwOperation));
+            const auto* data = reinterpret_cast<const unsigned char*>(mapping->begin());
+            const bool compressed = mapping->size() >= 2 && data[0] == 0x1f && data[1] == 0x8b;
+            if (!mapping->isMapped() || compressed) {
+                mapping.reset();
+            } else {
+                cursor = mapping->begin();
+                if (headers) {
+                    cursor = std::find(cursor, mapping->end(), '\n');
+                    cursor = std::min(cursor + 1, mapping->end());
+                }
+            }
+        }
     }
 
     /**
@@ -372,6 +573,20 @@ public:
     ~ReadFileCSV() override = default;
 
 protected:
+    bool readNextBatch(std::vector<RamDomain>& batch) override {
+        if (!mapping) {
+            return ReadStreamCSV::readNextBatch(batch);
+        }
+        try {
+            return readChunks(cursor, mapping->end(), batch);
+        } catch (std::exception& e) {
+            std::stringstream errorMessage;
+            errorMessage << e.what();
+            errorMessage << "cannot parse fact file " << baseName << "!\n";
+            throw std::invalid_argument(errorMessage.str());
+        }
+    }
+
     /**
      * Return given filename or construct from relation name.
      * Default name is [configured path]/[relation name].facts
@@ -388,6 +603,8 @@ protected:
     }
 
     std::string baseName;
+    Own<MappedFile> mapping;
+    const char* cursor = nullptr;
 #ifdef USE_LIBZ
     gzfstream::igzfstream fileHandle;
 #else
@@ -27,11 +27,24 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 namespace souffle {
 
 using json11::Json;
 
+namespace detail {
+
+/** Detects relations that can be split into ranges of tuples. */
+template <typename T, typename = void>
+struct has_partition : std::false_type {};
+
+template <typename T>
+struct has_partition<T, std::void_t<decltype(std::declval<const T&>().partition())>> : std::true_type {};
+
+}  // namespace detail
+
 class WriteStream : public SerialisationStream<true> {
 public:
     WriteStream(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
@@ -42,19 +55,27 @@ public:
     template <typename T>
     void writeAll(const T& relation) {
         if (summary) {
-            return writeSize(relation.size());
-        }
-        if (arity == 0) {
+            writeSize(relation.size());
+        } else if (arity == 0) {
             if (relation.begin() != relation.end()) {
                 writeNullary();
             }
-            return;
-        }
-        for (const auto& current : relation) {
-            writeNext(current);
+        } else if (formatsText()) {
+            writeAllText(relation);
+        } else {
+            for (const auto& current : relation) {
+                writeNext(current);
+            }
         }
+        close();
     }
 
+    /**
+     * Complete the output once all tuples have been written.
+     * Throws if the output could not be written completely.
+     */
+    virtual void close() {}
+
     template <typename T>
     void writeSize(const T& relation) {
         writeSize(relation.size());
@@ -69,6 +90,95 @@ protected:
         fatal("attempting to print size of a write operation");
     }
 
+    /** Size of the text buffers that are passed to writeText(). */
+    static constexpr std::size_t TextBufferSize = 1 << 20;
+
+    /** Return true if the writer formats tuples with formatNextTuple() and writes them with writeText(). */
+    virtual bool formatsText() const {
+        return false;
+    }
+
+    /**
+     * Append the text of a tuple to a buffer.
+     * May be called from concurrent threads.
+     */
+    virtual void formatNextTuple(std::string& /* buffer */, const RamDomain* /* tuple */) {
+        fatal("attempting to format a tuple as text");
+    }
+
+    /** Write formatted tuples to the output. */
+    virtual void writeText(const std::string& /* text */) {
+        fatal("attempting to write text");
+    }
+
+    /**
+     * Encode formatted tuples for writeEncodedText(), e.g. by compressing them.
+     * Return false if the text is to be written by writeText() instead.
+     * May be called from concurrent threads.
+     */
+    virtual bool encodeText(std::string& /* text */) {
+        return false;
+    }
+
+    /** Write tuples encoded by encodeText() to the output. */
+    virtual void writeEncodedText(const std::string& /* text */) {
+        fatal("attempting to write encoded text");
+    }
+
+    /**
+     * Format the tuples of a relation into text buffers and write them in order.
+     *
+     * Relations that can be partitioned are formatted and encoded by concurrent
+     * threads, one range at a time, and the ranges are written in the order of
+     * the relation.
+     */
+    template <typename T>
+    void writeAllText(const T& relation) {
+        if constexpr (detail::has_partition<T>::value) {
+            const auto chunks = relation.partition();
+            const std::ptrdiff_t chunkCount = chunks.size();
+#ifdef _OPENMP
+#pragma omp parallel for ordered schedule(dynamic)
+#endif
+            for (std::ptrdiff_t i = 0; i < chunkCount; ++i) {
+                std::string buffer;
+                for (const auto& current : chunks[i]) {
+                    formatNextTuple(buffer, tupleData(current));
+                }
+                const bool encoded = encodeText(buffer);
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+                if (encoded) {
+                    writeEncodedText(buffer);
+                } else {
+                    writeText(buffer);
+                }
+            }
+        } else {
+            std::string buffer;
+            buffer.reserve(TextBufferSize);
+            for (const auto& current : relation) {
+                formatNextTuple(buffer, tupleData(current));
+                if (buffer.size() >= TextBufferSize) {
+                    writeText(buffer);
+                    buffer.clear();
+                }
+            }
+            writeText(buffer);
+        }
+    }
+
+    template <typename Tuple>
+    static const RamDomain* tupleData(const Tuple& tuple) {
+        using tcb::make_span;
+        return make_span(tuple).data();
+    }
+
+    static const RamDomain* tupleData(const RamDomain* tuple) {
+        return tuple;
+    }
+
     template <typename Tuple>
     void writeNext(const Tuple tuple) {
         using tcb::make_span;
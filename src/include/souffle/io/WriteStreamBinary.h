@@ -0,0 +1,157 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteStreamBinary.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
+#include "souffle/SymbolTable.h"
+#include "souffle/io/BinaryFormat.h"
+#include "souffle/io/WriteStream.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/MiscUtil.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Writes a relation as a binary columnar fact file (see BinaryFormat.h).
+ *
+ * Tuples are collected column by column and the file is written by close(),
+ * once the relation has been fully streamed, together with the dictionary of
+ * the symbols it uses.
+ */
+class WriteFileBinary : public WriteStream {
+public:
+    WriteFileBinary(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
+            const RecordTable& recordTable)
+            : WriteStream(rwOperation, symbolTable, recordTable), fileName(getFileName(rwOperation)),
+              columns(arity) {
+        for (const auto& type : typeAttributes) {
+            if (!BinaryFactsHeader::isSupportedType(type[0])) {
+                throw std::invalid_argument("Binary IO does not support record or ADT attributes");
+            }
+        }
+        file.open(fileName, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::invalid_argument("Cannot open output file " + fileName);
+        }
+    }
+
+    ~WriteFileBinary() override = default;
+
+    /**
+     * Write the collected columns and the dictionary to the file.
+     * Throws if the file could not be written completely, e.g., since the disk is full.
+     */
+    void close() override {
+        if (!file.is_open()) {
+            return;
+        }
+
+        const std::size_t tuples = arity > 0 ? columns[0].size() : (isNullary ? 1 : 0);
+        const auto header = BinaryFactsHeader::create(arity, tuples, dictionary.size());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::string types(BinaryFactsHeader::typesSize(arity), '\0');
+        for (std::size_t i = 0; i < arity; ++i) {
+            types[i] = typeAttributes[i][0];
+        }
+        file.write(types.data(), types.size());
+
+        for (const auto& column : columns) {
+            file.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(RamDomain));
+        }
+
+        for (RamDomain symbol : dictionary) {
+            const std::string& value = symbolTable.decode(symbol);
+            const uint64_t size = value.size();
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            file.write(value.data(), value.size());
+        }
+        file.close();
+        if (file.fail()) {
+            throw std::invalid_argument("Cannot write output file " + fileName);
+        }
+    }
+
+protected:
+    void writeNullary() override {
+        isNullary = true;
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        for (std::size_t i = 0; i < arity; ++i) {
+            RamDomain value = tuple[i];
+            if (typeAttributes[i][0] == 's') {
+                auto [pos, isNew] = localSymbols.try_emplace(value, dictionary.size());
+                if (isNew) {
+                    dictionary.push_back(value);
+                }
+                value = pos->second;
+            }
+            columns[i].push_back(value);
+        }
+    }
+
+    /**
+     * Return given filename or construct from relation name.
+     * Default name is [configured path]/[relation name].bin
+     *
+     * @param rwOperation map of IO configuration options
+     * @return output filename
+     */
+    static std::string getFileName(const std::map<std::string, std::string>& rwOperation) {
+        auto name = getOr(rwOperation, "filename", rwOperation.at("name") + ".bin");
+        if (name.front() != '/') {
+            name = getOr(rwOperation, "output-dir", ".") + "/" + name;
+        }
+        return name;
+    }
+
+    const std::string fileName;
+    std::ofstream file;
+    std::vector<std::vector<RamDomain>> columns;
+    bool isNullary = false;
+
+    /** Symbol table ordinals in order of first use */
+    std::vector<RamDomain> dictionary;
+    /** Maps symbol table ordinals to dictionary indices */
+    std::unordered_map<RamDomain, RamDomain> localSymbols;
+};
+
+class WriteFileBinaryFactory : public WriteStreamFactory {
+public:
+    Own<WriteStream> getWriter(const std::map<std::string, std::string>& rwOperation,
+            const SymbolTable& symbolTable, const RecordTable& recordTable) override {
+        return mk<WriteFileBinary>(rwOperation, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+
+    ~WriteFileBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
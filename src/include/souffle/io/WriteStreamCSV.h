@@ -25,12 +25,16 @@
 #include "souffle/io/gzfstream.h"
 #endif
 
+#include <charconv>
 #include <cstddef>
+#include <cstdio>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <ostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -48,21 +52,51 @@ protected:
             errorMessage << "CSV delimiter cannot contain '\"' character when rfc4180 is enabled.";
             throw std::invalid_argument(errorMessage.str());
         }
+        for (std::size_t col = 0; col < arity; ++col) {
+            columns.push_back(columnKind(typeAttributes.at(col)));
+        }
     };
 
+    /** The formatting of a column, chosen once from its type attribute. */
+    enum class ColumnKind { Signed, Unsigned, Float, Symbol, Record, ADT };
+
     const bool rfc4180;
 
     const std::string delimiter;
 
-    void writeNextTupleCSV(std::ostream& destination, const RamDomain* tuple) {
-        writeNextTupleElement(destination, typeAttributes.at(0), tuple[0]);
+    std::vector<ColumnKind> columns;
+
+    static ColumnKind columnKind(const std::string& type) {
+        switch (type[0]) {
+            case 'i': return ColumnKind::Signed;
+            case 'u': return ColumnKind::Unsigned;
+            case 'f': return ColumnKind::Float;
+            case 's': return ColumnKind::Symbol;
+            case 'r': return ColumnKind::Record;
+            case '+': return ColumnKind::ADT;
+            default: fatal("unsupported type attribute: `%c`", type[0]);
+        }
+    }
+
+    bool formatsText() const override {
+        return true;
+    }
+
+    void formatNextTuple(std::string& buffer, const RamDomain* tuple) override {
+        formatNextTupleElement(buffer, 0, tuple[0]);
 
         for (std::size_t col = 1; col < arity; ++col) {
-            destination << delimiter;
-            writeNextTupleElement(destination, typeAttributes.at(col), tuple[col]);
+            buffer += delimiter;
+            formatNextTupleElement(buffer, col, tuple[col]);
         }
 
-        destination << "\n";
+        buffer += '\n';
+    }
+
+    void writeNextTupleCSV(std::ostream& destination, const RamDomain* tuple) {
+        std::string text;
+        formatNextTuple(text, tuple);
+        destination << text;
     }
 
     virtual void outputSymbol(std::ostream& destination, const std::string& value) {
@@ -95,31 +129,64 @@ protected:
         }
     }
 
-    void writeNextTupleElement(std::ostream& destination, const std::string& type, RamDomain value) {
-        switch (type[0]) {
-            case 's': outputSymbol(destination, symbolTable.decode(value), true); break;
-            case 'i': destination << value; break;
-            case 'u': destination << ramBitCast<RamUnsigned>(value); break;
-            case 'f': destination << ramBitCast<RamFloat>(value); break;
-            case 'r':
-                if (rfc4180) {
-                    destination << '"';
-                }
-                outputRecord(destination, value, type);
+    void formatSymbol(std::string& buffer, const std::string& value) {
+        if (!rfc4180) {
+            buffer += value;
+            return;
+        }
+        buffer += '"';
+        for (const char ch : value) {
+            if (ch == '"') {
+                buffer += "\\\"";
+            }
+            buffer += ch;
+        }
+        buffer += '"';
+    }
+
+    template <typename T>
+    static void formatNumber(std::string& buffer, const T value) {
+        char text[64];
+        std::to_chars_result res;
+        if constexpr (std::is_floating_point_v<T>) {
+            // same digits as an output stream with a precision of max_digits10
+            constexpr int precision = std::numeric_limits<T>::max_digits10;
+#ifdef __cpp_lib_to_chars
+            res = std::to_chars(text, text + sizeof(text), value, std::chars_format::general, precision);
+#else
+            const int length = std::snprintf(text, sizeof(text), "%.*g", precision, value);
+            res.ptr = text + length;
+#endif
+        } else {
+            res = std::to_chars(text, text + sizeof(text), value);
+        }
+        buffer.append(text, res.ptr);
+    }
+
+    void formatNextTupleElement(std::string& buffer, const std::size_t col, const RamDomain value) {
+        switch (columns[col]) {
+            case ColumnKind::Signed: formatNumber(buffer, value); break;
+            case ColumnKind::Unsigned: formatNumber(buffer, ramBitCast<RamUnsigned>(value)); break;
+            case ColumnKind::Float: formatNumber(buffer, ramBitCast<RamFloat>(value)); break;
+            case ColumnKind::Symbol: formatSymbol(buffer, symbolTable.decode(value)); break;
+            case ColumnKind::Record:
+            case ColumnKind::ADT: {
+                std::ostringstream destination;
+                destination << std::setprecision(std::numeric_limits<RamFloat>::max_digits10);
                 if (rfc4180) {
                     destination << '"';
                 }
-                break;
-            case '+':
-                if (rfc4180) {
-                    destination << '"';
+                if (columns[col] == ColumnKind::Record) {
+                    outputRecord(destination, value, typeAttributes[col]);
+                } else {
+                    outputADT(destination, value, typeAttributes[col]);
                 }
-                outputADT(destination, value, type);
                 if (rfc4180) {
                     destination << '"';
                 }
+                buffer += destination.str();
                 break;
-            default: fatal("unsupported type attribute: `%c`", type[0]);
+            }
         }
     }
 };
@@ -149,6 +216,10 @@ protected:
         writeNextTupleCSV(file, tuple);
     }
 
+    void writeText(const std::string& text) override {
+        file.write(text.data(), text.size());
+    }
+
     /**
      * Return given filename or construct from relation name.
      * Default name is [configured path]/[relation name].csv
@@ -171,7 +242,9 @@ public:
     WriteGZipFileCSV(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
             const RecordTable& recordTable)
             : WriteStreamCSV(rwOperation, symbolTable, recordTable),
-              file(getFileName(rwOperation), std::ios::out | std::ios::binary) {
+              file(getFileName(rwOperation), std::ios::out | std::ios::binary, getLevel(rwOperation)) {
+        // compress independent gzip members concurrently
+        file.rdbuf()->setThreads(MAX_THREADS);
         if (getOr(rwOperation, "headers", "false") == "true") {
             file << rwOperation.at("attributeNames") << std::endl;
         }
@@ -189,6 +262,26 @@ protected:
         writeNextTupleCSV(file, tuple);
     }
 
+    void writeText(const std::string& text) override {
+        file.write(text.data(), text.size());
+    }
+
+    /** Compress the text in the formatting thread, leaving only the writing of its members in order. */
+    bool encodeText(std::string& text) override {
+        std::string members;
+        if (!file.rdbuf()->compressMembers(text, members)) {
+            return false;
+        }
+        text.swap(members);
+        return true;
+    }
+
+    void writeEncodedText(const std::string& text) override {
+        if (!file.rdbuf()->writeMembers(text)) {
+            file.setstate(std::ios::badbit);
+        }
+    }
+
     /**
      * Return given filename or construct from relation name.
      * Default name is [configured path]/[relation name].csv
@@ -204,6 +297,24 @@ protected:
         return name;
     }
 
+    /**
+     * Return the compression level, from 0 (no compression) to 9 (best compression).
+     * Default level is zlib's default.
+     *
+     * @param rwOperation map of IO configuration options
+     * @return compression level
+     */
+    static int getLevel(const std::map<std::string, std::string>& rwOperation) {
+        const std::string level = getOr(rwOperation, "compress_level", "");
+        if (level.empty()) {
+            return Z_DEFAULT_COMPRESSION;
+        }
+        if (level.size() != 1 || level[0] < '0' || level[0] > '9') {
+            throw std::invalid_argument("Compression level must be between 0 and 9, found `" + level + "`.");
+        }
+        return level[0] - '0';
+    }
+
     gzfstream::ogzfstream file;
 };
 #endif
@@ -233,6 +344,10 @@ protected:
     void writeNextTuple(const RamDomain* tuple) override {
         writeNextTupleCSV(std::cout, tuple);
     }
+
+    void writeText(const std::string& text) override {
+        std::cout.write(text.data(), text.size());
+    }
 };
 
 class WriteCoutPrintSize : public WriteStream {
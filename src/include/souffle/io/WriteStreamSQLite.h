@@ -18,70 +18,113 @@
 #include "souffle/RecordTable.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/io/WriteStream.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <sqlite3.h>
 
 namespace souffle {
 
+/**
+ * Writes a relation to an SQLite database.
+ *
+ * By default the relation is stored in a table of numbers, '_<name>', with symbols replaced by the ids of a
+ * shared symbol table, and a view '<name>' resolves the symbols. With `flat=true` the relation is instead
+ * stored directly in a table '<name>' with typed columns and symbols stored as text.
+ *
+ * Tuples are inserted several rows per statement, and indexes on the table are dropped during the load and
+ * created again afterwards. The load is a single transaction, committed by close(); a writer destroyed
+ * before rolls it back.
+ */
 class WriteStreamSQLite : public WriteStream {
 public:
     WriteStreamSQLite(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
             const RecordTable& recordTable)
             : WriteStream(rwOperation, symbolTable, recordTable), dbFilename(getFileName(rwOperation)),
-              relationName(rwOperation.at("name")) {
+              relationName(rwOperation.at("name")),
+              flat(getOr(rwOperation, "flat", "false") == "true"),
+              tableName(flat ? relationName : "_" + relationName) {
         openDB();
+        executeSQL("BEGIN TRANSACTION", db);
         createTables();
+        dropIndexes();
         prepareStatements();
-        executeSQL("BEGIN TRANSACTION", db);
     }
 
     ~WriteStreamSQLite() override {
-        executeSQL("COMMIT", db);
+        if (!committed) {
+            // a load that did not reach close() leaves the database as it was
+            sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
         sqlite3_finalize(insertStatement);
         sqlite3_finalize(symbolInsertStatement);
         sqlite3_finalize(symbolSelectStatement);
         sqlite3_close(db);
     }
 
+    /**
+     * Insert the remaining rows, create the indexes again and commit the load.
+     * Throws if the relation could not be stored completely.
+     */
+    void close() override {
+        if (committed) {
+            return;
+        }
+        insertRows();
+        createIndexes();
+        executeSQL("COMMIT", db);
+        committed = true;
+        if (symbolCache) {
+            // the ids of new symbols only hold for other writers once they are committed
+            for (auto& [symbol, id] : newSymbolIds) {
+                symbolCache->ids.emplace(std::move(symbol), id);
+            }
+            newSymbolIds.clear();
+            syncSymbolCache();
+        }
+    }
+
 protected:
     void writeNullary() override {}
 
     void writeNextTuple(const RamDomain* tuple) override {
         for (std::size_t i = 0; i < arity; i++) {
-            RamDomain value = 0;  // Silence warning
-
-            switch (typeAttributes.at(i)[0]) {
-                case 's': value = getSymbolTableID(tuple[i]); break;
-                default: value = tuple[i]; break;
-            }
-
-#if RAM_DOMAIN_SIZE == 64
-            if (sqlite3_bind_int64(insertStatement, static_cast<int>(i + 1),
-                        static_cast<sqlite3_int64>(value)) != SQLITE_OK) {
-#else
-            if (sqlite3_bind_int(insertStatement, static_cast<int>(i + 1), static_cast<int>(value)) !=
-                    SQLITE_OK) {
-#endif
-                throwError("SQLite error in sqlite3_bind_text: ");
+            if (!flat && typeAttributes.at(i)[0] == 's') {
+                rows.push_back(static_cast<RamDomain>(getSymbolTableID(tuple[i])));
+            } else {
+                rows.push_back(tuple[i]);
             }
         }
-        if (sqlite3_step(insertStatement) != SQLITE_DONE) {
-            throwError("SQLite error in sqlite3_step: ");
+        if (rows.size() == rowsPerInsert * arity) {
+            insertRows();
         }
-        sqlite3_clear_bindings(insertStatement);
-        sqlite3_reset(insertStatement);
     }
 
 private:
+    /** Maximum number of rows inserted by a single statement */
+    static constexpr std::size_t MaxInsertRows = 256;
+
+    /**
+     * Ids of the symbols in the symbol table of a database, kept across the writers of a program.
+     *
+     * The cache is only used while the last symbol of the database is still the one it recorded.
+     */
+    struct SymbolCache {
+        std::unordered_map<std::string, uint64_t> ids;
+        sqlite3_int64 lastId = 0;
+        std::string lastSymbol;
+    };
+
     void executeSQL(const std::string& sql, sqlite3* db) {
         assert(db && "Database connection is closed");
 
@@ -104,9 +147,69 @@ private:
         throw std::invalid_argument(error.str());
     }
 
-    uint64_t getSymbolTableIDFromDB(std::size_t index) {
-        if (sqlite3_bind_text(symbolSelectStatement, 1, symbolTable.decode(index).c_str(), -1,
-                    SQLITE_TRANSIENT) != SQLITE_OK) {
+    sqlite3_stmt* prepare(const std::string& sql) {
+        sqlite3_stmt* statement = nullptr;
+        const char* tail = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, &tail) != SQLITE_OK) {
+            throwError("SQLite error in sqlite3_prepare_v2: ");
+        }
+        return statement;
+    }
+
+    void bindValue(sqlite3_stmt* statement, int column, std::size_t attribute, RamDomain value) {
+        int rc;
+        switch (flat ? typeAttributes.at(attribute)[0] : 'i') {
+            case 's': {
+                const std::string& symbol = symbolTable.decode(value);
+                rc = sqlite3_bind_text(
+                        statement, column, symbol.c_str(), static_cast<int>(symbol.size()), SQLITE_STATIC);
+                break;
+            }
+            case 'f': rc = sqlite3_bind_double(statement, column, ramBitCast<RamFloat>(value)); break;
+            case 'u':
+                rc = sqlite3_bind_int64(
+                        statement, column, static_cast<sqlite3_int64>(ramBitCast<RamUnsigned>(value)));
+                break;
+#if RAM_DOMAIN_SIZE == 64
+            default: rc = sqlite3_bind_int64(statement, column, static_cast<sqlite3_int64>(value)); break;
+#else
+            default: rc = sqlite3_bind_int(statement, column, static_cast<int>(value)); break;
+#endif
+        }
+        if (rc != SQLITE_OK) {
+            throwError("SQLite error in sqlite3_bind: ");
+        }
+    }
+
+    /** Insert the buffered rows */
+    void insertRows() {
+        const std::size_t count = arity == 0 ? 0 : rows.size() / arity;
+        if (count == 0) {
+            return;
+        }
+        // the last rows of the relation fill a statement of their own
+        sqlite3_stmt* statement = insertStatement;
+        if (count != rowsPerInsert) {
+            statement = prepare(getInsertSQL(count));
+        }
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            bindValue(statement, static_cast<int>(i + 1), i % arity, rows[i]);
+        }
+        const bool done = sqlite3_step(statement) == SQLITE_DONE;
+        if (statement == insertStatement) {
+            sqlite3_reset(statement);
+        } else {
+            sqlite3_finalize(statement);
+        }
+        if (!done) {
+            throwError("SQLite error in sqlite3_step: ");
+        }
+        rows.clear();
+    }
+
+    uint64_t getSymbolTableIDFromDB(const std::string& symbol) {
+        if (sqlite3_bind_text(symbolSelectStatement, 1, symbol.c_str(), static_cast<int>(symbol.size()),
+                    SQLITE_STATIC) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_bind_text: ");
         }
         if (sqlite3_step(symbolSelectStatement) != SQLITE_ROW) {
@@ -117,28 +220,78 @@ private:
         sqlite3_reset(symbolSelectStatement);
         return rowid;
     }
-    uint64_t getSymbolTableID(std::size_t index) {
-        if (dbSymbolTable.count(index) != 0) {
-            return dbSymbolTable[index];
+
+    uint64_t getSymbolTableID(RamDomain index) {
+        auto known = dbSymbolTable.find(index);
+        if (known != dbSymbolTable.end()) {
+            return known->second;
+        }
+
+        const std::string& symbol = symbolTable.decode(index);
+        auto cached = symbolCache->ids.find(symbol);
+        if (cached != symbolCache->ids.end()) {
+            return dbSymbolTable[index] = cached->second;
         }
 
-        if (sqlite3_bind_text(symbolInsertStatement, 1, symbolTable.decode(index).c_str(), -1,
-                    SQLITE_TRANSIENT) != SQLITE_OK) {
+        if (sqlite3_bind_text(symbolInsertStatement, 1, symbol.c_str(), static_cast<int>(symbol.size()),
+                    SQLITE_STATIC) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_bind_text: ");
         }
+        if (sqlite3_step(symbolInsertStatement) != SQLITE_DONE) {
+            throwError("SQLite error in sqlite3_step: ");
+        }
+        sqlite3_clear_bindings(symbolInsertStatement);
+        sqlite3_reset(symbolInsertStatement);
         // Either the insert succeeds and we have a new row id or it already exists and a select is needed.
         uint64_t rowid;
-        if (sqlite3_step(symbolInsertStatement) != SQLITE_DONE) {
-            // The symbol already exists so select it.
-            rowid = getSymbolTableIDFromDB(index);
+        if (sqlite3_changes(db) == 0) {
+            rowid = getSymbolTableIDFromDB(symbol);
         } else {
             rowid = sqlite3_last_insert_rowid(db);
         }
-        sqlite3_clear_bindings(symbolInsertStatement);
-        sqlite3_reset(symbolInsertStatement);
 
-        dbSymbolTable[index] = rowid;
-        return rowid;
+        newSymbolIds.emplace_back(symbol, rowid);
+        return dbSymbolTable[index] = rowid;
+    }
+
+    /** Return the cache of symbol ids for the database, or a new one if the database has changed. */
+    static std::shared_ptr<SymbolCache> getSymbolCache(
+            const std::string& filename, sqlite3_int64 lastId, const std::string& lastSymbol) {
+        static std::mutex lock;
+        static std::map<std::string, std::shared_ptr<SymbolCache>> caches;
+        std::lock_guard<std::mutex> guard(lock);
+        auto& cache = caches[filename];
+        if (!cache || cache->lastId != lastId || cache->lastSymbol != lastSymbol) {
+            cache = std::make_shared<SymbolCache>();
+            cache->lastId = lastId;
+            cache->lastSymbol = lastSymbol;
+        }
+        return cache;
+    }
+
+    /** Read the last symbol of the database symbol table. */
+    std::pair<sqlite3_int64, std::string> getLastSymbol() {
+        sqlite3_stmt* statement =
+                prepare("SELECT id, symbol FROM '" + symbolTableName + "' ORDER BY id DESC LIMIT 1;");
+        std::pair<sqlite3_int64, std::string> last{0, ""};
+        int rc = sqlite3_step(statement);
+        if (rc == SQLITE_ROW) {
+            last.first = sqlite3_column_int64(statement, 0);
+            if (const unsigned char* text = sqlite3_column_text(statement, 1)) {
+                last.second = reinterpret_cast<const char*>(text);
+            }
+        }
+        sqlite3_finalize(statement);
+        if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+            throwError("SQLite error in sqlite3_step: ");
+        }
+        return last;
+    }
+
+    void syncSymbolCache() {
+        auto last = getLastSymbol();
+        symbolCache->lastId = last.first;
+        symbolCache->lastSymbol = std::move(last.second);
     }
 
     void openDB() {
@@ -153,69 +306,141 @@ private:
 
     void prepareStatements() {
         prepareInsertStatement();
-        prepareSymbolInsertStatement();
-        prepareSymbolSelectStatement();
+        if (!flat) {
+            prepareSymbolInsertStatement();
+            prepareSymbolSelectStatement();
+            auto last = getLastSymbol();
+            symbolCache = getSymbolCache(dbFilename, last.first, last.second);
+        }
     }
     void prepareSymbolInsertStatement() {
         std::stringstream insertSQL;
-        insertSQL << "INSERT INTO " << symbolTableName;
+        insertSQL << "INSERT OR IGNORE INTO " << symbolTableName;
         insertSQL << " VALUES(null,@V0);";
-        const char* tail = nullptr;
-        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &symbolInsertStatement, &tail) != SQLITE_OK) {
-            throwError("SQLite error in sqlite3_prepare_v2: ");
-        }
+        symbolInsertStatement = prepare(insertSQL.str());
     }
 
     void prepareSymbolSelectStatement() {
         std::stringstream selectSQL;
         selectSQL << "SELECT id FROM " << symbolTableName;
         selectSQL << " WHERE symbol = @V0;";
-        const char* tail = nullptr;
-        if (sqlite3_prepare_v2(db, selectSQL.str().c_str(), -1, &symbolSelectStatement, &tail) != SQLITE_OK) {
-            throwError("SQLite error in sqlite3_prepare_v2: ");
+        symbolSelectStatement = prepare(selectSQL.str());
+    }
+
+    std::string getInsertSQL(std::size_t count) {
+        std::stringstream insertSQL;
+        insertSQL << "INSERT INTO '" << tableName << "' VALUES ";
+        for (std::size_t row = 0; row < count; row++) {
+            insertSQL << (row == 0 ? "(?" : ",(?");
+            for (unsigned int i = 1; i < arity; i++) {
+                insertSQL << ",?";
+            }
+            insertSQL << ")";
         }
+        insertSQL << ";";
+        return insertSQL.str();
     }
 
     void prepareInsertStatement() {
-        std::stringstream insertSQL;
-        insertSQL << "INSERT INTO '_" << relationName << "' VALUES ";
-        insertSQL << "(@V0";
-        for (unsigned int i = 1; i < arity; i++) {
-            insertSQL << ",@V" << i;
+        // rows per statement are bounded by the number of parameters a statement may have
+        const auto parameters = static_cast<std::size_t>(sqlite3_limit(db, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+        if (arity > 0) {
+            rowsPerInsert = std::max<std::size_t>(1, std::min(MaxInsertRows, parameters / arity));
         }
-        insertSQL << ");";
-        const char* tail = nullptr;
-        if (sqlite3_prepare_v2(db, insertSQL.str().c_str(), -1, &insertStatement, &tail) != SQLITE_OK) {
-            throwError("SQLite error in sqlite3_prepare_v2: ");
+        rows.reserve(rowsPerInsert * arity);
+        insertStatement = prepare(getInsertSQL(rowsPerInsert));
+    }
+
+    /** Return the type of the named table or view, or an empty string if there is none. */
+    std::string getObjectType(const std::string& name) {
+        sqlite3_stmt* statement = prepare("SELECT type FROM sqlite_master WHERE name = ?;");
+        if (sqlite3_bind_text(statement, 1, name.c_str(), static_cast<int>(name.size()), SQLITE_STATIC) !=
+                SQLITE_OK) {
+            sqlite3_finalize(statement);
+            throwError("SQLite error in sqlite3_bind_text: ");
+        }
+        std::string type;
+        if (sqlite3_step(statement) == SQLITE_ROW) {
+            type = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
         }
+        sqlite3_finalize(statement);
+        return type;
     }
 
     void createTables() {
+        // the relation replaces what an earlier write in the other layout left under its name
+        const std::string type = getObjectType(relationName);
+        if (flat && type == "view") {
+            executeSQL("DROP VIEW '" + relationName + "';", db);
+        } else if (!flat && type == "table") {
+            executeSQL("DROP TABLE '" + relationName + "';", db);
+        }
         createRelationTable();
-        createRelationView();
-        createSymbolTable();
+        if (!flat) {
+            createRelationView();
+            createSymbolTable();
+        }
+    }
+
+    /** Drop the indexes on the relation table, to be created again once the tuples are inserted. */
+    void dropIndexes() {
+        sqlite3_stmt* statement = prepare(
+                "SELECT name, sql FROM sqlite_master WHERE type = 'index' AND tbl_name = ? AND sql IS NOT "
+                "NULL;");
+        if (sqlite3_bind_text(statement, 1, tableName.c_str(), static_cast<int>(tableName.size()),
+                    SQLITE_STATIC) != SQLITE_OK) {
+            sqlite3_finalize(statement);
+            throwError("SQLite error in sqlite3_bind_text: ");
+        }
+        std::vector<std::string> names;
+        while (sqlite3_step(statement) == SQLITE_ROW) {
+            names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+            indexes.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(statement, 1)));
+        }
+        sqlite3_finalize(statement);
+        for (const auto& name : names) {
+            executeSQL("DROP INDEX \"" + name + "\";", db);
+        }
+    }
+
+    void createIndexes() {
+        for (const auto& index : indexes) {
+            executeSQL(index, db);
+        }
+    }
+
+    /** Return the column name of an attribute, given by the relation declaration if possible. */
+    std::string getColumnName(std::size_t i) {
+        const auto& columnName = params["relation"]["params"][i];
+        return columnName.is_string() ? columnName.string_value() : std::to_string(i);
     }
 
     void createRelationTable() {
         std::stringstream createTableText;
-        createTableText << "CREATE TABLE IF NOT EXISTS '_" << relationName << "' (";
-        if (arity > 0) {
-            createTableText << "'0' INTEGER";
-            for (unsigned int i = 1; i < arity; i++) {
-                createTableText << ",'" << std::to_string(i) << "' ";
-                createTableText << "INTEGER";
+        createTableText << "CREATE TABLE IF NOT EXISTS '" << tableName << "' (";
+        for (unsigned int i = 0; i < arity; i++) {
+            if (i != 0) {
+                createTableText << ",";
+            }
+            if (!flat) {
+                createTableText << "'" << i << "' INTEGER";
+                continue;
+            }
+            createTableText << "'" << getColumnName(i) << "' ";
+            switch (typeAttributes.at(i)[0]) {
+                case 's': createTableText << "TEXT"; break;
+                case 'f': createTableText << "REAL"; break;
+                default: createTableText << "INTEGER"; break;
             }
         }
         createTableText << ");";
         executeSQL(createTableText.str(), db);
-        executeSQL("DELETE FROM '_" + relationName + "';", db);
+        executeSQL("DELETE FROM '" + tableName + "';", db);
     }
 
     void createRelationView() {
         // Create view with symbol strings resolved
 
-        const auto columnNames = params["relation"]["params"].array_items();
-
         std::stringstream createViewText;
         createViewText << "CREATE VIEW IF NOT EXISTS '" << relationName << "' AS ";
         std::stringstream projectionClause;
@@ -225,8 +450,7 @@ private:
         bool firstWhere = true;
         for (unsigned int i = 0; i < arity; i++) {
             const std::string tableColumnName = std::to_string(i);
-            const auto& viewColumnName =
-                    (columnNames[i].is_string() ? columnNames[i].string_value() : tableColumnName);
+            const std::string viewColumnName = getColumnName(i);
             if (i != 0) {
                 projectionClause << ",";
             }
@@ -285,9 +509,18 @@ private:
 
     const std::string dbFilename;
     const std::string relationName;
+    const bool flat;
+    const std::string tableName;
     const std::string symbolTableName = "__SymbolTable";
 
     std::unordered_map<uint64_t, uint64_t> dbSymbolTable;
+    std::shared_ptr<SymbolCache> symbolCache;
+    /** Symbols inserted by this writer, added to the cache once committed */
+    std::vector<std::pair<std::string, uint64_t>> newSymbolIds;
+    bool committed = false;
+    std::vector<std::string> indexes;
+    std::vector<RamDomain> rows;
+    std::size_t rowsPerInsert = 1;
     sqlite3_stmt* insertStatement = nullptr;
     sqlite3_stmt* symbolInsertStatement = nullptr;
     sqlite3_stmt* symbolSelectStatement = nullptr;
@@ -11,14 +11,28 @@
  * @file gzfstream.h
  * A simple zlib wrapper to provide gzip file streams.
  *
+ * Files are written as a sequence of independent gzip members, pigz-style,
+ * which are compressed concurrently and remain readable by gunzip. Each
+ * member records its compressed size in an extra field of its header, so
+ * that files written this way are also decompressed concurrently. Members
+ * of other writers, e.g. of gzip files appended to such a file, are
+ * decompressed one after the other; corrupt data is reported by exceptions.
+ *
  ***********************************************************************/
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <zlib.h>
 
 namespace souffle {
@@ -27,6 +41,118 @@ namespace gzfstream {
 
 namespace internal {
 
+/**
+ * Gzip members of bounded size that carry their compressed size.
+ *
+ * The header of a member has the FEXTRA flag and a single extra subfield
+ * `SF` holding the size of the whole member as a 32-bit little-endian
+ * integer, similar to the BGZF format.
+ */
+namespace member {
+
+/** Number of uncompressed bytes per member. */
+constexpr std::size_t BlockSize = 1 << 20;
+
+/** Size of a member header: fixed fields, XLEN, and the SF subfield. */
+constexpr std::size_t HeaderSize = 20;
+
+/** Position of the member size within the header. */
+constexpr std::size_t SizeOffset = 16;
+
+/** Compress a block into a gzip member; return false on failure. */
+inline bool compress(const std::string& block, std::string& out, const int level) {
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    unsigned char extra[] = {'S', 'F', 4, 0, 0, 0, 0, 0};
+    gz_header header{};
+    header.extra = extra;
+    header.extra_len = sizeof(extra);
+    header.os = 255;
+    deflateSetHeader(&stream, &header);
+
+    out.resize(deflateBound(&stream, static_cast<uLong>(block.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data()));
+    stream.avail_in = static_cast<uInt>(block.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    const int res = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (res != Z_STREAM_END) {
+        return false;
+    }
+    out.resize(stream.total_out);
+
+    // record the size of the member in its header
+    const auto size = static_cast<std::uint32_t>(out.size());
+    for (std::size_t i = 0; i < 4; ++i) {
+        out[SizeOffset + i] = static_cast<char>((size >> (8 * i)) & 0xff);
+    }
+    return true;
+}
+
+/** Return the size of the member starting with the given header, or 0 if it does not record it. */
+inline std::size_t size(const unsigned char* header) {
+    if (header[0] != 0x1f || header[1] != 0x8b || header[2] != Z_DEFLATED || (header[3] & 4) == 0) {
+        return 0;
+    }
+    if (header[10] != 8 || header[11] != 0 || header[12] != 'S' || header[13] != 'F' || header[14] != 4 ||
+            header[15] != 0) {
+        return 0;
+    }
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        size |= static_cast<std::size_t>(header[SizeOffset + i]) << (8 * i);
+    }
+    return size;
+}
+
+/** Decompress a gzip member into a block; return false on failure. */
+inline bool decompress(const std::string& in, std::string& block) {
+    if (in.size() < HeaderSize + 8) {
+        return false;
+    }
+    // the trailer holds the uncompressed size, which is below 4 GiB by construction
+    const auto* trailer = reinterpret_cast<const unsigned char*>(in.data() + in.size() - 4);
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        length |= static_cast<std::size_t>(trailer[i]) << (8 * i);
+    }
+
+    z_stream stream{};
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return false;
+    }
+    block.resize(length);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    stream.avail_in = static_cast<uInt>(in.size());
+    stream.next_out = reinterpret_cast<Bytef*>(block.data());
+    stream.avail_out = static_cast<uInt>(block.size());
+    const int res = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    return res == Z_STREAM_END && stream.total_out == length;
+}
+
+/** Apply a function to the indexes [0, count) from a team of up to the given number of threads. */
+template <typename F>
+bool forEach(const std::size_t count, const std::size_t threads, const F& f) {
+    std::atomic<bool> ok{true};
+    const auto end = static_cast<std::ptrdiff_t>(count);
+#ifdef _OPENMP
+    const int teamSize = static_cast<int>(std::max<std::size_t>(std::min(threads, count), 1));
+#pragma omp parallel for schedule(dynamic) num_threads(teamSize)
+#endif
+    for (std::ptrdiff_t i = 0; i < end; ++i) {
+        if (!f(static_cast<std::size_t>(i))) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+}  // namespace member
+
 class gzfstreambuf : public std::streambuf {
 public:
     gzfstreambuf() {
@@ -38,7 +164,8 @@ public:
 
     gzfstreambuf(gzfstreambuf&& old) = default;
 
-    gzfstreambuf* open(const std::string& filename, std::ios_base::openmode mode) {
+    gzfstreambuf* open(const std::string& filename, std::ios_base::openmode mode,
+            const int level = Z_DEFAULT_COMPRESSION) {
         if (is_open()) {
             return nullptr;
         }
@@ -47,11 +174,30 @@ public:
         }
 
         this->mode = mode;
-        std::string gzmode((mode & std::ios::in) != 0 ? "rb" : "wb");
-        fileHandle = gzopen(filename.c_str(), gzmode.c_str());
-
-        if (fileHandle == nullptr) {
-            return nullptr;
+        this->level = level;
+        if ((mode & std::ios::out) != 0) {
+            // write independent members
+            file = std::fopen(filename.c_str(), "wb");
+            if (file == nullptr) {
+                return nullptr;
+            }
+        } else {
+            // read files of members that record their size directly, and other files through zlib
+            file = std::fopen(filename.c_str(), "rb");
+            if (file == nullptr) {
+                return nullptr;
+            }
+            unsigned char header[member::HeaderSize];
+            if (std::fread(header, 1, sizeof(header), file) != sizeof(header) || member::size(header) == 0) {
+                std::fclose(file);
+                file = nullptr;
+                fileHandle = gzopen(filename.c_str(), "rb");
+                if (fileHandle == nullptr) {
+                    return nullptr;
+                }
+            } else {
+                std::rewind(file);
+            }
         }
         isOpen = true;
 
@@ -62,13 +208,67 @@ public:
         if (is_open()) {
             sync();
             isOpen = false;
-            if (gzclose(fileHandle) == Z_OK) {
+            if (file != nullptr) {
+                bool ok = true;
+                if ((mode & std::ios::out) != 0) {
+                    // an empty file still has a member
+                    if (!pending.empty() || !written) {
+                        blocks.push_back(std::move(pending));
+                        pending.clear();
+                    }
+                    ok = writeBlocks();
+                }
+                if (inflater) {
+                    inflateEnd(inflater.get());
+                    inflater.reset();
+                }
+                ok = (std::fclose(file) == 0) && ok;
+                file = nullptr;
+                return ok ? this : nullptr;
+            }
+            if (fileHandle != nullptr && gzclose(fileHandle) == Z_OK) {
                 return this;
             }
         }
         return nullptr;
     }
 
+    /**
+     * Compress text into members of its own, to be written by writeMembers().
+     * May be called from concurrent threads.
+     */
+    bool compressMembers(const std::string& text, std::string& out) const {
+        std::string compressed;
+        for (std::size_t pos = 0; pos < text.size(); pos += member::BlockSize) {
+            if (!member::compress(text.substr(pos, member::BlockSize), compressed, level)) {
+                return false;
+            }
+            out += compressed;
+        }
+        return true;
+    }
+
+    /** Write members produced by compressMembers() after the data written so far. */
+    bool writeMembers(const std::string& members) {
+        if (file == nullptr || (mode & std::ios::out) == 0 || sync() != 0) {
+            return false;
+        }
+        if (!pending.empty()) {
+            blocks.push_back(std::move(pending));
+            pending.clear();
+        }
+        if (!writeBlocks()) {
+            return false;
+        }
+        written = written || !members.empty();
+        return std::fwrite(members.data(), 1, members.size(), file) == members.size();
+    }
+
+    /** Set the number of threads that compress or decompress members. */
+    void setThreads(const std::size_t count) {
+        threads = std::max<std::size_t>(count, 1);
+    }
+
     bool is_open() const {
         return isOpen;
     }
@@ -91,11 +291,9 @@ protected:
             *pptr() = c;
             pbump(1);
         }
-        const int toWrite = static_cast<int>(pptr() - pbase());
-        if (gzwrite(fileHandle, pbase(), static_cast<unsigned int>(toWrite)) != toWrite) {
+        if (sync() != 0) {
             return EOF;
         }
-        pbump(-toWrite);
 
         return c;
     }
@@ -108,6 +306,10 @@ protected:
             return traits_type::to_int_type(*gptr());
         }
 
+        if (file != nullptr) {
+            return underflowBlocks();
+        }
+
         std::size_t charsPutBack = gptr() - eback();
         if (charsPutBack > reserveSize) {
             charsPutBack = reserveSize;
@@ -116,7 +318,11 @@ protected:
 
         int charsRead =
                 gzread(fileHandle, buffer + reserveSize, static_cast<unsigned int>(bufferSize - reserveSize));
-        if (charsRead <= 0) {
+        if (charsRead < 0) {
+            int error = Z_OK;
+            throw std::runtime_error(gzerror(fileHandle, &error));
+        }
+        if (charsRead == 0) {
             return EOF;
         }
 
@@ -128,7 +334,18 @@ protected:
     int sync() override {
         if ((pptr() != nullptr) && pptr() > pbase()) {
             const int toWrite = static_cast<int>(pptr() - pbase());
-            if (gzwrite(fileHandle, pbase(), static_cast<unsigned int>(toWrite)) != toWrite) {
+            if (file != nullptr) {
+                // collect the data into blocks, and compress them once there is a block per thread
+                pending.append(pbase(), toWrite);
+                if (pending.size() >= member::BlockSize) {
+                    blocks.push_back(std::move(pending));
+                    pending.clear();
+                    pending.reserve(member::BlockSize);
+                }
+                if (blocks.size() >= threads && !writeBlocks()) {
+                    return -1;
+                }
+            } else if (gzwrite(fileHandle, pbase(), static_cast<unsigned int>(toWrite)) != toWrite) {
                 return -1;
             }
             pbump(-toWrite);
@@ -144,6 +361,148 @@ private:
     gzFile fileHandle = {};
     bool isOpen = false;
     std::ios_base::openmode mode = std::ios_base::in;
+
+    // file of independent members, if not read through zlib
+    std::FILE* file = nullptr;
+    int level = Z_DEFAULT_COMPRESSION;
+    std::size_t threads = 1;
+
+    // whether a member has been written
+    bool written = false;
+
+    // uncompressed data of the member being filled
+    std::string pending;
+
+    // uncompressed blocks, and their members
+    std::vector<std::string> blocks;
+    std::vector<std::string> members;
+
+    // next block to be read
+    std::size_t nextBlock = 0;
+
+    // the stream of the members read through zlib once a member does not record its size
+    std::unique_ptr<z_stream> inflater;
+    // compressed data to be inflated
+    std::vector<unsigned char> input;
+    // whether the stream is within a member
+    bool inMember = false;
+
+    /** Compress the collected blocks concurrently and write their members in order. */
+    bool writeBlocks() {
+        members.resize(blocks.size());
+        bool ok = member::forEach(blocks.size(), threads,
+                [&](std::size_t i) { return member::compress(blocks[i], members[i], level); });
+        for (std::size_t i = 0; ok && i < members.size(); ++i) {
+            ok = std::fwrite(members[i].data(), 1, members[i].size(), file) == members[i].size();
+        }
+        written = written || !blocks.empty();
+        blocks.clear();
+        return ok;
+    }
+
+    /**
+     * Read the members of the next blocks, one per thread, and decompress them concurrently.
+     * Stops at a member that does not record its size, from which on the file is inflated by zlib.
+     * Return false at the end of the file.
+     */
+    bool readBlocks() {
+        members.clear();
+        while (members.size() < threads) {
+            unsigned char header[member::HeaderSize];
+            const std::size_t count = std::fread(header, 1, sizeof(header), file);
+            if (count == 0) {
+                break;
+            }
+            const std::size_t size = member::size(header);
+            if (count != sizeof(header) || size < sizeof(header)) {
+                std::fseek(file, -static_cast<long>(count), SEEK_CUR);
+                startInflater();
+                break;
+            }
+            std::string& in = members.emplace_back(size, '\0');
+            std::memcpy(in.data(), header, sizeof(header));
+            const std::size_t rest = size - sizeof(header);
+            if (std::fread(in.data() + sizeof(header), 1, rest, file) != rest) {
+                throw std::runtime_error("truncated gzip member");
+            }
+        }
+        blocks.resize(members.size());
+        nextBlock = 0;
+        if (!member::forEach(members.size(), threads,
+                    [&](std::size_t i) { return member::decompress(members[i], blocks[i]); })) {
+            throw std::runtime_error("corrupt gzip member");
+        }
+        return !members.empty() || inflater;
+    }
+
+    /** Make the next decompressed block the get area. */
+    int_type underflowBlocks() {
+        while (true) {
+            for (; nextBlock < blocks.size(); ++nextBlock) {
+                if (!blocks[nextBlock].empty()) {
+                    char* data = blocks[nextBlock].data();
+                    setg(data, data, data + blocks[nextBlock].size());
+                    ++nextBlock;
+                    return traits_type::to_int_type(*gptr());
+                }
+            }
+            if (inflater) {
+                return underflowInflater();
+            }
+            if (!readBlocks()) {
+                return EOF;
+            }
+        }
+    }
+
+    void startInflater() {
+        inflater = std::make_unique<z_stream>();
+        if (inflateInit2(inflater.get(), 15 + 16) != Z_OK) {
+            inflater.reset();
+            throw std::runtime_error("cannot initialise zlib");
+        }
+        input.resize(bufferSize);
+        inMember = false;
+    }
+
+    /**
+     * Inflate the following members into the get area, as zlib reads concatenated gzip files:
+     * data after a member that is not another member ends the input.
+     */
+    int_type underflowInflater() {
+        char* out = buffer + reserveSize;
+        const auto outSize = static_cast<uInt>(bufferSize - reserveSize);
+        inflater->next_out = reinterpret_cast<Bytef*>(out);
+        inflater->avail_out = outSize;
+        while (inflater->avail_out == outSize) {
+            if (inflater->avail_in == 0) {
+                const std::size_t count = std::fread(input.data(), 1, input.size(), file);
+                if (count == 0) {
+                    if (inMember) {
+                        throw std::runtime_error("truncated gzip member");
+                    }
+                    return EOF;
+                }
+                inflater->next_in = input.data();
+                inflater->avail_in = static_cast<uInt>(count);
+            }
+            if (!inMember) {
+                if (inflater->next_in[0] != 0x1f) {
+                    return EOF;
+                }
+                inflateReset(inflater.get());
+                inMember = true;
+            }
+            const int res = inflate(inflater.get(), Z_NO_FLUSH);
+            if (res == Z_STREAM_END) {
+                inMember = false;
+            } else if (res != Z_OK && res != Z_BUF_ERROR) {
+                throw std::runtime_error("corrupt gzip data");
+            }
+        }
+        setg(out, out, out + (outSize - inflater->avail_out));
+        return traits_type::to_int_type(*gptr());
+    }
 };
 
 class gzfstream : virtual public std::ios {
@@ -152,9 +511,10 @@ public:
         init(&buf);
     }
 
-    gzfstream(const std::string& filename, std::ios_base::openmode mode) {
+    gzfstream(const std::string& filename, std::ios_base::openmode mode,
+            const int level = Z_DEFAULT_COMPRESSION) {
         init(&buf);
-        open(filename, mode);
+        open(filename, mode, level);
     }
 
     gzfstream(const gzfstream&) = delete;
@@ -163,8 +523,9 @@ public:
 
     ~gzfstream() override = default;
 
-    void open(const std::string& filename, std::ios_base::openmode mode) {
-        if (buf.open(filename, mode) == nullptr) {
+    void open(const std::string& filename, std::ios_base::openmode mode,
+            const int level = Z_DEFAULT_COMPRESSION) {
+        if (buf.open(filename, mode, level) == nullptr) {
             clear(rdstate() | std::ios::badbit);
         }
     }
@@ -215,8 +576,9 @@ class ogzfstream : public internal::gzfstream, public std::ostream {
 public:
     ogzfstream() : std::ostream(&buf) {}
 
-    explicit ogzfstream(const std::string& filename, std::ios_base::openmode mode = std::ios::out)
-            : internal::gzfstream(filename, mode), std::ostream(&buf) {}
+    explicit ogzfstream(const std::string& filename, std::ios_base::openmode mode = std::ios::out,
+            const int level = Z_DEFAULT_COMPRESSION)
+            : internal::gzfstream(filename, mode, level), std::ostream(&buf) {}
 
     ogzfstream(const ogzfstream&) = delete;
 
@@ -226,8 +588,9 @@ public:
         return internal::gzfstream::rdbuf();
     }
 
-    void open(const std::string& filename, std::ios_base::openmode mode = std::ios::out) {
-        internal::gzfstream::open(filename, mode);
+    void open(const std::string& filename, std::ios_base::openmode mode = std::ios::out,
+            const int level = Z_DEFAULT_COMPRESSION) {
+        internal::gzfstream::open(filename, mode, level);
     }
 };
 
@@ -0,0 +1,110 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file EventBuffer.h
+ *
+ * Defines the binary records and ring buffers in which profile events are
+ * collected before they are processed into the profile database
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/ParallelUtil.h"
+#include "souffle/utility/Types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace souffle {
+namespace profile {
+
+/**
+ * A profile event in binary form
+ *
+ * The text of the event is interned; the meaning of the remaining fields
+ * depends on the kind of the event.
+ */
+struct EventRecord {
+    enum class Kind : uint32_t { Timing, Quantity, NonRecursiveCount, RecursiveCount, Utilisation, Counters };
+
+    Kind kind;
+    /** identifier of the interned event text */
+    uint32_t text;
+    /** start and end of a timing event, or the time of a utilisation event, in microseconds */
+    int64_t start;
+    int64_t end;
+    /** sizes, counters and the iteration of the event */
+    uint64_t values[6];
+    /** estimated join size of a count event */
+    double joinSize;
+};
+
+/**
+ * A ring buffer of profile events with a single producer
+ *
+ * The thread owning the ring appends events without taking a lock. Another
+ * thread drains the ring; concurrent drains must be serialised by the caller.
+ */
+class EventRing {
+public:
+    /** The number of events a ring holds */
+    static constexpr std::size_t Capacity = 4096;
+
+    EventRing() : records(new EventRecord[Capacity]) {}
+    EventRing(const EventRing&) = delete;
+    EventRing& operator=(const EventRing&) = delete;
+
+    /**
+     * Append an event
+     *
+     * @return false if the ring is full
+     */
+    bool push(const EventRecord& record) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        records[t % Capacity] = record;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove all events appended so far, passing them in order to the given function
+     *
+     * @return the number of drained events
+     */
+    template <typename F>
+    std::size_t drain(F&& f) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        const std::size_t t = tail.load(std::memory_order_acquire);
+        for (std::size_t i = h; i != t; ++i) {
+            f(records[i % Capacity]);
+        }
+        head.store(t, std::memory_order_release);
+        return t - h;
+    }
+
+    /** Check whether there are no events to drain */
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    Own<EventRecord[]> records;
+    /** position of the next event to drain */
+    alignas(hardware_destructive_interference_size) std::atomic<std::size_t> head{0};
+    /** position of the next event to append */
+    alignas(hardware_destructive_interference_size) std::atomic<std::size_t> tail{0};
+};
+
+}  // namespace profile
+}  // namespace souffle
@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include "souffle/profile/PerfCounters.h"
 #include "souffle/profile/ProfileDatabase.h"
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/StreamUtil.h"
+#include "souffle/utility/StringUtil.h"
 #include <cassert>
 #include <chrono>
 #include <cstdarg>
@@ -83,6 +85,26 @@ public:
         va_end(args);
     }
 
+    /** split string separated by semi-colon */
+    static std::vector<std::string> splitSignature(std::string str) {
+        for (std::size_t i = 0; i < str.size(); i++) {
+            if (i > 0 && str[i] == ';' && str[i - 1] == '\\') {
+                // I'm assuming this isn't a thing that will be naturally found in souffle profiler files
+                str[i - 1] = '\b';
+                str.erase(i--, 1);
+            }
+        }
+        std::vector<std::string> result = split(str, ";");
+        for (auto& i : result) {
+            for (char& j : i) {
+                if (j == '\b') {
+                    j = ';';
+                }
+            }
+        }
+        return result;
+    }
+
 private:
     /** keyword / event processor mapping */
     std::map<std::string, EventProcessor*> registry;
@@ -152,26 +174,6 @@ private:
 
         return elems;
     }
-
-    /** split string separated by semi-colon */
-    static std::vector<std::string> splitSignature(std::string str) {
-        for (std::size_t i = 0; i < str.size(); i++) {
-            if (i > 0 && str[i] == ';' && str[i - 1] == '\\') {
-                // I'm assuming this isn't a thing that will be naturally found in souffle profiler files
-                str[i - 1] = '\b';
-                str.erase(i--, 1);
-            }
-        }
-        std::vector<std::string> result = split(str, ";");
-        for (auto& i : result) {
-            for (char& j : i) {
-                if (j == '\b') {
-                    j = ';';
-                }
-            }
-        }
-        return result;
-    }
 };
 
 /**
@@ -325,6 +327,84 @@ public:
     }
 } recursiveRuleNumberProcessor;
 
+/**
+ * Add the performance counters of a rule below the given path
+ */
+inline void addCounterEntries(ProfileDatabase& db, std::vector<std::string> path, const uint64_t* counters,
+        std::size_t scanned) {
+    path.push_back("counters");
+    path.push_back("tuples-scanned");
+    db.addSizeEntry(path, scanned);
+    const std::vector<std::string>& names = PerfCounters::instance().getNames();
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        path.back() = names[i];
+        db.addSizeEntry(path, counters[i]);
+    }
+}
+
+/**
+ * Non-Recursive Rule Counters Profile Event Processor
+ */
+const class NonRecursiveRuleCountersProcessor : public EventProcessor {
+public:
+    NonRecursiveRuleCountersProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@p-nonrecursive-rule", this);
+    }
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& rule = signature[3];
+        const uint64_t* counters = va_arg(args, const uint64_t*);
+        std::size_t scanned = va_arg(args, std::size_t);
+        addCounterEntries(
+                db, {"program", "relation", relation, "non-recursive-rule", rule}, counters, scanned);
+    }
+} nonRecursiveRuleCountersProcessor;
+
+/**
+ * Recursive Rule Counters Profile Event Processor
+ */
+const class RecursiveRuleCountersProcessor : public EventProcessor {
+public:
+    RecursiveRuleCountersProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@p-recursive-rule", this);
+    }
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& version = signature[2];
+        const std::string& rule = signature[4];
+        const uint64_t* counters = va_arg(args, const uint64_t*);
+        std::size_t scanned = va_arg(args, std::size_t);
+        std::string iteration = std::to_string(va_arg(args, std::size_t));
+        addCounterEntries(db,
+                {"program", "relation", relation, "iteration", iteration, "recursive-rule", rule, version},
+                counters, scanned);
+    }
+} recursiveRuleCountersProcessor;
+
+/**
+ * Recursive Rule Join Plan Profile Event Processor
+ *
+ * Records the join order chosen for a rule version in an iteration, if it
+ * differs from the order chosen in the previous iteration.
+ */
+const class RecursiveRulePlanProcessor : public EventProcessor {
+public:
+    RecursiveRulePlanProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@plan-recursive-rule", this);
+    }
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& version = signature[2];
+        const std::string& rule = signature[4];
+        const std::vector<std::string> plans = splitString(signature[5], ' ');
+        std::size_t plan = va_arg(args, std::size_t);
+        std::string iteration = std::to_string(va_arg(args, std::size_t));
+        db.addTextEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
+                                version, "join-plan"},
+                plan < plans.size() ? plans[plan] : std::to_string(plan));
+    }
+} recursiveRulePlanProcessor;
+
 /**
  * Non-Recursive Relation Number Profile Event Processor
  */
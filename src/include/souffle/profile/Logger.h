@@ -17,8 +17,10 @@
 
 #pragma once
 
+#include "souffle/profile/PerfCounters.h"
 #include "souffle/profile/ProfileEvent.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StringUtil.h"
 #include <cstddef>
 #include <functional>
 #include <string>
@@ -33,13 +35,17 @@ namespace souffle {
  *
  * To far, only execution times are logged. More events, e.g. the number of
  * processed tuples may be added in the future.
+ *
+ * If the performance counters are enabled, the counters and the number of
+ * scanned tuples are additionally sampled for the evaluation of each rule.
  */
 class Logger {
 public:
     Logger(std::string label, std::size_t iteration) : Logger(label, iteration, []() { return 0; }) {}
 
     Logger(std::string label, std::size_t iteration, std::function<std::size_t()> size)
-            : label(std::move(label)), start(now()), iteration(iteration), size(size), preSize(size()) {
+            : label(std::move(label)), start(now()), iteration(iteration), size(size), preSize(size()),
+              counted(profile::PerfCounters::instance().isEnabled() && isRuleTimer(this->label)) {
 #ifdef WIN32
         HANDLE hProcess = GetCurrentProcess();
         PROCESS_MEMORY_COUNTERS processMemoryCounters;
@@ -52,9 +58,23 @@ public:
 #endif  // WIN32
         // Assume that if we are logging the progress of an event then we care about usage during that time.
         ProfileEventSingleton::instance().resetTimerInterval();
+        if (counted) {
+            startScanned = profile::PerfCounters::instance().scannedTuples();
+            startCounters = profile::PerfCounters::instance().read();
+        }
     }
 
     ~Logger() {
+        if (counted) {
+            auto& counters = profile::PerfCounters::instance();
+            profile::PerfCounters::Values endCounters = counters.read();
+            for (std::size_t i = 0; i < endCounters.size(); ++i) {
+                // scaled values are estimates, which may shrink as the multiplexing ratio changes
+                endCounters[i] = endCounters[i] > startCounters[i] ? endCounters[i] - startCounters[i] : 0;
+            }
+            ProfileEventSingleton::instance().makeCountersEvent("@p-" + label.substr(3), endCounters,
+                    counters.scannedTuples() - startScanned, iteration);
+        }
 #ifdef WIN32
         HANDLE hProcess = GetCurrentProcess();
         PROCESS_MEMORY_COUNTERS processMemoryCounters;
@@ -76,5 +96,13 @@ private:
     std::size_t iteration;
     std::function<std::size_t()> size;
     std::size_t preSize;
+    bool counted;
+    profile::PerfCounters::Values startCounters{};
+    std::size_t startScanned = 0;
+
+    /** Check whether the label is that of the timer of a rule */
+    static bool isRuleTimer(const std::string& label) {
+        return isPrefix("@t-nonrecursive-rule;", label) || isPrefix("@t-recursive-rule;", label);
+    }
 };
 }  // end of namespace souffle
@@ -17,6 +17,8 @@
 #include "souffle/profile/Rule.h"
 #include "souffle/profile/Table.h"
 #include <chrono>
+#include <cstddef>
+#include <map>
 #include <memory>
 #include <ratio>
 #include <set>
@@ -55,6 +57,8 @@ public:
     Table getVersions(std::string strRel, std::string strRul) const;
 
     Table getVersionAtoms(std::string strRel, std::string strRul, int version) const;
+
+    std::map<std::string, std::size_t> getCounters(std::string strRel, std::string strRul) const;
 };
 
 /*
@@ -380,5 +384,47 @@ Table inline OutputProcessor::getVersionAtoms(std::string strRel, std::string sr
     return table;
 }
 
+/*
+ * performance counters of a rule, summed over all versions and iterations,
+ * along with the tuples it produced; empty if no counters were sampled
+ */
+inline std::map<std::string, std::size_t> OutputProcessor::getCounters(
+        std::string strRel, std::string strRul) const {
+    std::map<std::string, std::size_t> counters;
+    const Relation* rel = nullptr;
+    for (auto& current : programRun->getRelationMap()) {
+        if (current.second->getId() == strRel) {
+            rel = current.second.get();
+            break;
+        }
+    }
+    if (rel == nullptr) {
+        return counters;
+    }
+
+    std::size_t produced = 0;
+    auto add = [&](const Rule& rule) {
+        if (rule.getId() != strRul) {
+            return;
+        }
+        for (auto& counter : rule.getCounters()) {
+            counters[counter.first] += counter.second;
+        }
+        produced += rule.size();
+    };
+    for (auto& current : rel->getRuleMap()) {
+        add(*current.second);
+    }
+    for (auto& iter : rel->getIterations()) {
+        for (auto& current : iter->getRules()) {
+            add(*current.second);
+        }
+    }
+    if (!counters.empty()) {
+        counters["tuples-produced"] = produced;
+    }
+    return counters;
+}
+
 }  // namespace profile
 }  // namespace souffle
@@ -0,0 +1,241 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file PerfCounters.h
+ *
+ * Defines the performance counters sampled by the profiler for each rule
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+
+namespace souffle {
+namespace profile {
+
+/**
+ * Performance counters of the evaluation
+ *
+ * On Linux, the counters are opened with perf_event_open for the calling
+ * thread and inherited by the threads it creates afterwards, so they should be
+ * enabled before the worker threads are started. The hardware counters (cycles,
+ * instructions, cache references and misses) are used if the machine exposes a
+ * PMU; otherwise the software counters of the kernel are used instead. If
+ * neither can be opened, e.g. due to perf_event_paranoid, no counters are
+ * available and only the scanned tuples are counted.
+ *
+ * The counters cover the whole process rather than the calling thread, hence
+ * the difference of two readings around a rule also includes the work other
+ * threads did concurrently, e.g. in parallel strata; the numbers of a rule are
+ * therefore approximate. If the kernel multiplexes more counters than the PMU
+ * provides, each counter is only running part of the time; its value is then
+ * extrapolated to the whole time it was enabled.
+ *
+ * The scanned tuples are counted by the evaluation itself (see countTuple()),
+ * in a slot per thread.
+ */
+class PerfCounters {
+public:
+    /** The maximal number of counters */
+    static constexpr std::size_t MaxCounters = 4;
+
+    /** Values of the counters, in the order of their names */
+    using Values = std::array<uint64_t, MaxCounters>;
+
+    static PerfCounters& instance() {
+        static PerfCounters singleton;
+        return singleton;
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+        closeAll();
+    }
+
+    /** Open the counters; has no effect if they are already enabled */
+    void enable() {
+        if (enabled) {
+            return;
+        }
+#ifdef __linux__
+        const Spec hardware[] = {{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, "cache-references"},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache-misses"}};
+        const Spec software[] = {{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, "task-clock"},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page-faults"},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context-switches"},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, "cpu-migrations"}};
+        // the hardware counters are only used if at least the cycles can be counted
+        if (open(hardware[0])) {
+            for (std::size_t i = 1; i < MaxCounters; ++i) {
+                open(hardware[i]);
+            }
+        } else {
+            for (const auto& spec : software) {
+                open(spec);
+            }
+        }
+#endif  // __linux__
+        enabled = true;
+    }
+
+    /** Check whether counters are sampled */
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    /** Obtain the names of the available counters */
+    const std::vector<std::string>& getNames() const {
+        return names;
+    }
+
+    /** Read the current values of the counters, scaled for multiplexing */
+    Values read() const {
+        Values res{};
+#ifdef __linux__
+        for (std::size_t i = 0; i < fds.size(); ++i) {
+            // the layout given by the read format of open()
+            struct {
+                uint64_t value;
+                uint64_t timeEnabled;
+                uint64_t timeRunning;
+            } reading{};
+            if (::read(fds[i], &reading, sizeof(reading)) == sizeof(reading)) {
+                res[i] = scale(reading.value, reading.timeEnabled, reading.timeRunning);
+            }
+        }
+#endif  // __linux__
+        return res;
+    }
+
+    /**
+     * Extrapolate the value of a counter that was only running for part of the time it was enabled
+     *
+     * @return the estimated value for the whole time, or 0 if the counter never ran
+     */
+    static uint64_t scale(uint64_t value, uint64_t timeEnabled, uint64_t timeRunning) {
+        if (timeRunning == 0) {
+            return 0;
+        }
+        if (timeRunning >= timeEnabled) {
+            return value;
+        }
+        return static_cast<uint64_t>(static_cast<long double>(value) * timeEnabled / timeRunning);
+    }
+
+    /** Count a tuple scanned by the calling thread */
+    static void countTuple() {
+        std::atomic<std::size_t>& count = localSlot().count;
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /** Obtain the number of tuples scanned by all threads so far */
+    std::size_t scannedTuples() {
+        std::lock_guard<std::mutex> guard(slotsMutex);
+        std::size_t res = 0;
+        for (const auto& slot : slots) {
+            res += slot->count.load(std::memory_order_relaxed);
+        }
+        return res;
+    }
+
+private:
+    /** The number of tuples scanned by a thread, which only that thread updates */
+    struct alignas(hardware_destructive_interference_size) Slot {
+        std::atomic<std::size_t> count{0};
+    };
+
+    struct Spec {
+        uint32_t type;
+        uint64_t config;
+        const char* name;
+    };
+
+    bool enabled = false;
+
+    /** file descriptors and names of the open counters */
+    std::vector<int> fds;
+    std::vector<std::string> names;
+
+    /** slots of all threads that scanned tuples */
+    std::vector<Own<Slot>> slots;
+    std::mutex slotsMutex;
+
+    PerfCounters() = default;
+
+    static Slot& localSlot() {
+        thread_local Slot* slot = nullptr;
+        if (slot == nullptr) {
+            PerfCounters& counters = instance();
+            std::lock_guard<std::mutex> guard(counters.slotsMutex);
+            counters.slots.push_back(mk<Slot>());
+            slot = counters.slots.back().get();
+        }
+        return *slot;
+    }
+
+#ifdef __linux__
+    /** Open a counter; returns false if it is not available */
+    bool open(const Spec& spec) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = spec.type;
+        attr.config = spec.config;
+        attr.inherit = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_hv = 1;
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+            // unprivileged processes may only count events in user space
+            attr.exclude_kernel = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        }
+        if (fd < 0) {
+            return false;
+        }
+        fds.push_back(fd);
+        names.push_back(spec.name);
+        return true;
+    }
+#endif  // __linux__
+
+    void closeAll() {
+#ifdef __linux__
+        for (int fd : fds) {
+            ::close(fd);
+        }
+#endif  // __linux__
+        fds.clear();
+        names.clear();
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
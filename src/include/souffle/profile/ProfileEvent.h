@@ -16,19 +16,25 @@
 
 #pragma once
 
+#include "souffle/profile/EventBuffer.h"
 #include "souffle/profile/EventProcessor.h"
+#include "souffle/profile/PerfCounters.h"
 #include "souffle/profile/ProfileDatabase.h"
+#include "souffle/profile/TraceWriter.h"
 #include "souffle/utility/MiscUtil.h"
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <ctime>
+#include <deque>
 #include <iostream>
 #include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #ifdef WIN32
 #include <Psapi.h>
 #else
@@ -40,13 +46,37 @@ namespace souffle {
 
 /**
  * Profile Event Singleton
+ *
+ * The frequent events (timings, quantities, join sizes and utilisation) are
+ * recorded in binary form in a ring buffer of the emitting thread, and processed
+ * into the profile database by the profile timer thread, when a ring overflows,
+ * or when the database is accessed or dumped.
  */
 class ProfileEventSingleton {
     /** profile database */
     profile::ProfileDatabase database{};
     std::string filename{""};
 
-    ProfileEventSingleton() {}
+    /** event rings of all threads that emitted events */
+    std::vector<Own<profile::EventRing>> rings;
+    std::mutex ringsMutex;
+
+    /** serialises the processing of the event rings (and the trace) */
+    std::mutex flushMutex;
+
+    /** timeline of the evaluation, collected if a trace file is set */
+    profile::TraceWriter trace;
+    std::string traceFilename{""};
+
+    /** interned event texts */
+    std::deque<std::string> texts;
+    std::unordered_map<std::string, uint32_t> textIds;
+    std::mutex textMutex;
+
+    ProfileEventSingleton() {
+        // the counters outlive this singleton, whose final dump refers to their names
+        profile::PerfCounters::instance();
+    }
 
 public:
     ~ProfileEventSingleton() {
@@ -74,23 +104,47 @@ public:
     /** create an event for recording start and end times */
     void makeTimingEvent(const std::string& txt, time_point start, time_point end, std::size_t startMaxRSS,
             std::size_t endMaxRSS, std::size_t size, std::size_t iteration) {
-        microseconds start_ms = std::chrono::duration_cast<microseconds>(start.time_since_epoch());
-        microseconds end_ms = std::chrono::duration_cast<microseconds>(end.time_since_epoch());
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), start_ms, end_ms, startMaxRSS, endMaxRSS, size, iteration);
+        profile::EventRecord record = makeRecord(profile::EventRecord::Kind::Timing, txt);
+        record.start = std::chrono::duration_cast<microseconds>(start.time_since_epoch()).count();
+        record.end = std::chrono::duration_cast<microseconds>(end.time_since_epoch()).count();
+        record.values[0] = startMaxRSS;
+        record.values[1] = endMaxRSS;
+        record.values[2] = size;
+        record.values[3] = iteration;
+        recordEvent(record);
     }
 
     /** create quantity event */
     void makeQuantityEvent(const std::string& txt, std::size_t number, int iteration) {
-        profile::EventProcessorSingleton::instance().process(database, txt.c_str(), number, iteration);
+        profile::EventRecord record = makeRecord(profile::EventRecord::Kind::Quantity, txt);
+        record.values[0] = number;
+        record.values[1] = iteration;
+        recordEvent(record);
     }
 
     void makeNonRecursiveCountEvent(const std::string& txt, double joinSize) {
-        profile::EventProcessorSingleton::instance().process(database, txt.c_str(), joinSize);
+        profile::EventRecord record = makeRecord(profile::EventRecord::Kind::NonRecursiveCount, txt);
+        record.joinSize = joinSize;
+        recordEvent(record);
     }
 
     void makeRecursiveCountEvent(const std::string& txt, double joinSize, std::size_t iteration) {
-        profile::EventProcessorSingleton::instance().process(database, txt.c_str(), joinSize, iteration);
+        profile::EventRecord record = makeRecord(profile::EventRecord::Kind::RecursiveCount, txt);
+        record.joinSize = joinSize;
+        record.values[0] = iteration;
+        recordEvent(record);
+    }
+
+    /** create an event for the performance counters sampled during a rule */
+    void makeCountersEvent(const std::string& txt, const profile::PerfCounters::Values& counters,
+            std::size_t scanned, std::size_t iteration) {
+        profile::EventRecord record = makeRecord(profile::EventRecord::Kind::Counters, txt);
+        for (std::size_t i = 0; i < counters.size(); ++i) {
+            record.values[i] = counters[i];
+        }
+        record.values[4] = scanned;
+        record.values[5] = iteration;
+        recordEvent(record);
     }
 
     /** create utilisation event */
@@ -129,15 +183,40 @@ public:
         std::size_t maxRSS = ru.ru_maxrss;
 #endif  // WIN32
 
-        profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), time, systemTime, userTime, maxRSS);
+        profile::EventRecord record = makeRecord(profile::EventRecord::Kind::Utilisation, txt);
+        record.start = time.count();
+        record.values[0] = systemTime;
+        record.values[1] = userTime;
+        record.values[2] = maxRSS;
+        recordEvent(record);
+    }
+
+    /** Process the events recorded so far into the profile database */
+    void flush() {
+        std::lock_guard<std::mutex> guard(flushMutex);
+        std::vector<profile::EventRing*> current;
+        {
+            std::lock_guard<std::mutex> ringsGuard(ringsMutex);
+            for (auto& ring : rings) {
+                current.push_back(ring.get());
+            }
+        }
+        for (std::size_t thread = 0; thread < current.size(); ++thread) {
+            current[thread]->drain([&](const profile::EventRecord& record) { process(record, thread); });
+        }
     }
 
     void setOutputFile(std::string outputFilename) {
         filename = outputFilename;
     }
+
+    /** Set the file to which the timeline of the evaluation is written as a Chrome trace */
+    void setTraceFile(std::string outputFilename) {
+        traceFilename = outputFilename;
+    }
     /** Dump all events */
     void dump() {
+        flush();
         if (!filename.empty()) {
             std::ofstream os(filename);
             if (!os.is_open()) {
@@ -146,6 +225,15 @@ public:
                 database.print(os);
             }
         }
+        if (!traceFilename.empty()) {
+            std::lock_guard<std::mutex> guard(flushMutex);
+            std::ofstream os(traceFilename);
+            if (!os.is_open()) {
+                std::cerr << "Cannot open profile trace file <" + traceFilename + ">";
+            } else {
+                trace.print(os);
+            }
+        }
     }
 
     /** Start timer */
@@ -161,7 +249,8 @@ public:
     void resetTimerInterval(uint32_t interval = 1) {
         timer.resetTimerInterval(interval);
     }
-    const profile::ProfileDatabase& getDB() const {
+    const profile::ProfileDatabase& getDB() {
+        flush();
         return database;
     }
 
@@ -170,6 +259,96 @@ public:
     }
 
 private:
+    /** Obtain the event ring of the calling thread */
+    profile::EventRing& localRing() {
+        thread_local profile::EventRing* ring = nullptr;
+        if (ring == nullptr) {
+            std::lock_guard<std::mutex> guard(ringsMutex);
+            rings.push_back(mk<profile::EventRing>());
+            ring = rings.back().get();
+        }
+        return *ring;
+    }
+
+    /** Obtain the identifier of the given event text */
+    uint32_t intern(const std::string& txt) {
+        thread_local std::unordered_map<std::string, uint32_t> cache;
+        auto pos = cache.find(txt);
+        if (pos != cache.end()) {
+            return pos->second;
+        }
+        std::lock_guard<std::mutex> guard(textMutex);
+        auto res = textIds.emplace(txt, static_cast<uint32_t>(texts.size()));
+        if (res.second) {
+            texts.push_back(txt);
+        }
+        cache.emplace(txt, res.first->second);
+        return res.first->second;
+    }
+
+    /** Create an event of the given kind with the given text */
+    profile::EventRecord makeRecord(profile::EventRecord::Kind kind, const std::string& txt) {
+        profile::EventRecord record{};
+        record.kind = kind;
+        record.text = intern(txt);
+        return record;
+    }
+
+    /** Append an event to the ring of the calling thread, processing all rings if it is full */
+    void recordEvent(const profile::EventRecord& record) {
+        profile::EventRing& ring = localRing();
+        while (!ring.push(record)) {
+            flush();
+        }
+    }
+
+    /** Process an event recorded by the given thread into the profile database and the trace */
+    void process(const profile::EventRecord& record, std::size_t thread) {
+        std::string txt;
+        {
+            std::lock_guard<std::mutex> guard(textMutex);
+            txt = texts[record.text];
+        }
+        auto& processor = profile::EventProcessorSingleton::instance();
+        switch (record.kind) {
+            case profile::EventRecord::Kind::Timing:
+                processor.process(database, txt.c_str(), microseconds(record.start),
+                        microseconds(record.end), std::size_t(record.values[0]),
+                        std::size_t(record.values[1]), std::size_t(record.values[2]),
+                        std::size_t(record.values[3]));
+                break;
+            case profile::EventRecord::Kind::Quantity:
+                processor.process(database, txt.c_str(), std::size_t(record.values[0]),
+                        std::size_t(record.values[1]));
+                break;
+            case profile::EventRecord::Kind::NonRecursiveCount:
+                processor.process(database, txt.c_str(), record.joinSize);
+                break;
+            case profile::EventRecord::Kind::RecursiveCount:
+                processor.process(database, txt.c_str(), record.joinSize, std::size_t(record.values[0]));
+                break;
+            case profile::EventRecord::Kind::Utilisation:
+                processor.process(database, txt.c_str(), microseconds(record.start), record.values[0],
+                        record.values[1], std::size_t(record.values[2]));
+                break;
+            case profile::EventRecord::Kind::Counters:
+                processor.process(database, txt.c_str(), record.values, std::size_t(record.values[4]),
+                        std::size_t(record.values[5]));
+                break;
+        }
+
+        if (traceFilename.empty()) {
+            return;
+        }
+        if (record.kind == profile::EventRecord::Kind::Timing) {
+            trace.addTiming(thread, profile::EventProcessorSingleton::splitSignature(txt),
+                    microseconds(record.start), microseconds(record.end), record.values[1], record.values[2],
+                    record.values[3]);
+        } else if (record.kind == profile::EventRecord::Kind::Utilisation) {
+            trace.addUtilisation(microseconds(record.start), record.values[2]);
+        }
+    }
+
     /**  Profile Timer */
     class ProfileTimer {
     private:
@@ -191,6 +370,7 @@ private:
         /** run method for thread th */
         void run() {
             ProfileEventSingleton::instance().makeUtilisationEvent("@utilisation");
+            ProfileEventSingleton::instance().flush();
             ++runCount;
             if (runCount % 128 == 0) {
                 increaseInterval();
@@ -86,6 +86,21 @@ private:
     Rule& rule;
 };
 
+/**
+ * Visit ProfileDB performance counters of a rule.
+ * counters: {counter: num, ...}
+ */
+class CountersVisitor : public Visitor {
+public:
+    CountersVisitor(Rule& rule) : rule(rule) {}
+    void visit(SizeEntry& size) override {
+        rule.addCounter(size.getKey(), size.getSize());
+    }
+
+private:
+    Rule& rule;
+};
+
 /**
  * Visit ProfileDB recursive rule.
  * ruleversion: {DSN}
@@ -99,6 +114,11 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters") {
+            CountersVisitor countersVisitor(base);
+            for (auto& key : directory.getKeys()) {
+                directory.readEntry(key)->accept(countersVisitor);
+            }
         }
     }
 };
@@ -144,6 +164,11 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters") {
+            CountersVisitor countersVisitor(base);
+            for (auto& key : directory.getKeys()) {
+                directory.readEntry(key)->accept(countersVisitor);
+            }
         }
     }
 };
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
@@ -53,6 +55,8 @@ protected:
     std::string identifier;
     std::string locator{};
     std::set<Atom> atoms;
+    /** performance counters and scanned tuples */
+    std::map<std::string, std::size_t> counters;
 
 private:
     bool recursive = false;
@@ -80,7 +84,7 @@ public:
         return endtime;
     }
 
-    std::size_t size() {
+    std::size_t size() const {
         return numTuples;
     }
 
@@ -104,6 +108,14 @@ public:
     const std::set<Atom>& getAtoms() const {
         return atoms;
     }
+
+    void addCounter(const std::string& counter, std::size_t value) {
+        counters[counter] += value;
+    }
+
+    const std::map<std::string, std::size_t>& getCounters() const {
+        return counters;
+    }
     std::string getName() const {
         return name;
     }
@@ -0,0 +1,138 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file TraceWriter.h
+ *
+ * Defines a writer for the timeline of a profiled evaluation in the
+ * Chrome trace-event format
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/json11.h"
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace souffle {
+namespace profile {
+
+/**
+ * Collects the timeline of a profiled evaluation and writes it in the Chrome
+ * trace-event format, which can be opened in Perfetto or chrome://tracing.
+ *
+ * Timing events become spans on the track of the thread that recorded them,
+ * categorised as relation (a non-recursive stratum), iteration (of a recursive
+ * stratum), rule, merge, io and program. The sizes of the relations and the
+ * maximum resident set size become counter tracks.
+ */
+class TraceWriter {
+public:
+    /**
+     * Add the span of a timing event
+     *
+     * @param thread the thread that recorded the event
+     * @param signature the event text split into its fields
+     */
+    void addTiming(std::size_t thread, const std::vector<std::string>& signature, microseconds start,
+            microseconds end, std::size_t endMaxRSS, std::size_t size, std::size_t iteration) {
+        const std::string& keyword = signature[0];
+        auto field = [&](std::size_t i) { return i < signature.size() ? signature[i] : std::string(); };
+
+        std::string category;
+        std::string name;
+        json11::Json::object args;
+        if (keyword == "@t-nonrecursive-relation") {
+            category = "relation";
+            name = field(1);
+            args = {{"source-locator", field(2)}, {"num-tuples", (long long)size}};
+            addRelationSize(field(1), end, size);
+        } else if (keyword == "@t-recursive-relation") {
+            category = "iteration";
+            name = field(1) + " #" + std::to_string(iteration);
+            args = {{"source-locator", field(2)}, {"num-tuples", (long long)size}};
+            addRelationSize(field(1), end, size);
+        } else if (keyword == "@c-recursive-relation") {
+            category = "merge";
+            name = field(1) + " #" + std::to_string(iteration);
+        } else if (keyword == "@t-nonrecursive-rule") {
+            category = "rule";
+            name = field(3);
+            args = {{"relation", field(1)}, {"source-locator", field(2)}, {"num-tuples", (long long)size}};
+        } else if (keyword == "@t-recursive-rule") {
+            category = "rule";
+            name = field(4);
+            args = {{"relation", field(1)}, {"version", field(2)}, {"source-locator", field(3)},
+                    {"iteration", (long long)iteration}, {"num-tuples", (long long)size}};
+        } else if (keyword == "@t-relation-loadtime" || keyword == "@t-relation-savetime") {
+            category = "io";
+            name = field(1) + " " + field(3);
+        } else if (keyword == "@runtime") {
+            category = "program";
+            name = "runtime";
+        } else {
+            category = "other";
+            name = keyword;
+        }
+
+        threads.insert(thread);
+        events.push_back(json11::Json::object{{"name", name}, {"cat", category}, {"ph", "X"},
+                {"ts", (long long)start.count()}, {"dur", (long long)(end - start).count()}, {"pid", 1LL},
+                {"tid", (long long)thread}, {"args", args}});
+        addCounter("maxRSS", end, "kB", endMaxRSS);
+    }
+
+    /** Add a sample of the resource utilisation */
+    void addUtilisation(microseconds time, std::size_t maxRSS) {
+        addCounter("maxRSS", time, "kB", maxRSS);
+    }
+
+    /** Write the trace */
+    void print(std::ostream& os) const {
+        json11::Json::array all;
+        for (std::size_t thread : threads) {
+            all.push_back(json11::Json::object{{"name", "thread_name"}, {"ph", "M"}, {"pid", 1LL},
+                    {"tid", (long long)thread},
+                    {"args", json11::Json::object{{"name", "thread " + std::to_string(thread)}}}});
+        }
+        all.insert(all.end(), events.begin(), events.end());
+        os << json11::Json(json11::Json::object{{"traceEvents", all}, {"displayTimeUnit", "ms"}}).dump()
+           << std::endl;
+    }
+
+private:
+    /** trace events in the order they were added */
+    std::vector<json11::Json> events;
+
+    /** threads that recorded spans */
+    std::set<std::size_t> threads;
+
+    /** number of tuples of each relation so far */
+    std::map<std::string, std::size_t> relationSizes;
+
+    void addCounter(const std::string& name, microseconds time, const std::string& key, std::size_t value) {
+        events.push_back(json11::Json::object{{"name", name}, {"ph", "C"}, {"ts", (long long)time.count()},
+                {"pid", 1LL}, {"args", json11::Json::object{{key, (long long)value}}}});
+    }
+
+    void addRelationSize(const std::string& relation, microseconds time, std::size_t newTuples) {
+        std::size_t& size = relationSizes[relation];
+        size += newTuples;
+        addCounter("size " + relation, time, "tuples", size);
+    }
+};
+
+}  // namespace profile
+}  // namespace souffle
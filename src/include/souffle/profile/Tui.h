@@ -696,7 +696,8 @@ public:
         std::printf("  %-30s%-5s %s\n", "rel", "-", "display relation table.");
         std::printf("  %-30s%-5s %s\n", "rel <relation id>", "-", "display all rules of a given relation.");
         std::printf("  %-30s%-5s %s\n", "rul", "-", "display rule table");
-        std::printf("  %-30s%-5s %s\n", "rul <rule id>", "-", "display all version of given rule.");
+        std::printf("  %-30s%-5s %s\n", "rul <rule id>", "-",
+                "display all version and performance counters of given rule.");
         std::printf("  %-30s%-5s %s\n", "rul id", "-", "display all rules names and ids.");
         std::printf(
                 "  %-30s%-5s %s\n", "rul id <rule id>", "-", "display the rule name for the given rule id.");
@@ -1225,6 +1226,7 @@ public:
             } else if (formattedRuleTable.size() > 0) {
                 std::cout << "Src locator-: " << formattedRuleTable[0][10] << "\n\n";
             }
+            verCounters(strRel, str);
         }
 
         // Print out the versions of this rule.
@@ -1255,6 +1257,29 @@ public:
         verAtoms(atom_table, ruleName);
     }
 
+    void verCounters(const std::string& strRel, const std::string& strRul) {
+        std::map<std::string, std::size_t> counters = out.getCounters(strRel, strRul);
+        if (counters.empty()) {
+            return;
+        }
+        std::cout << "  ----- Performance Counters -----\n";
+        for (auto& counter : counters) {
+            std::printf("%18s%10s\n", counter.first.c_str(),
+                    Tools::formatNum(precision, static_cast<int64_t>(counter.second)).c_str());
+        }
+        // ratios telling cache-bound from compute-bound evaluations
+        auto ratio = [&](const std::string& label, const std::string& num, const std::string& den) {
+            if (counters.count(num) > 0 && counters.count(den) > 0 && counters[den] > 0) {
+                std::printf("%18s%10.2f\n", label.c_str(),
+                        static_cast<double>(counters[num]) / static_cast<double>(counters[den]));
+            }
+        };
+        ratio("IPC", "instructions", "cycles");
+        ratio("cache-miss-rate", "cache-misses", "cache-references");
+        ratio("scanned/produced", "tuples-scanned", "tuples-produced");
+        std::cout << "\n";
+    }
+
     void iterRel(std::string c, std::string col) {
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
         std::vector<std::vector<std::string>> table = Tools::formatTable(relationTable, -1);
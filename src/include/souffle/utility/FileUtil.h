@@ -35,6 +35,8 @@
 // -------------------------------------------------------------------------------
 
 #ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #else
 #define NOMINMAX
@@ -360,4 +362,63 @@ public:
     }
 };
 
+/**
+ * A read-only memory mapping of the content of a file.
+ *
+ * Nothing is mapped if the file is not a non-empty regular file or if the
+ * platform does not support mappings; readers fall back to streams then.
+ */
+class MappedFile {
+public:
+    MappedFile(const std::string& name) {
+#ifndef _WIN32
+        int fd = ::open(name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* addr = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                ::madvise(addr, info.st_size, MADV_SEQUENTIAL);
+                base = static_cast<const char*>(addr);
+                length = info.st_size;
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (base != nullptr) {
+            ::munmap(const_cast<char*>(base), length);
+        }
+#endif
+    }
+
+    bool isMapped() const {
+        return base != nullptr;
+    }
+
+    const char* begin() const {
+        return base;
+    }
+
+    const char* end() const {
+        return base + length;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+private:
+    const char* base = nullptr;
+    std::size_t length = 0;
+};
+
 }  // namespace souffle
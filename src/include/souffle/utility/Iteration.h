@@ -176,6 +176,13 @@ public:
         return f(iter[ii]);
     }
 
+    /* Splits the range up to the given end if the nested iterator supports it. */
+    template <typename I = Iter,
+            typename = decltype(std::declval<const I&>().split(std::declval<const I&>()))>
+    TransformIterator split(const TransformIterator& end) const {
+        return TransformIterator(iter.split(end.iter), fun);
+    }
+
 private:
     /* The nested iterator. */
     Iter iter;
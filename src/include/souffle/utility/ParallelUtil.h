@@ -17,11 +17,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <memory>
 #include <new>
+#include <vector>
 
 // https://bugs.llvm.org/show_bug.cgi?id=41423
 #if defined(__cpp_lib_hardware_interference_size) && (__cpp_lib_hardware_interference_size != 201703L)
@@ -75,17 +81,20 @@ constexpr std::size_t hardware_destructive_interference_size = 2 * sizeof(max_al
 #define task_spawn
 #define task_sync
 
-// section start / end => corresponding OpenMP pragmas
-// NOTE: disabled since it causes performance losses
-// #define SECTIONS_START _Pragma("omp parallel sections") {
-// NOTE: we stick to flat-level parallelism since it is faster due to thread pooling
-#define SECTIONS_START {
-#define SECTIONS_END }
+// section start / end => the sections are collected and run as concurrent branches
+// NOTE: OpenMP parallel sections caused performance losses since the nested parallel
+//       regions inside of the sections created their own full-sized teams; the
+//       branches share the threads of the current team instead
+#define SECTIONS_START {                                        \
+    std::vector<std::function<void()>> souffleSections;
+#define SECTIONS_END                                                                             \
+    ::souffle::runParallelBranches(souffleSections.size(), static_cast<std::size_t>(MAX_THREADS), \
+            [&](std::size_t souffleSection) { souffleSections[souffleSection](); });             \
+    }
 
 // the markers for a single section
-// #define SECTION_START _Pragma("omp section") {
-#define SECTION_START {
-#define SECTION_END }
+#define SECTION_START souffleSections.emplace_back([&]() {
+#define SECTION_END });
 
 // a macro to create an operation context
 #define CREATE_OP_CONTEXT(NAME, INIT) [[maybe_unused]] auto NAME = INIT;
@@ -873,6 +882,119 @@ struct ConcurrentLanes : protected SeqConcurrentLanes {
 
 #endif
 
+/**
+ * Runs the given number of independent branches concurrently and waits until
+ * all of them have completed.
+ *
+ * The branches are distributed over a team of at most numThreads threads. The
+ * remaining threads are shared evenly among the branches such that the parallel
+ * regions nested inside of a branch still run in parallel, without creating more
+ * than numThreads threads in total. Inside of an active parallel region, or if
+ * only one thread is available, the branches are executed in sequence.
+ */
+template <typename Branch>
+void runParallelBranches(const std::size_t numBranches, const std::size_t numThreads, Branch&& branch) {
+#if defined _OPENMP && _OPENMP >= 200805
+    if (numThreads > 1 && numBranches > 1 && omp_get_active_level() == 0) {
+        const std::size_t teamSize = std::min(numBranches, numThreads);
+        const int threadsPerBranch = static_cast<int>(std::max<std::size_t>(1, numThreads / teamSize));
+        const int maxActiveLevels = omp_get_max_active_levels();
+
+        omp_set_max_active_levels(2);
+#pragma omp parallel num_threads(static_cast<int>(teamSize))
+        {
+            omp_set_num_threads(threadsPerBranch);
+#pragma omp for schedule(dynamic)
+            for (std::size_t i = 0; i < numBranches; ++i) {
+                branch(i);
+            }
+        }
+        omp_set_max_active_levels(maxActiveLevels);
+        return;
+    }
+#else
+    (void)numThreads;
+#endif
+    for (std::size_t i = 0; i < numBranches; ++i) {
+        branch(i);
+    }
+}
+
+/**
+ * Locks for keys, in stripes chosen by a hash of the key, such that threads only
+ * wait for each other when their keys fall into the same stripe. A lease holds
+ * the stripes of several keys at once, which are acquired in ascending order.
+ */
+class StripedLock {
+public:
+    static constexpr std::size_t Stripes = 64;
+
+    /** A set of stripes, one bit per stripe */
+    using StripeSet = std::uint64_t;
+
+    /** The set of all stripes, to exclude all other threads */
+    static constexpr StripeSet AllStripes = ~StripeSet(0);
+
+    class Lease {
+    public:
+        Lease(StripedLock& lock, StripeSet stripes) : lock(&lock), stripes(stripes) {
+            forEach([&](std::size_t i) { lock.stripes[i].lock(); });
+        }
+        Lease(Lease&& other) : lock(other.lock), stripes(other.stripes) {
+            other.stripes = 0;
+        }
+        Lease(const Lease& other) = delete;
+        ~Lease() {
+            forEach([&](std::size_t i) { lock->stripes[i].unlock(); });
+        }
+
+    private:
+        template <typename F>
+        void forEach(const F& f) const {
+            for (std::size_t i = 0; i < Stripes && (stripes >> i) != 0; ++i) {
+                if (((stripes >> i) & 1) != 0) {
+                    f(i);
+                }
+            }
+        }
+
+        StripedLock* lock;
+        StripeSet stripes;
+    };
+
+    /** The hash of a key without values */
+    static constexpr std::uint64_t EmptyHash = 0xcbf29ce484222325ULL;
+
+    /** Combines the hash of the values of a key so far with its next value */
+    template <typename T>
+    static std::uint64_t hash(std::uint64_t seed, T value) {
+        return (seed ^ static_cast<std::uint64_t>(value)) * 0x100000001b3ULL;
+    }
+
+    /** The stripe of a key with the given hash */
+    static StripeSet stripe(std::uint64_t hash) {
+        return StripeSet(1) << ((hash ^ (hash >> 32)) % Stripes);
+    }
+
+    /** The stripe of a key with the given values */
+    template <typename T>
+    static StripeSet stripe(std::initializer_list<T> key) {
+        std::uint64_t res = EmptyHash;
+        for (const auto& value : key) {
+            res = hash(res, value);
+        }
+        return stripe(res);
+    }
+
+    /** Acquires the given stripes for the life-cycle of the returned lease */
+    Lease acquire(StripeSet stripes) {
+        return Lease(*this, stripes);
+    }
+
+private:
+    std::array<Lock, Stripes> stripes;
+};
+
 /**
  * Obtains a reference to the lock synchronizing output operations.
  */
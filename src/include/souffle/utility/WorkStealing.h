@@ -0,0 +1,220 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WorkStealing.h
+ *
+ * Distribution of the tuples of a parallel scan among the threads of
+ * a parallel region by work stealing
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/Iteration.h"
+#include "souffle/utility/ParallelUtil.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+namespace detail {
+
+/**
+ * Tests whether ranges of the given iterator type can be split up, i.e.,
+ * whether the iterator provides a split(end) member function.
+ */
+template <typename Iter, typename = void>
+struct is_splittable : std::false_type {};
+
+template <typename Iter>
+struct is_splittable<Iter,
+        std::void_t<decltype(std::declval<const Iter&>().split(std::declval<const Iter&>()))>>
+        : std::true_type {};
+
+}  // namespace detail
+
+/**
+ * A work-stealing scheduler for the parallel iteration over a range.
+ *
+ * The range is handed in as a list of chunks, which are distributed among the
+ * threads of the parallel region as consecutive shares. Each thread consumes its
+ * share in small pieces. A thread running out of work steals the back half of the
+ * pending chunks of another thread or, if that thread has a single chunk left,
+ * the back half of the remainder of that chunk. The latter requires iterators
+ * that can split a range (see btree::iterator::split); for other iterators only
+ * whole chunks are stolen.
+ *
+ * Usage within a parallel region:
+ *
+ *      WorkStealingRange part(chunks);
+ *      PARALLEL_START
+ *          while (auto it = part.next()) {
+ *              for (const auto& tuple : *it) { ... }
+ *          }
+ *      PARALLEL_END
+ */
+template <typename Iter>
+class WorkStealingRange {
+public:
+    using chunk = range<Iter>;
+
+    /** The number of elements a thread takes from its own share at a time */
+    static constexpr std::size_t PieceSize = 64;
+
+    /** The number of chunks per thread a range is partitioned into if it cannot be split */
+    static constexpr std::size_t ChunksPerThread = 20;
+
+    /**
+     * Distributes the given chunks among the given number of threads.
+     */
+    WorkStealingRange(const std::vector<chunk>& chunks, std::size_t numThreads = MAX_THREADS)
+            : workers(std::max<std::size_t>(numThreads, 1)) {
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            if (!chunks[i].empty()) {
+                workers[i * workers.size() / chunks.size()].pending.push_back(chunks[i]);
+            }
+        }
+    }
+
+    /**
+     * Distributes the given range among the given number of threads, splitting
+     * it up front if possible and partitioning it otherwise.
+     */
+    WorkStealingRange(chunk whole, std::size_t numThreads = MAX_THREADS)
+            : WorkStealingRange(distribute(std::move(whole), numThreads), numThreads) {}
+
+    /**
+     * Obtains the next piece of work for the calling thread.
+     *
+     * @return a non-empty part of the range, or nothing once the range is exhausted
+     */
+    std::optional<chunk> next() {
+        Worker& self = workers[getThreadNum() % workers.size()];
+        do {
+            if (auto piece = take(self)) {
+                return piece;
+            }
+        } while (steal(self));
+        return std::nullopt;
+    }
+
+private:
+    static constexpr bool splittable = detail::is_splittable<Iter>::value;
+
+    /** The work of a single thread; the front chunk is being consumed */
+    struct alignas(hardware_destructive_interference_size) Worker {
+        SpinLock lock;
+        std::deque<chunk> pending;
+    };
+
+    std::vector<Worker> workers;
+
+    static std::size_t getThreadNum() {
+#ifdef _OPENMP
+        return static_cast<std::size_t>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    /** Splits the given range at its middle; returns its end if it cannot be split */
+    static Iter split(const chunk& cur) {
+        if constexpr (splittable) {
+            return cur.begin().split(cur.end());
+        } else {
+            return cur.end();
+        }
+    }
+
+    static std::vector<chunk> distribute(chunk whole, std::size_t numThreads) {
+        if constexpr (splittable) {
+            std::vector<chunk> res{std::move(whole)};
+            bool progress = true;
+            while (progress && res.size() < numThreads) {
+                progress = false;
+                std::vector<chunk> halves;
+                for (const auto& cur : res) {
+                    auto mid = split(cur);
+                    if (mid != cur.end()) {
+                        halves.push_back({cur.begin(), mid});
+                        progress = true;
+                    }
+                    halves.push_back({mid == cur.end() ? cur.begin() : mid, cur.end()});
+                }
+                res.swap(halves);
+            }
+            return res;
+        } else {
+            return whole.partition(std::max<std::size_t>(numThreads, 1) * ChunksPerThread);
+        }
+    }
+
+    /** Takes a piece from the front of the own share */
+    std::optional<chunk> take(Worker& self) {
+        std::lock_guard<SpinLock> guard(self.lock);
+        if (self.pending.empty()) {
+            return std::nullopt;
+        }
+        chunk& cur = self.pending.front();
+        Iter end = cur.begin();
+        for (std::size_t i = 0; i < PieceSize && end != cur.end(); ++i) {
+            ++end;
+        }
+        chunk piece(cur.begin(), end);
+        if (end == cur.end()) {
+            self.pending.pop_front();
+        } else {
+            cur.begin() = end;
+        }
+        return piece;
+    }
+
+    /** Moves work of another thread to the own share; returns false if there is none left */
+    bool steal(Worker& self) {
+        const std::size_t first = static_cast<std::size_t>(&self - workers.data());
+        for (std::size_t i = 1; i < workers.size(); ++i) {
+            Worker& victim = workers[(first + i) % workers.size()];
+            std::vector<chunk> loot;
+            {
+                std::lock_guard<SpinLock> guard(victim.lock);
+                auto& pending = victim.pending;
+                if (pending.size() > 1) {
+                    for (std::size_t n = pending.size() / 2; n > 0; --n) {
+                        loot.push_back(pending.back());
+                        pending.pop_back();
+                    }
+                    std::reverse(loot.begin(), loot.end());
+                } else if (pending.size() == 1) {
+                    chunk& cur = pending.front();
+                    auto mid = split(cur);
+                    if (mid != cur.end()) {
+                        loot.push_back({mid, cur.end()});
+                        cur.end() = mid;
+                    }
+                }
+            }
+            if (!loot.empty()) {
+                std::lock_guard<SpinLock> guard(self.lock);
+                self.pending.insert(self.pending.end(), loot.begin(), loot.end());
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace souffle
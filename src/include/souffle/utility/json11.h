@@ -445,7 +445,7 @@ class JsonInt final : public Value<Json::NUMBER, long long> {
     }
 
 public:
-    explicit JsonInt(int value) : Value(value) {}
+    explicit JsonInt(long long value) : Value(value) {}
 };
 
 class JsonBoolean final : public Value<Json::BOOL, bool> {
@@ -0,0 +1,181 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Arena.h
+ *
+ * Defines a bump allocator for the temporaries of the interpreter
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/Types.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace souffle::interpreter {
+
+/**
+ * A bump allocator for the temporaries of the evaluation
+ *
+ * Memory is handed out from large blocks in stack order: a mark records the
+ * current position, and releasing the mark reclaims everything allocated after
+ * it. Reclaimed blocks are kept for reuse, up to a bound, so the evaluation
+ * does not hit malloc once the arena has warmed up, while the memory of a
+ * temporary peak is returned.
+ *
+ * The arena does not run destructors; objects that need them are destroyed
+ * through ArenaOwn before their memory is reclaimed. Each thread has its own
+ * arena (see Arena::local()).
+ */
+class Arena {
+public:
+    /** The default size of a block in bytes */
+    static constexpr std::size_t BlockSize = 64 * 1024;
+
+    /** The number of unused blocks kept for reuse */
+    static constexpr std::size_t RetainedBlocks = 4;
+
+    /** A position within the arena */
+    struct Mark {
+        std::size_t block;
+        std::size_t offset;
+    };
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /** @brief Allocate uninitialised memory of the given size */
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        assert(alignment <= alignof(std::max_align_t) && "over-aligned allocation");
+        std::size_t start = (offset + alignment - 1) & ~(alignment - 1);
+        if (blocks.empty() || start + size > blocks[current].size) {
+            nextBlock(size);
+            start = 0;
+        }
+        offset = start + size;
+        return blocks[current].data.get() + start;
+    }
+
+    /** @brief Allocate an uninitialised array of trivial values */
+    template <typename T>
+    T* allocate(std::size_t n) {
+        static_assert(std::is_trivially_destructible_v<T>, "values are never destroyed");
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /** @brief Construct an object in the arena */
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /** @brief Obtain the current position */
+    Mark mark() const {
+        return {current, offset};
+    }
+
+    /** @brief Reclaim all memory allocated after the given mark */
+    void release(const Mark& m) {
+        current = m.block;
+        offset = m.offset;
+        if (blocks.size() > current + 1 + RetainedBlocks) {
+            blocks.resize(current + 1 + RetainedBlocks);
+        }
+    }
+
+    /** @brief Obtain the number of bytes held by the arena */
+    std::size_t capacity() const {
+        std::size_t res = 0;
+        for (const auto& block : blocks) {
+            res += block.size;
+        }
+        return res;
+    }
+
+    /** @brief Obtain the arena of the calling thread */
+    static Arena& local() {
+        static thread_local Arena arena;
+        return arena;
+    }
+
+    /**
+     * Reclaims the memory allocated during its lifetime
+     */
+    class Scope {
+    public:
+        Scope(Arena& arena) : arena(arena), start(arena.mark()) {}
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() {
+            arena.release(start);
+        }
+
+    private:
+        Arena& arena;
+        const Mark start;
+    };
+
+    /**
+     * Stands in for a scope where the temporaries are not allocated in an arena
+     */
+    class NoScope {
+    public:
+        NoScope(Arena&) {}
+    };
+
+private:
+    struct Block {
+        Own<char[]> data;
+        std::size_t size;
+    };
+
+    /** Blocks, of which the ones after the current block are unused */
+    std::vector<Block> blocks;
+    std::size_t current = 0;
+    /** Position of the next allocation within the current block */
+    std::size_t offset = 0;
+
+    /** Continue with the next block holding at least the given number of bytes */
+    void nextBlock(std::size_t size) {
+        if (!blocks.empty()) {
+            ++current;
+        }
+        const std::size_t blockSize = std::max(BlockSize, size);
+        if (current == blocks.size()) {
+            blocks.push_back({Own<char[]>(new char[blockSize]), blockSize});
+        } else if (blocks[current].size < size) {
+            blocks[current] = {Own<char[]>(new char[blockSize]), blockSize};
+        }
+    }
+};
+
+/**
+ * Destroys an object created in an arena without reclaiming its memory
+ */
+struct ArenaDelete {
+    template <typename T>
+    void operator()(T* object) const {
+        object->~T();
+    }
+};
+
+/** An owning pointer to an object created in an arena */
+template <typename T>
+using ArenaOwn = std::unique_ptr<T, ArenaDelete>;
+
+}  // namespace souffle::interpreter
@@ -16,30 +16,141 @@
 
 #pragma once
 
+#include "interpreter/Arena.h"
 #include "interpreter/Index.h"
 #include "interpreter/Relation.h"
 #include "souffle/RamTypes.h"
+#include "souffle/utility/Iteration.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
 namespace souffle::interpreter {
 
+/**
+ * Tuples deferred for insertion, stored one after another, per target relation
+ */
+using InsertBuffers = std::map<RelationWrapper*, std::vector<RamDomain>>;
+
+/**
+ * Collects the insert buffers of all threads evaluating a parallel query
+ */
+class InsertBufferPool {
+public:
+    /** @brief Move the given buffers into the pool */
+    void merge(InsertBuffers& buffers) {
+        auto lease = lock.acquire();
+        for (auto& [rel, tuples] : buffers) {
+            auto& target = pool[rel];
+            target.insert(target.end(), tuples.begin(), tuples.end());
+        }
+        buffers.clear();
+    }
+
+    /** @brief Insert all pooled tuples into their relations */
+    void flush() {
+        for (auto& [rel, tuples] : pool) {
+            rel->insertBatch(tuples);
+        }
+        pool.clear();
+    }
+
+private:
+    Lock lock;
+    InsertBuffers pool;
+};
+
+/**
+ * Shares the iterations of a loop among threads that all traverse it
+ *
+ * The first thread reaching the loop partitions its range up front; all threads
+ * then claim pieces of that range until they are exhausted. A break in any
+ * thread ends the loop for all of them.
+ */
+class LoopSplitter {
+public:
+    /** The number of pieces per thread the range of the loop is partitioned into */
+    static constexpr std::size_t PiecesPerThread = 20;
+
+    /** @brief Obtain the shared pieces of the given range, partitioned by the first caller */
+    template <typename Iter>
+    const std::vector<range<Iter>>& distribute(range<Iter> tuples, std::size_t numThreads) {
+        std::call_once(distributed, [&]() {
+            work = std::make_shared<std::vector<range<Iter>>>(
+                    tuples.partition(std::max<std::size_t>(numThreads, 1) * PiecesPerThread));
+        });
+        return *static_cast<const std::vector<range<Iter>>*>(work.get());
+    }
+
+    /** @brief Claim the next unclaimed piece, returning its index */
+    std::size_t claim() {
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** @brief Stop the loop in all threads */
+    void stop() {
+        stopped.store(true, std::memory_order_relaxed);
+    }
+
+    /** @brief Whether some thread stopped the loop */
+    bool isStopped() const {
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::once_flag distributed;
+    std::shared_ptr<void> work;
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> stopped{false};
+};
+
+class Node;
+
 /**
  * Evaluation context for Interpreter operations
  */
 class Context {
-    using ViewPtr = Own<ViewWrapper>;
+    using ViewPtr = RelationWrapper::IndexViewPtr;
 
 public:
-    Context(std::size_t size = 0) : data(size) {}
+    Context(std::size_t size = 0) : data(size), arena(Arena::local()), start(arena.mark()) {}
 
     /** This constructor is used when program enter a new scope.
-     * Only Subroutine value needs to be copied */
-    Context(Context& ctxt) : returnValues(ctxt.returnValues), args(ctxt.args) {}
-    virtual ~Context() = default;
+     * Only Subroutine values and variables need to be copied */
+    Context(Context& ctxt)
+            : data(ctxt.data.size()), returnValues(ctxt.returnValues), args(ctxt.args),
+              variables(ctxt.variables), bufferPool(ctxt.bufferPool), arena(Arena::local()),
+              start(arena.mark()) {}
+    virtual ~Context() {
+        flushInsertBuffers();
+        views.clear();
+        arena.release(start);
+    }
+
+    /**
+     * Releases the views and temporaries created during its lifetime, e.g., by a query
+     */
+    class Scope {
+    public:
+        Scope(Context& ctxt) : ctxt(ctxt), start(ctxt.arena.mark()) {}
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() {
+            ctxt.views.clear();
+            ctxt.arena.release(start);
+        }
+
+    private:
+        Context& ctxt;
+        const Arena::Mark start;
+    };
 
     const RamDomain*& operator[](std::size_t index) {
         if (index >= data.size()) {
@@ -53,13 +164,14 @@ public:
     }
 
     /** @brief Allocate a tuple.
-     *  allocatedDataContainer has the ownership of those tuples. */
+     *  The tuple lives in the arena of this context until the enclosing scope ends. */
     RamDomain* allocateNewTuple(std::size_t size) {
-        Own<RamDomain[]> newTuple(new RamDomain[size]);
-        allocatedDataContainer.push_back(std::move(newTuple));
+        return arena.allocate<RamDomain>(size);
+    }
 
-        // Return the reference as raw pointer.
-        return allocatedDataContainer.back().get();
+    /** @brief Get the arena holding the temporaries of this context */
+    Arena& getArena() {
+        return arena;
     }
 
     /** @brief Get subroutine return value */
@@ -96,11 +208,10 @@ public:
 
     /** @brief Create a view in the environment */
     void createView(const RelationWrapper& rel, std::size_t indexPos, std::size_t viewPos) {
-        ViewPtr view;
         if (views.size() < viewPos + 1) {
             views.resize(viewPos + 1);
         }
-        views[viewPos] = rel.createView(indexPos);
+        views[viewPos] = rel.createView(indexPos, arena);
     }
 
     /** @brief Return a view */
@@ -109,6 +220,38 @@ public:
         return views[id].get();
     }
 
+    /** @brief Set the pool receiving the insert buffers, returning the previous one */
+    InsertBufferPool* setInsertBufferPool(InsertBufferPool* pool) {
+        std::swap(bufferPool, pool);
+        return pool;
+    }
+
+    /** @brief Defer the insertion of a tuple until the insert buffers are flushed */
+    template <typename Tuple>
+    void bufferInsert(RelationWrapper* rel, const Tuple& tuple) {
+        assert(bufferPool != nullptr && "no insert buffer pool");
+        auto& buffer = insertBuffers[rel];
+        buffer.insert(buffer.end(), tuple.begin(), tuple.end());
+    }
+
+    /** @brief Hand the insert buffers of this context over to the pool */
+    void flushInsertBuffers() {
+        if (bufferPool != nullptr && !insertBuffers.empty()) {
+            bufferPool->merge(insertBuffers);
+        }
+    }
+
+    /** @brief Share the iterations of the given loop with the other threads through the splitter */
+    void setLoopSplitter(const Node* loop, LoopSplitter* loopSplitter) {
+        splitLoop = loop;
+        splitter = loopSplitter;
+    }
+
+    /** @brief Return the splitter if the iterations of the given loop are shared, otherwise null */
+    LoopSplitter* getLoopSplitter(const Node* loop) const {
+        return loop == splitLoop ? splitter : nullptr;
+    }
+
     RamDomain getVariable(const std::string& name) {
         return variables[name];
     }
@@ -124,11 +267,20 @@ private:
     std::vector<RamDomain>* returnValues = nullptr;
     /** @brief Subroutine arguments */
     const std::vector<RamDomain>* args = nullptr;
-    /** @bref Allocated data */
-    VecOwn<RamDomain[]> allocatedDataContainer;
     /** @brief Views */
-    VecOwn<ViewWrapper> views;
+    std::vector<ViewPtr> views;
     std::map<std::string, RamDomain> variables;
+    /** @brief Pool receiving the insert buffers of parallel queries */
+    InsertBufferPool* bufferPool = nullptr;
+    /** @brief Tuples deferred for insertion by this context */
+    InsertBuffers insertBuffers;
+    /** @brief Loop whose iterations are shared among the threads */
+    const Node* splitLoop = nullptr;
+    LoopSplitter* splitter = nullptr;
+    /** @brief Arena of the thread owning this context, holding its views and tuples */
+    Arena& arena;
+    /** @brief Position of the arena when this context was created */
+    const Arena::Mark start;
 };
 
 }  // namespace souffle::interpreter
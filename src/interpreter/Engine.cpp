@@ -20,6 +20,7 @@
 #include "interpreter/Context.h"
 #include "interpreter/Index.h"
 #include "interpreter/Node.h"
+#include "interpreter/ProgInterface.h"
 #include "interpreter/Relation.h"
 #include "interpreter/ViewContext.h"
 #include "ram/Aggregate.h"
@@ -52,6 +53,7 @@
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
 #include "ram/MergeExtend.h"
+#include "ram/MergeInsert.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
 #include "ram/NumericConstant.h"
@@ -96,10 +98,13 @@
 #include "souffle/io/ReadStream.h"
 #include "souffle/io/WriteStream.h"
 #include "souffle/profile/Logger.h"
+#include "souffle/profile/PerfCounters.h"
 #include "souffle/profile/ProfileEvent.h"
 #include "souffle/utility/EvaluatorUtil.h"
 #include "souffle/utility/ParallelUtil.h"
+#include "souffle/utility/StreamUtil.h"
 #include "souffle/utility/StringUtil.h"
+#include "souffle/utility/WorkStealing.h"
 
 #include <algorithm>
 #include <array>
@@ -118,6 +123,7 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -148,6 +154,12 @@ namespace souffle::interpreter {
 namespace {
 constexpr RamDomain RAM_BIT_SHIFT_MASK = RAM_DOMAIN_SIZE - 1;
 
+/** The number of tuples sampled to estimate the fanout of an index search */
+constexpr std::size_t FANOUT_SAMPLE_SIZE = 4096;
+
+/** The factor by which another plan must be estimated cheaper to replace the current one */
+constexpr double PLAN_SWITCH_FACTOR = 0.75;
+
 #ifdef _OPENMP
 std::size_t number_of_threads(const std::size_t user_specified) {
     if (user_specified > 0) {
@@ -305,6 +317,7 @@ RamDomain callStateless(ExecuteFn&& execute, Context& ctxt, Shadow& shadow, souf
 Engine::Engine(ram::TranslationUnit& tUnit, const std::size_t numberOfThreadsOrZero)
         : tUnit(tUnit), global(tUnit.global()), profileEnabled(global.config().has("profile")),
           frequencyCounterEnabled(global.config().has("profile-frequency")),
+          perfCountersEnabled(global.config().has("profile-counters")),
           numOfThreads(number_of_threads(numberOfThreadsOrZero)),
           isa(tUnit.getAnalysis<ram::analysis::IndexAnalysis>()), recordTable(numOfThreads),
           symbolTable(numOfThreads), regexCache(numOfThreads) {}
@@ -366,12 +379,62 @@ void Engine::createRelation(const ram::Relation& id, const std::size_t idx) {
         res = createEqrelRelation(id, isa.getIndexSelection(id.getName()));
     } else if (id.getRepresentation() == RelationRepresentation::BTREE_DELETE) {
         res = createBTreeDeleteRelation(id, isa.getIndexSelection(id.getName()));
+    } else if (isGenericRelation(global, id)) {
+        res = createGenericRelation(id, isa.getIndexSelection(id.getName()));
     } else {
         res = createBTreeRelation(id, isa.getIndexSelection(id.getName()));
     }
     relations[idx] = mk<RelationHandle>(std::move(res));
 }
 
+std::size_t Engine::selectPlan(const AdaptivePlan& shadow) {
+    // sizes of the relations, which are not constant-time to obtain, by relation
+    std::map<const RelationWrapper*, std::size_t> sizes;
+    auto getSize = [&](const RelationWrapper& rel) {
+        auto pos = sizes.find(&rel);
+        if (pos == sizes.end()) {
+            pos = sizes.emplace(&rel, rel.size()).first;
+        }
+        return pos->second;
+    };
+
+    // the number of tuples a step visits for each tuple of the enclosing steps
+    auto getFanout = [&](const AdaptivePlan::Step& step) {
+        const RelationWrapper& rel = **step.relation;
+        const std::size_t size = getSize(rel);
+        if (step.boundColumns == 0 || size == 0) {
+            return static_cast<double>(size);
+        }
+        // sample the index again once the relation has grown or shrunk considerably
+        if (size > 2 * step.sampledSize || 2 * size < step.sampledSize) {
+            step.fanout = rel.estimateFanout(step.indexPos, step.boundColumns, FANOUT_SAMPLE_SIZE);
+            step.sampledSize = size;
+        }
+        return step.fanout;
+    };
+
+    // the cost of a plan is the number of index searches and visited tuples
+    const std::size_t numPlans = shadow.getChildren().size();
+    std::vector<double> costs(numPlans, 0.0);
+    for (std::size_t plan = 0; plan < numPlans; ++plan) {
+        double tuples = 1.0;
+        for (const auto& step : shadow.getSteps(plan)) {
+            const double fanout = getFanout(step);
+            costs[plan] += tuples * (1.0 + fanout);
+            tuples *= step.single ? std::min(1.0, fanout) : fanout;
+        }
+    }
+
+    // ties are resolved in favour of the plan chosen at compile time
+    const auto cheapest = std::min_element(costs.begin(), costs.end());
+    const auto best = static_cast<std::size_t>(std::distance(costs.begin(), cheapest));
+    const std::size_t current = shadow.getCurrentPlan();
+    if (current < numPlans && costs[best] >= PLAN_SWITCH_FACTOR * costs[current]) {
+        return current;
+    }
+    return best;
+}
+
 const std::vector<void*>& Engine::loadDLL() {
     if (!dll.empty()) {
         return dll;
@@ -451,6 +514,9 @@ void Engine::executeMain() {
         execute(main.get(), ctxt);
     } else {
         ProfileEventSingleton::instance().setOutputFile(global.config().get("profile"));
+        if (global.config().has("profile-trace")) {
+            ProfileEventSingleton::instance().setTraceFile(global.config().get("profile-trace"));
+        }
         // Prepare the frequency table for threaded use
         const ram::Program& program = tUnit.getProgram();
         visit(program, [&](const ram::TupleOperation& node) {
@@ -462,6 +528,12 @@ void Engine::executeMain() {
         // Enable profiling for execution of main
         ProfileEventSingleton::instance().startTimer();
         ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");
+        // Open the performance counters before the worker threads, which inherit them, are started
+        if (perfCountersEnabled) {
+            profile::PerfCounters::instance().enable();
+            ProfileEventSingleton::instance().makeConfigRecord(
+                    "perf-counters", toString(join(profile::PerfCounters::instance().getNames(), ",")));
+        }
         // Store configuration
         for (auto&& [k, vs] : global.config().data())
             for (auto&& v : vs)
@@ -487,6 +559,13 @@ void Engine::executeMain() {
         Context ctxt;
         execute(main.get(), ctxt);
         ProfileEventSingleton::instance().stopTimer();
+        ProfileEventSingleton::instance().makeConfigRecord(
+                "lockRestarts", std::to_string(souffle::detail::btreeLockRestarts()));
+        const auto symbolCache = symbolTable.getCacheStatistics();
+        ProfileEventSingleton::instance().makeConfigRecord(
+                "symbolCacheHits", std::to_string(symbolCache.hits()));
+        ProfileEventSingleton::instance().makeConfigRecord(
+                "symbolCacheMisses", std::to_string(symbolCache.misses()));
         for (auto const& cur : frequencies) {
             for (std::size_t i = 0; i < cur.second.size(); ++i) {
                 ProfileEventSingleton::instance().makeQuantityEvent(
@@ -514,6 +593,17 @@ void Engine::generateIR() {
     }
 }
 
+void Engine::saveSnapshot(const std::string& filename) {
+    generateIR();
+    ProgInterface(*this).saveSnapshot(filename);
+}
+
+void Engine::loadSnapshot(const std::string& filename) {
+    // relations and program constants are set up by the generation of the IR
+    generateIR();
+    ProgInterface(*this).loadSnapshot(filename);
+}
+
 void Engine::executeSubroutine(
         const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret) {
     Context ctxt;
@@ -871,8 +961,9 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                 }
 #ifdef USE_LIBFFI
                 // prepare dynamic call environment
-                std::unique_ptr<void*[]> values = std::make_unique<void*[]>(arity + 2);
-                std::unique_ptr<RamDomain[]> intVal = std::make_unique<RamDomain[]>(arity);
+                Arena::Scope temporaries(ctxt.getArena());
+                void** values = ctxt.getArena().allocate<void*>(arity + 2);
+                RamDomain* intVal = ctxt.allocateNewTuple(arity);
                 RamDomain rc;
 
                 /* Initialize arguments for ffi-call */
@@ -885,7 +976,7 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                     values[i + 2] = &intVal[i];
                 }
 
-                ffi_call(shadow.getFFIcif(), userFunctor, &rc, values.get());
+                ffi_call(shadow.getFFIcif(), userFunctor, &rc, values);
                 return rc;
 #else
                 fatal("unsupported stateful functor arity without libffi support");
@@ -903,11 +994,12 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
 
 #ifdef USE_LIBFFI
                 // prepare dynamic call environment
-                std::unique_ptr<void*[]> values = std::make_unique<void*[]>(arity);
-                std::unique_ptr<RamSigned[]> intVal = std::make_unique<RamSigned[]>(arity);
-                std::unique_ptr<RamUnsigned[]> uintVal = std::make_unique<RamUnsigned[]>(arity);
-                std::unique_ptr<RamFloat[]> floatVal = std::make_unique<RamFloat[]>(arity);
-                std::unique_ptr<const char*[]> strVal = std::make_unique<const char*[]>(arity);
+                Arena::Scope temporaries(ctxt.getArena());
+                void** values = ctxt.getArena().allocate<void*>(arity);
+                RamSigned* intVal = ctxt.getArena().allocate<RamSigned>(arity);
+                RamUnsigned* uintVal = ctxt.getArena().allocate<RamUnsigned>(arity);
+                RamFloat* floatVal = ctxt.getArena().allocate<RamFloat>(arity);
+                const char** strVal = ctxt.getArena().allocate<const char*>(arity);
 
                 /* Initialize arguments for ffi-call */
                 for (std::size_t i = 0; i < arity; i++) {
@@ -942,7 +1034,7 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                     ffi_arg dummy;  // ensures minium size
                 } rvalue;
 
-                ffi_call(shadow.getFFIcif(), userFunctor, &rvalue, values.get());
+                ffi_call(shadow.getFFIcif(), userFunctor, &rvalue, values);
 
                 switch (cur.getReturnType()) {
                     case TypeAttribute::Signed: return static_cast<RamDomain>(rvalue.s);
@@ -962,11 +1054,12 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
 
         CASE(PackRecord)
             const std::size_t arity = cur.getNumArgs();
-            std::unique_ptr<RamDomain[]> data = std::make_unique<RamDomain[]>(arity);
+            Arena::Scope temporaries(ctxt.getArena());
+            RamDomain* data = ctxt.allocateNewTuple(arity);
             for (std::size_t i = 0; i < arity; ++i) {
                 data[i] = execute(shadow.getChild(i), ctxt);
             }
-            return getRecordTable().pack(data.get(), arity);
+            return getRecordTable().pack(data, arity);
         ESAC(PackRecord)
 
         CASE(SubroutineArgument)
@@ -1131,6 +1224,13 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         CASE(TupleOperation)
             bool result = execute(shadow.getChild(), ctxt);
 
+            if (perfCountersEnabled && shadow.isScan()) {
+                profile::PerfCounters::countTuple();
+            }
+            if (!frequencyCounterEnabled || cur.getProfileText().empty()) {
+                return result;
+            }
+
             auto& currentFrequencies = frequencies[cur.getProfileText()];
             while (currentFrequencies.size() <= getIterationNumber()) {
 #ifdef _OPENMP
@@ -1340,14 +1440,39 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         ESAC(Sequence)
 
         CASE(Parallel)
-            for (const auto& child : shadow.getChildren()) {
-                if (!execute(child.get(), ctxt)) {
-                    return false;
+            const auto& children = shadow.getChildren();
+            if (!shadow.isConcurrent()) {
+                for (const auto& child : children) {
+                    if (!execute(child.get(), ctxt)) {
+                        return false;
+                    }
                 }
+                return true;
             }
-            return true;
+
+            // Run the statements as concurrent branches, each in its own context
+            std::atomic<bool> result{true};
+            runParallelBranches(children.size(), numOfThreads, [&](std::size_t i) {
+                Context branchCtxt(ctxt);
+                if (!execute(children[i].get(), branchCtxt)) {
+                    result = false;
+                }
+            });
+            return result;
         ESAC(Parallel)
 
+        CASE(AdaptivePlan)
+            const std::size_t plan = selectPlan(shadow);
+            if (plan != shadow.getCurrentPlan()) {
+                shadow.setCurrentPlan(plan);
+                if (profileEnabled && !cur.getMessage().empty()) {
+                    ProfileEventSingleton::instance().makeQuantityEvent(
+                            cur.getMessage(), plan, static_cast<int>(getIterationNumber()));
+                }
+            }
+            return execute(shadow.getChild(plan), ctxt);
+        ESAC(AdaptivePlan)
+
         CASE(Loop)
             resetIterationNumber();
 
@@ -1438,6 +1563,8 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         ESAC(IO)
 
         CASE(Query)
+            // the views and temporaries of the query are released once it is done
+            Context::Scope scope(ctxt);
             ViewContext* viewContext = shadow.getViewContext();
 
             // Execute view-free operations in outer filter if any.
@@ -1471,6 +1598,16 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                     ctxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
                 }
             }
+            if (viewContext->hasInsertBuffers) {
+                // Collect the insert buffers of all threads and merge them once the query is done.
+                InsertBufferPool pool;
+                InsertBufferPool* outerPool = ctxt.setInsertBufferPool(&pool);
+                execute(shadow.getChild(), ctxt);
+                ctxt.flushInsertBuffers();
+                ctxt.setInsertBufferPool(outerPool);
+                pool.flush();
+                return true;
+            }
             execute(shadow.getChild(), ctxt);
             return true;
         ESAC(Query)
@@ -1482,6 +1619,13 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
             return true;
         ESAC(MergeExtend)
 
+        CASE(MergeInsert)
+            const auto& src = *getRelationHandle(shadow.getSourceId());
+            auto& trg = *getRelationHandle(shadow.getTargetId());
+            trg.insertAll(src);
+            return true;
+        ESAC(MergeInsert)
+
         CASE(Swap)
             swapRelation(shadow.getSourceId(), shadow.getTargetId());
             return true;
@@ -1503,7 +1647,6 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
 
 template <typename Rel>
 RamDomain Engine::evalExistenceCheck(const ExistenceCheck& shadow, Context& ctxt) {
-    constexpr std::size_t Arity = Rel::Arity;
     std::size_t viewPos = shadow.getViewId();
 
     if (profileEnabled && !shadow.isTemp()) {
@@ -1511,9 +1654,10 @@ RamDomain Engine::evalExistenceCheck(const ExistenceCheck& shadow, Context& ctxt
     }
 
     const auto& superInfo = shadow.getSuperInst();
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
     // for total we use the exists test
     if (shadow.isTotalSearch()) {
-        souffle::Tuple<RamDomain, Arity> tuple;
+        auto tuple = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
         TUPLE_COPY_FROM(tuple, superInfo.first);
         /* TupleElement */
         for (const auto& tupleElement : superInfo.tupleFirst) {
@@ -1527,8 +1671,8 @@ RamDomain Engine::evalExistenceCheck(const ExistenceCheck& shadow, Context& ctxt
     }
 
     // for partial we search for lower and upper boundaries
-    souffle::Tuple<RamDomain, Arity> low;
-    souffle::Tuple<RamDomain, Arity> high;
+    auto low = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
+    auto high = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     TUPLE_COPY_FROM(low, superInfo.first);
     TUPLE_COPY_FROM(high, superInfo.second);
 
@@ -1593,6 +1737,9 @@ RamDomain Engine::evalProvenanceExistenceCheck(const ProvenanceExistenceCheck& s
 
 template <typename Rel>
 RamDomain Engine::evalScan(const Rel& rel, const ram::Scan& cur, const Scan& shadow, Context& ctxt) {
+    if (LoopSplitter* splitter = ctxt.getLoopSplitter(&shadow)) {
+        return evalSplitLoop(rel.scan(), cur.getTupleId(), shadow.getNestedOperation(), *splitter, ctxt);
+    }
     for (const auto& tuple : rel.scan()) {
         ctxt[cur.getTupleId()] = tuple.data();
         if (!execute(shadow.getNestedOperation(), ctxt)) {
@@ -1605,9 +1752,14 @@ RamDomain Engine::evalScan(const Rel& rel, const ram::Scan& cur, const Scan& sha
 template <typename Rel>
 RamDomain Engine::evalParallelScan(
         const Rel& rel, const ram::ParallelScan& cur, const ParallelScan& shadow, Context& ctxt) {
+    if (splitNestedLoop(rel.scan(), cur.getTupleId(), shadow, ctxt)) {
+        return true;
+    }
+
     auto viewContext = shadow.getViewContext();
 
-    auto pStream = rel.partitionScan(numOfThreads * 20);
+    // idle threads steal the remaining work of the others
+    WorkStealingRange pStream(rel.partitionScan(numOfThreads * 20), numOfThreads);
 
     PARALLEL_START
         Context newCtxt(ctxt);
@@ -1615,14 +1767,7 @@ RamDomain Engine::evalParallelScan(
         for (const auto& info : viewInfo) {
             newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
         }
-#if defined _OPENMP && _OPENMP < 200805
-        auto count = std::distance(pStream.begin(), pStream.end());
-        auto b = pStream.begin();
-        pfor(int i = 0; i < count; i++) {
-            auto it = b + i;
-#else
-        pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-#endif
+        while (auto it = pStream.next()) {
             for (const auto& tuple : *it) {
                 newCtxt[cur.getTupleId()] = tuple.data();
                 if (!execute(shadow.getNestedOperation(), newCtxt)) {
@@ -1638,7 +1783,6 @@ template <typename Rel>
 RamDomain Engine::evalEstimateJoinSize(
         const Rel& rel, const ram::EstimateJoinSize& cur, const EstimateJoinSize& shadow, Context& ctxt) {
     (void)ctxt;
-    constexpr std::size_t Arity = Rel::Arity;
     bool onlyConstants = true;
 
     for (auto col : cur.getKeyColumns()) {
@@ -1648,10 +1792,6 @@ RamDomain Engine::evalEstimateJoinSize(
         }
     }
 
-    // save a copy of the columns and index
-    std::vector<std::size_t> keyColumns(cur.getKeyColumns().size());
-    std::iota(keyColumns.begin(), keyColumns.end(), 0);
-
     std::size_t indexPos = shadow.getViewId();
     auto order = rel.getIndexOrder(indexPos);
 
@@ -1662,6 +1802,12 @@ RamDomain Engine::evalEstimateJoinSize(
         inverseOrder[order[i]] = i;
     }
 
+    // the positions of the key columns in the tuples of the index, which lead its order
+    std::vector<std::size_t> keyColumns;
+    for (auto col : cur.getKeyColumns()) {
+        keyColumns.push_back(inverseOrder[col]);
+    }
+
     // create a copy of the map to the real numeric constants
     std::map<std::size_t, RamDomain> keyConstants;
     for (auto [k, constant] : cur.getConstantsMap()) {
@@ -1692,7 +1838,7 @@ RamDomain Engine::evalEstimateJoinSize(
     if (!index->scan().empty()) {
         // assign first tuple as prev as a dummy
         bool first = true;
-        Tuple<RamDomain, Arity> prev = *index->scan().begin();
+        typename Rel::Tuple prev = *index->scan().begin();
 
         for (const auto& tuple : index->scan()) {
             // only if every constant matches do we consider the tuple
@@ -1750,15 +1896,19 @@ RamDomain Engine::evalEstimateJoinSize(
 
 template <typename Rel>
 RamDomain Engine::evalIndexScan(const ram::IndexScan& cur, const IndexScan& shadow, Context& ctxt) {
-    constexpr std::size_t Arity = Rel::Arity;
     // create pattern tuple for range query
     const auto& superInfo = shadow.getSuperInst();
-    souffle::Tuple<RamDomain, Arity> low;
-    souffle::Tuple<RamDomain, Arity> high;
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
+    auto low = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
+    auto high = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     CAL_SEARCH_BOUND(superInfo, low, high);
 
     std::size_t viewId = shadow.getViewId();
     auto view = Rel::castView(ctxt.getView(viewId));
+    if (LoopSplitter* splitter = ctxt.getLoopSplitter(&shadow)) {
+        return evalSplitLoop(
+                view->range(low, high), cur.getTupleId(), shadow.getNestedOperation(), *splitter, ctxt);
+    }
     // conduct range query
     for (const auto& tuple : view->range(low, high)) {
         ctxt[cur.getTupleId()] = tuple.data();
@@ -1775,28 +1925,26 @@ RamDomain Engine::evalParallelIndexScan(
     auto viewContext = shadow.getViewContext();
 
     // create pattern tuple for range query
-    constexpr std::size_t Arity = Rel::Arity;
     const auto& superInfo = shadow.getSuperInst();
-    souffle::Tuple<RamDomain, Arity> low;
-    souffle::Tuple<RamDomain, Arity> high;
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
+    auto low = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
+    auto high = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     CAL_SEARCH_BOUND(superInfo, low, high);
 
     std::size_t indexPos = shadow.getViewId();
-    auto pStream = rel.partitionRange(indexPos, low, high, numOfThreads * 20);
+    if (splitNestedLoop(rel.range(indexPos, low, high), cur.getTupleId(), shadow, ctxt)) {
+        return true;
+    }
+
+    // the range is split up front if its index supports it, and idle threads steal the remaining work
+    WorkStealingRange pStream(rel.range(indexPos, low, high), numOfThreads);
     PARALLEL_START
         Context newCtxt(ctxt);
         auto viewInfo = viewContext->getViewInfoForNested();
         for (const auto& info : viewInfo) {
             newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
         }
-#if defined _OPENMP && _OPENMP < 200805
-        auto count = std::distance(pStream.begin(), pStream.end());
-        auto b = pStream.begin();
-        pfor(int i = 0; i < count; i++) {
-            auto it = b + i;
-#else
-        pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-#endif
+        while (auto it = pStream.next()) {
             for (const auto& tuple : *it) {
                 newCtxt[cur.getTupleId()] = tuple.data();
                 if (!execute(shadow.getNestedOperation(), newCtxt)) {
@@ -1808,6 +1956,67 @@ RamDomain Engine::evalParallelIndexScan(
     return true;
 }
 
+template <typename Range>
+bool Engine::splitNestedLoop(
+        const Range& tuples, std::size_t tupleId, const AbstractParallel& shadow, Context& ctxt) {
+    const Node* loop = shadow.getSplitLoop();
+    if (loop == nullptr || numOfThreads < 2) {
+        return false;
+    }
+
+    // the outer loop keeps the threads busy unless it has only a few tuples
+    const std::size_t limit = numOfThreads * minTuplesPerThread;
+    std::size_t count = 0;
+    for (auto it = tuples.begin(); it != tuples.end() && count < limit; ++it) {
+        ++count;
+    }
+    if (count >= limit) {
+        return false;
+    }
+
+    // every thread traverses all outer tuples and shares the iterations of the nested loop
+    std::vector<LoopSplitter> splitters(count);
+    auto viewContext = shadow.getViewContext();
+    PARALLEL_START
+        Context newCtxt(ctxt);
+        auto viewInfo = viewContext->getViewInfoForNested();
+        for (const auto& info : viewInfo) {
+            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
+        }
+        std::size_t i = 0;
+        for (const auto& tuple : tuples) {
+            newCtxt[tupleId] = tuple.data();
+            newCtxt.setLoopSplitter(loop, &splitters[i]);
+            if (!execute(loop, newCtxt) || ++i == count) {
+                break;
+            }
+        }
+    PARALLEL_END
+    return true;
+}
+
+template <typename Range>
+RamDomain Engine::evalSplitLoop(const Range& tuples, std::size_t tupleId, const Node* nested,
+        LoopSplitter& splitter, Context& ctxt) {
+    using Iter = std::decay_t<decltype(tuples.begin())>;
+    const auto& pieces =
+            splitter.distribute(souffle::range<Iter>(tuples.begin(), tuples.end()), numOfThreads);
+    for (std::size_t i = splitter.claim(); i < pieces.size(); i = splitter.claim()) {
+        for (const auto& tuple : pieces[i]) {
+            // a break ends the whole loop, not just the pieces of the breaking thread
+            if (splitter.isStopped()) {
+                return true;
+            }
+            ctxt[tupleId] = tuple.data();
+            if (!execute(nested, ctxt)) {
+                splitter.stop();
+                return true;
+            }
+        }
+    }
+    return true;
+}
+
 template <typename Rel>
 RamDomain Engine::evalIfExists(
         const Rel& rel, const ram::IfExists& cur, const IfExists& shadow, Context& ctxt) {
@@ -1857,10 +2066,10 @@ RamDomain Engine::evalParallelIfExists(
 template <typename Rel>
 RamDomain Engine::evalIndexIfExists(
         const ram::IndexIfExists& cur, const IndexIfExists& shadow, Context& ctxt) {
-    constexpr std::size_t Arity = Rel::Arity;
     const auto& superInfo = shadow.getSuperInst();
-    souffle::Tuple<RamDomain, Arity> low;
-    souffle::Tuple<RamDomain, Arity> high;
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
+    auto low = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
+    auto high = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     CAL_SEARCH_BOUND(superInfo, low, high);
 
     std::size_t viewId = shadow.getViewId();
@@ -1884,10 +2093,10 @@ RamDomain Engine::evalParallelIndexIfExists(const Rel& rel, const ram::ParallelI
     auto viewInfo = viewContext->getViewInfoForNested();
 
     // create pattern tuple for range query
-    constexpr std::size_t Arity = Rel::Arity;
     const auto& superInfo = shadow.getSuperInst();
-    souffle::Tuple<RamDomain, Arity> low;
-    souffle::Tuple<RamDomain, Arity> high;
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
+    auto low = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
+    auto high = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     CAL_SEARCH_BOUND(superInfo, low, high);
 
     std::size_t indexPos = shadow.getViewId();
@@ -2092,11 +2301,11 @@ RamDomain Engine::evalParallelIndexAggregate(
         newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
     }
     // init temporary tuple for this level
-    constexpr std::size_t Arity = Rel::Arity;
     const auto& superInfo = shadow.getSuperInst();
     // get lower and upper boundaries for iteration
-    souffle::Tuple<RamDomain, Arity> low;
-    souffle::Tuple<RamDomain, Arity> high;
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
+    auto low = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
+    auto high = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     CAL_SEARCH_BOUND(superInfo, low, high);
 
     std::size_t viewId = shadow.getViewId();
@@ -2109,10 +2318,10 @@ template <typename Rel>
 RamDomain Engine::evalIndexAggregate(
         const ram::IndexAggregate& cur, const IndexAggregate& shadow, Context& ctxt) {
     // init temporary tuple for this level
-    const std::size_t Arity = Rel::Arity;
     const auto& superInfo = shadow.getSuperInst();
-    souffle::Tuple<RamDomain, Arity> low;
-    souffle::Tuple<RamDomain, Arity> high;
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
+    auto low = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
+    auto high = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     CAL_SEARCH_BOUND(superInfo, low, high);
 
     std::size_t viewId = shadow.getViewId();
@@ -2123,9 +2332,9 @@ RamDomain Engine::evalIndexAggregate(
 
 template <typename Rel>
 RamDomain Engine::evalInsert(Rel& rel, const Insert& shadow, Context& ctxt) {
-    constexpr std::size_t Arity = Rel::Arity;
     const auto& superInfo = shadow.getSuperInst();
-    souffle::Tuple<RamDomain, Arity> tuple;
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
+    auto tuple = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     TUPLE_COPY_FROM(tuple, superInfo.first);
 
     /* TupleElement */
@@ -2137,6 +2346,14 @@ RamDomain Engine::evalInsert(Rel& rel, const Insert& shadow, Context& ctxt) {
         tuple[expr.first] = execute(expr.second.get(), ctxt);
     }
 
+    if (shadow.isBuffered()) {
+        // defer the insertion to the end of the query unless the tuple is known
+        if (!rel.contains(tuple)) {
+            ctxt.bufferInsert(shadow.getRelation(), tuple);
+        }
+        return true;
+    }
+
     // insert in target relation
     rel.insert(tuple);
     return true;
@@ -2165,13 +2382,9 @@ RamDomain Engine::evalErase(Rel& rel, const Erase& shadow, Context& ctxt) {
 
 template <typename Rel>
 RamDomain Engine::evalGuardedInsert(Rel& rel, const GuardedInsert& shadow, Context& ctxt) {
-    if (!execute(shadow.getCondition(), ctxt)) {
-        return true;
-    }
-
-    constexpr std::size_t Arity = Rel::Arity;
     const auto& superInfo = shadow.getSuperInst();
-    souffle::Tuple<RamDomain, Arity> tuple;
+    typename Rel::TemporaryScope temporaries(ctxt.getArena());
+    auto tuple = Rel::createTuple(ctxt.getArena(), superInfo.first.size());
     TUPLE_COPY_FROM(tuple, superInfo.first);
 
     /* TupleElement */
@@ -2183,6 +2396,20 @@ RamDomain Engine::evalGuardedInsert(Rel& rel, const GuardedInsert& shadow, Conte
         tuple[expr.first] = execute(expr.second.get(), ctxt);
     }
 
+    // another thread must not insert a conflicting tuple between the check and the insertion
+    auto lease = shadow.getLock().acquire(shadow.isSynchronised() ? shadow.getStripes(tuple) : 0);
+    if (!execute(shadow.getCondition(), ctxt)) {
+        return true;
+    }
+
+    if (shadow.isBuffered()) {
+        // defer the insertion to the end of the query unless the tuple is known
+        if (!rel.contains(tuple)) {
+            ctxt.bufferInsert(shadow.getRelation(), tuple);
+        }
+        return true;
+    }
+
     // insert in target relation
     rel.insert(tuple);
     return true;
@@ -66,6 +66,12 @@ public:
     void executeSubroutine(
             const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret);
 
+    /** @brief Save all relations and the symbol and record tables to a snapshot file */
+    void saveSnapshot(const std::string& filename);
+
+    /** @brief Restore relations and the symbol and record tables from a snapshot file */
+    void loadSnapshot(const std::string& filename);
+
     /** @brief Return the global object this engine uses */
     Global& getGlobal();
 
@@ -104,6 +110,8 @@ private:
     VecOwn<RelationHandle>& getRelationMap();
     /** @brief Create and add relation into the runtime environment.  */
     void createRelation(const ram::Relation& id, const std::size_t idx);
+    /** @brief Choose the plan of an adaptive plan to execute from the current relation sizes */
+    std::size_t selectPlan(const AdaptivePlan& shadow);
 
     // -- Defines template for specialized interpreter operation -- */
     template <typename Rel>
@@ -130,6 +138,16 @@ private:
     RamDomain evalParallelIndexScan(const Rel& rel, const ram::ParallelIndexScan& cur,
             const ParallelIndexScan& shadow, Context& ctxt);
 
+    /** Share the iterations of the nested loop among the threads if the given tuples are too few */
+    template <typename Range>
+    bool splitNestedLoop(
+            const Range& tuples, std::size_t tupleId, const AbstractParallel& shadow, Context& ctxt);
+
+    /** Evaluate the pieces of a shared loop taken by the current thread */
+    template <typename Range>
+    RamDomain evalSplitLoop(const Range& tuples, std::size_t tupleId, const Node* nested,
+            LoopSplitter& splitter, Context& ctxt);
+
     template <typename Rel>
     RamDomain evalIfExists(const Rel& rel, const ram::IfExists& cur, const IfExists& shadow, Context& ctxt);
 
@@ -178,12 +196,16 @@ private:
     /** If profile is enable in this program */
     const bool profileEnabled;
     const bool frequencyCounterEnabled;
+    /** If performance counters are sampled for each rule */
+    const bool perfCountersEnabled;
     /** subroutines */
     std::map<std::string /*name*/, Own<Node>> subroutine;
     /** main program */
     Own<Node> main;
     /** Number of threads enabled for this program */
     std::size_t numOfThreads;
+    /** Parallel loops with fewer tuples per thread share the iterations of their nested loop */
+    static constexpr std::size_t minTuplesPerThread = 4;
     /** Profile counter */
     std::atomic<RamDomain> counter{0};
     /** Loop iteration counter */
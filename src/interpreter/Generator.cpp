@@ -289,8 +289,12 @@ NodePtr NodeGenerator::visit_(type_identity<ram::NestedOperation>, const ram::Ne
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::TupleOperation>, const ram::TupleOperation& search) {
-    if (engine.profileEnabled && engine.frequencyCounterEnabled && !search.getProfileText().empty()) {
-        return mk<TupleOperation>(I_TupleOperation, &search, dispatch(search.getOperation()));
+    // the tuples bound by scans are counted along with the performance counters
+    const bool scan =
+            isA<ram::RelationOperation>(search) && !isA<ram::AbstractAggregate, AllowCrossCast>(search);
+    if (engine.profileEnabled && ((engine.frequencyCounterEnabled && !search.getProfileText().empty()) ||
+                                         (engine.perfCountersEnabled && scan))) {
+        return mk<TupleOperation>(I_TupleOperation, &search, dispatch(search.getOperation()), scan);
     }
     return dispatch(search.getOperation());
 }
@@ -310,6 +314,9 @@ NodePtr NodeGenerator::visit_(type_identity<ram::ParallelScan>, const ram::Paral
     NodeType type = constructNodeType(global, "ParallelScan", lookup(pScan.getRelation()));
     auto res = mk<ParallelScan>(type, &pScan, rel, visit_(type_identity<ram::TupleOperation>(), pScan));
     res->setViewContext(parentQueryViewContext);
+    if (isA<ram::Scan>(pScan.getOperation()) || isA<ram::IndexScan>(pScan.getOperation())) {
+        res->setSplitLoop(res->getNestedOperation());
+    }
     return res;
 }
 
@@ -330,6 +337,9 @@ NodePtr NodeGenerator::visit_(type_identity<ram::ParallelIndexScan>, const ram::
     auto res = mk<ParallelIndexScan>(type, &piscan, rel, visit_(type_identity<ram::TupleOperation>(), piscan),
             encodeIndexPos(piscan), std::move(indexOperation));
     res->setViewContext(parentQueryViewContext);
+    if (isA<ram::Scan>(piscan.getOperation()) || isA<ram::IndexScan>(piscan.getOperation())) {
+        res->setSplitLoop(res->getNestedOperation());
+    }
     return res;
 }
 
@@ -498,7 +508,24 @@ NodePtr NodeGenerator::visit_(type_identity<ram::GuardedInsert>, const ram::Guar
     auto rel = getRelationHandle(relId);
     NodeType type = constructNodeType(global, "GuardedInsert", lookup(guardedInsert.getRelation()));
     auto condition = guardedInsert.getCondition();
-    return mk<GuardedInsert>(type, &guardedInsert, rel, std::move(superOp), dispatch(*condition));
+    bool buffered = contains(bufferedRelations, guardedInsert.getRelation());
+    bool synchronised = parentQueryViewContext->isParallel;
+    // the guard looks up existing tuples agreeing with the inserted one on the bound columns
+    std::vector<std::vector<std::size_t>> keys;
+    visit(*condition, [&](const ram::ExistenceCheck& exists) {
+        std::vector<std::size_t> key;
+        const auto& values = exists.getValues();
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (!isUndefValue(values[i])) {
+                key.push_back(i);
+            }
+        }
+        if (!contains(keys, key)) {
+            keys.push_back(std::move(key));
+        }
+    });
+    return mk<GuardedInsert>(type, &guardedInsert, rel, std::move(superOp), buffered, dispatch(*condition),
+            synchronised, std::move(keys));
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Insert>, const ram::Insert& insert) {
@@ -506,7 +533,8 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Insert>, const ram::Insert& ins
     std::size_t relId = encodeRelation(insert.getRelation());
     auto rel = getRelationHandle(relId);
     NodeType type = constructNodeType(global, "Insert", lookup(insert.getRelation()));
-    return mk<Insert>(type, &insert, rel, std::move(superOp));
+    bool buffered = contains(bufferedRelations, insert.getRelation());
+    return mk<Insert>(type, &insert, rel, std::move(superOp), buffered);
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Erase>, const ram::Erase& erase) {
@@ -534,12 +562,44 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Sequence>, const ram::Sequence&
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Parallel>, const ram::Parallel& parallel) {
-    // Parallel statements are executed in sequence for now.
     NodePtrVec children;
     for (const auto& value : parallel.getStatements()) {
         children.push_back(dispatch(*value));
     }
-    return mk<Parallel>(I_Parallel, &parallel, std::move(children));
+    // Loops share the iteration counter and exits/assignments affect the enclosing
+    // statements, so blocks containing them are executed in sequence.
+    bool concurrent = !visitExists(parallel, [](const ram::Node& node) {
+        return isA<ram::Loop>(node) || isA<ram::Exit>(node) || isA<ram::Assign>(node);
+    });
+    return mk<Parallel>(I_Parallel, &parallel, std::move(children), concurrent);
+}
+
+NodePtr NodeGenerator::visit_(type_identity<ram::AdaptivePlan>, const ram::AdaptivePlan& adaptive) {
+    NodePtrVec children;
+    std::vector<std::vector<AdaptivePlan::Step>> steps;
+    for (const auto& plan : adaptive.getStatements()) {
+        children.push_back(dispatch(*plan));
+
+        // Collect the iterations of the plan from the outermost to the innermost one
+        std::vector<AdaptivePlan::Step> planSteps;
+        visit(*plan, [&](const ram::RelationOperation& op) {
+            AdaptivePlan::Step step{getRelationHandle(encodeRelation(op.getRelation())), 0, 0,
+                    isA<ram::AbstractIfExists, AllowCrossCast>(op) ||
+                            isA<ram::AbstractAggregate, AllowCrossCast>(op),
+                    0, 0.0};
+            if (const auto* indexOp = as<ram::IndexOperation>(op)) {
+                step.indexPos = encodeIndexPos(*indexOp);
+                for (auto constraint : engine.isa.getSearchSignature(indexOp)) {
+                    if (constraint == ram::analysis::AttributeConstraint::Equal) {
+                        ++step.boundColumns;
+                    }
+                }
+            }
+            planSteps.push_back(step);
+        });
+        steps.push_back(std::move(planSteps));
+    }
+    return mk<AdaptivePlan>(I_AdaptivePlan, &adaptive, std::move(children), std::move(steps));
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Loop>, const ram::Loop& loop) {
@@ -638,11 +698,19 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Query>, const ram::Query& query
         };
     });
 
-    viewContext->isParallel =
-            visitExists(*next, [&](const Node& n) { return as<ram::AbstractParallel, AllowCrossCast>(n); });
+    viewContext->isParallel = visitExists(
+            *next, [&](const ram::Node& n) { return as<ram::AbstractParallel, AllowCrossCast>(n); });
+
+    // Threads of a parallel query may collect the tuples of relations the query does not read
+    bufferedRelations.clear();
+    if (viewContext->isParallel && global.config().has("insert-buffers")) {
+        bufferedRelations = getBufferableRelations(*next);
+    }
+    viewContext->hasInsertBuffers = !bufferedRelations.empty();
 
     auto res = mk<Query>(I_Query, &query, dispatch(*next));
     res->setViewContext(parentQueryViewContext);
+    bufferedRelations.clear();
     return res;
 }
 
@@ -652,6 +720,12 @@ NodePtr NodeGenerator::visit_(type_identity<ram::MergeExtend>, const ram::MergeE
     return mk<MergeExtend>(I_MergeExtend, &extend, src, target);
 }
 
+NodePtr NodeGenerator::visit_(type_identity<ram::MergeInsert>, const ram::MergeInsert& merge) {
+    std::size_t src = encodeRelation(merge.getSourceRelation());
+    std::size_t target = encodeRelation(merge.getTargetRelation());
+    return mk<MergeInsert>(I_MergeInsert, &merge, src, target);
+}
+
 NodePtr NodeGenerator::visit_(type_identity<ram::Swap>, const ram::Swap& swap) {
     std::size_t src = encodeRelation(swap.getFirstRelation());
     std::size_t target = encodeRelation(swap.getSecondRelation());
@@ -732,6 +806,38 @@ RelationHandle* NodeGenerator::getRelationHandle(const std::size_t idx) {
     return engine.relations[idx].get();
 }
 
+std::set<std::string> NodeGenerator::getBufferableRelations(const ram::Operation& op) {
+    std::set<std::string> inserted;
+    std::set<std::string> accessed;
+    visit(op, [&](const ram::Node& node) {
+        if (const auto* insert = as<ram::Insert>(node)) {
+            inserted.insert(insert->getRelation());
+        } else if (const auto* erase = as<ram::Erase>(node)) {
+            accessed.insert(erase->getRelation());
+        } else if (const auto* scan = as<ram::RelationOperation>(node)) {
+            accessed.insert(scan->getRelation());
+        } else if (const auto* exists = as<ram::AbstractExistenceCheck>(node)) {
+            accessed.insert(exists->getRelation());
+        } else if (const auto* emptiness = as<ram::EmptinessCheck>(node)) {
+            accessed.insert(emptiness->getRelation());
+        } else if (const auto* size = as<ram::RelationSize>(node)) {
+            accessed.insert(size->getRelation());
+        }
+    });
+
+    // only plain b-tree relations support merging a buffer as a whole
+    std::set<std::string> res;
+    for (const auto& name : inserted) {
+        const auto& rel = lookup(name);
+        auto repr = rel.getRepresentation();
+        if (!contains(accessed, name) && rel.getArity() > 0 && rel.getAuxiliaryArity() == 0 &&
+                (repr == RelationRepresentation::DEFAULT || repr == RelationRepresentation::BTREE)) {
+            res.insert(name);
+        }
+    }
+    return res;
+}
+
 bool NodeGenerator::requireView(const ram::Node* node) {
     if (isA<ram::AbstractExistenceCheck>(node)) {
         return true;
@@ -22,9 +22,13 @@
 #include "interpreter/Index.h"
 #include "interpreter/Relation.h"
 #include "interpreter/ViewContext.h"
+#include "ram/AbstractAggregate.h"
 #include "ram/AbstractExistenceCheck.h"
+#include "ram/AbstractIfExists.h"
 #include "ram/AbstractParallel.h"
+#include "ram/AdaptivePlan.h"
 #include "ram/Aggregate.h"
+#include "ram/Assign.h"
 #include "ram/AutoIncrement.h"
 #include "ram/Break.h"
 #include "ram/Call.h"
@@ -53,6 +57,7 @@
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
 #include "ram/MergeExtend.h"
+#include "ram/MergeInsert.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
 #include "ram/NestedOperation.h"
@@ -71,6 +76,7 @@
 #include "ram/ProvenanceExistenceCheck.h"
 #include "ram/Query.h"
 #include "ram/Relation.h"
+#include "ram/RelationOperation.h"
 #include "ram/RelationSize.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
@@ -98,6 +104,7 @@
 #include <map>
 #include <memory>
 #include <queue>
+#include <set>
 #include <string>
 #include <typeinfo>
 #include <unordered_map>
@@ -214,6 +221,8 @@ public:
 
     NodePtr visit_(type_identity<ram::Parallel>, const ram::Parallel& parallel) override;
 
+    NodePtr visit_(type_identity<ram::AdaptivePlan>, const ram::AdaptivePlan& adaptive) override;
+
     NodePtr visit_(type_identity<ram::Loop>, const ram::Loop& loop) override;
 
     NodePtr visit_(type_identity<ram::Exit>, const ram::Exit& exit) override;
@@ -239,6 +248,8 @@ public:
 
     NodePtr visit_(type_identity<ram::MergeExtend>, const ram::MergeExtend& extend) override;
 
+    NodePtr visit_(type_identity<ram::MergeInsert>, const ram::MergeInsert& merge) override;
+
     NodePtr visit_(type_identity<ram::Swap>, const ram::Swap& swap) override;
 
     NodePtr visit_(type_identity<ram::Assign>, const ram::Assign& assign) override;
@@ -328,6 +339,12 @@ private:
      */
     const std::string& getViewRelation(const ram::Node* node);
 
+    /**
+     * @brief Return the relations whose insertions in the given operation can be deferred
+     * to insert buffers, i.e. the relations that are inserted into but not read.
+     */
+    std::set<std::string> getBufferableRelations(const ram::Operation& op);
+
     /**
      * @brief Encode and return the super-instruction information about a index operation.
      */
@@ -356,6 +373,8 @@ private:
      * It is used to passing viewContext between parent query and its nested parallel operation.
      * As parallel operation requires its own view information. */
     std::shared_ptr<ViewContext> parentQueryViewContext = nullptr;
+    /** Relations whose insertions are deferred to insert buffers in the current query */
+    std::set<std::string> bufferedRelations;
     /** Next available location to encode View */
     std::size_t viewId = 0;
     /** Next available location to encode a relation */
@@ -0,0 +1,52 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file GenericIndex.cpp
+ *
+ * Interpreter relations of any arity.
+ *
+ ***********************************************************************/
+
+#include "Global.h"
+#include "RelationTag.h"
+#include "interpreter/Relation.h"
+#include "ram/Relation.h"
+#include "ram/analysis/Index.h"
+#include "souffle/utility/MiscUtil.h"
+
+namespace souffle::interpreter {
+
+Own<RelationWrapper> createGenericRelation(
+        const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection) {
+    assert(id.getArity() > 0 && "Generic relation must not be nullary.");
+    assert(id.getAuxiliaryArity() == 0 && "Generic relation must have auxiliary arity size 0.");
+    return mk<GenericRelation>(id.getArity(), id.getName(), indexSelection);
+}
+
+#define IS_BTREE_ARITY(Structure, Arity, AuxiliaryArity, ...) \
+    || (id.getArity() == Arity && AuxiliaryArity == 0)
+
+bool isGenericRelation(Global& glb, const ram::Relation& id) {
+    // nullary relations, relations with auxiliary columns, and other representations are specialised
+    if (id.getArity() == 0 || id.getAuxiliaryArity() > 0 ||
+            id.getRepresentation() == RelationRepresentation::EQREL ||
+            id.getRepresentation() == RelationRepresentation::BTREE_DELETE) {
+        return false;
+    }
+    if (glb.config().has("generic-relations")) {
+        return true;
+    }
+    // otherwise only relations whose arity lacks a specialised relation are generic
+    return !(false FOR_EACH_BTREE(IS_BTREE_ARITY));
+}
+
+#undef IS_BTREE_ARITY
+
+}  // namespace souffle::interpreter
@@ -21,6 +21,7 @@
 #include "souffle/datastructure/UnionFind.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/ParallelUtil.h"
 #include "souffle/utility/StreamUtil.h"
 #include <array>
 #include <atomic>
@@ -30,6 +31,8 @@
 #include <iosfwd>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -132,6 +135,17 @@ inline std::ostream& operator<<(std::ostream& out, const Order& order) {
     return out << "[" << join(order.order) << "]";
 }
 
+/**
+ * Tells whether a data structure supports the batch insertion of ranges.
+ */
+template <typename Data, typename Iter, typename = void>
+struct has_insert_all : std::false_type {};
+
+template <typename Data, typename Iter>
+struct has_insert_all<Data, Iter,
+        std::void_t<decltype(std::declval<Data&>().insertAll(std::declval<Iter>(), std::declval<Iter>()))>>
+        : std::true_type {};
+
 /**
  * A dummy wrapper for indexViews.
  */
@@ -247,6 +261,20 @@ public:
         }
     }
 
+    /**
+     * Inserts the given range of encoded tuples as one batch.
+     */
+    template <typename Iter>
+    void insertAll(const Iter& a, const Iter& b) {
+        if constexpr (has_insert_all<Data, Iter>::value) {
+            data.insertAll(a, b);
+        } else {
+            for (auto it = a; it != b; ++it) {
+                data.insert(*it);
+            }
+        }
+    }
+
     /**
      * Tests whether the given tuple is present in this index or not.
      */
@@ -338,7 +366,7 @@ public:
     // Specialized iterator class for nullary.
     class iterator {
         bool value;
-        const Tuple dummy{};
+        Tuple dummy{};
 
     public:
         using iterator_category = std::forward_iterator_tag;
@@ -350,6 +378,7 @@ public:
         iterator() : value(false) {}
         iterator(bool v) : value(v) {}
         iterator(const iterator& other) : value(other.value), dummy(other.dummy) {}
+        iterator& operator=(const iterator& other) = default;
 
         const Tuple& operator*() {
             return dummy;
@@ -499,4 +528,246 @@ public:
     }
 };
 
+/**
+ * The rows of a relation of an arity only known at run time, shared by its indexes
+ *
+ * Rows are kept in the natural order of the relation, in blocks of doubling size
+ * that are never moved. A row is allocated by bumping an atomic counter; only the
+ * thread that runs out of blocks takes a lock to add one. The row of a rejected
+ * duplicate is kept as a spare of its thread, which reuses it for its next row.
+ */
+class GenericRows {
+public:
+    GenericRows(std::size_t arity) : arity(arity) {}
+    GenericRows(const GenericRows&) = delete;
+    GenericRows& operator=(const GenericRows&) = delete;
+
+    /** Allocates a row, returning its slot */
+    std::size_t allocate() {
+        const std::size_t spare = getSpare().exchange(NoSlot, std::memory_order_relaxed);
+        if (spare != NoSlot) {
+            return spare;
+        }
+        const std::size_t slot = count.fetch_add(1, std::memory_order_relaxed);
+        if (capacity.load(std::memory_order_acquire) <= slot) {
+            std::lock_guard<SpinLock> guard(blockLock);
+            std::size_t rows = capacity.load(std::memory_order_relaxed);
+            while (rows <= slot) {
+                const std::size_t blockRows = FirstBlockRows << numBlocks;
+                blocks[numBlocks++] = Own<RamDomain[]>(new RamDomain[blockRows * arity]);
+                rows += blockRows;
+            }
+            capacity.store(rows, std::memory_order_release);
+        }
+        return slot;
+    }
+
+    /** Gives back the row of the given slot, to be reused by the next allocation of the calling thread */
+    void reclaim(std::size_t slot) {
+        std::size_t none = NoSlot;
+        if (!getSpare().compare_exchange_strong(none, slot, std::memory_order_relaxed)) {
+            // another thread sharing the spare holds it; undo the allocation if it was the last one
+            std::size_t next = slot + 1;
+            count.compare_exchange_strong(next, slot, std::memory_order_relaxed);
+        }
+    }
+
+    /** Obtains the row of the given slot */
+    GenericTuple get(std::size_t slot) const {
+        const std::size_t index = slot + FirstBlockRows;
+        const std::size_t blockNum = 63 - __builtin_clzll(index);
+        const std::size_t offset = index & ((std::size_t(1) << blockNum) - 1);
+        return GenericTuple(&blocks[blockNum - FirstBlockBits][offset * arity], arity);
+    }
+
+    void clear() {
+        for (std::size_t i = 0; i < numBlocks; ++i) {
+            blocks[i].reset();
+        }
+        numBlocks = 0;
+        capacity.store(0);
+        count.store(0);
+        for (auto& spare : spares) {
+            spare.slot.store(NoSlot);
+        }
+    }
+
+private:
+    /** The first block holds 2^FirstBlockBits rows, each further block twice as many */
+    static constexpr std::size_t FirstBlockBits = 10;
+    static constexpr std::size_t FirstBlockRows = std::size_t(1) << FirstBlockBits;
+    static constexpr std::size_t MaxBlocks = 64 - FirstBlockBits;
+    /** The number of threads keeping a spare row without sharing it with others */
+    static constexpr std::size_t MaxSpares = 64;
+    static constexpr std::size_t NoSlot = ~std::size_t(0);
+
+    struct alignas(hardware_destructive_interference_size) Spare {
+        std::atomic<std::size_t> slot{NoSlot};
+    };
+
+    /** The spare row of the calling thread */
+    std::atomic<std::size_t>& getSpare() {
+#ifdef _OPENMP
+        return spares[static_cast<std::size_t>(omp_get_thread_num()) % MaxSpares].slot;
+#else
+        return spares[0].slot;
+#endif
+    }
+
+    const std::size_t arity;
+    /** The number of allocated rows */
+    std::atomic<std::size_t> count{0};
+    /** The number of rows the blocks can hold */
+    std::atomic<std::size_t> capacity{0};
+    std::array<Own<RamDomain[]>, MaxBlocks> blocks;
+    std::size_t numBlocks = 0;
+    /** Protects the addition of blocks */
+    SpinLock blockLock;
+    std::array<Spare, MaxSpares> spares;
+};
+
+/**
+ * An index on tuples of an arity only known at run time
+ *
+ * The B-tree orders references to the rows of the relation, which are shared by
+ * all its indexes; each reference views its row through the order of the index.
+ * Tuples handed in and out are in the natural order of the relation.
+ */
+class GenericIndex {
+public:
+    using Data = Generic<0, 0>;
+    using Tuple = GenericTuple;
+    using iterator = typename Data::iterator;
+    using Hints = typename Data::operation_hints;
+    using Comparator = GenericComparator;
+
+    GenericIndex(Order order) : order(std::move(order)) {
+        for (std::size_t i = 0; i < this->order.size(); ++i) {
+            columns.push_back(this->order[i]);
+        }
+    }
+
+protected:
+    Order order;
+    /** The order as an array, referred to by the tuples in this index */
+    std::vector<std::size_t> columns;
+    Data data;
+    Comparator cmp;
+
+public:
+    /**
+     * A view on the index caching local access patterns (not thread safe!).
+     */
+    class View : public ViewWrapper {
+        mutable Hints hints;
+        const Data& data;
+        const std::size_t* columns;
+        Comparator cmp;
+
+    public:
+        View(const Data& data, const std::size_t* columns) : data(data), columns(columns) {}
+
+        /** Tests whether the given entry is contained in this index. */
+        bool contains(const Tuple& entry) {
+            return data.contains(entry.withOrder(columns), hints);
+        }
+
+        /** Tests whether any element in the given range is contained in this index. */
+        bool contains(const Tuple& low, const Tuple& high) {
+            return !range(low, high).empty();
+        }
+
+        /** Obtains a pair of iterators representing the given range within this index. */
+        souffle::range<iterator> range(const Tuple& low, const Tuple& high) {
+            const Tuple lowKey = low.withOrder(columns);
+            const Tuple highKey = high.withOrder(columns);
+            if (cmp(lowKey, highKey) > 0) {
+                return {data.end(), data.end()};
+            }
+            return {data.lower_bound(lowKey, hints), data.upper_bound(highKey, hints)};
+        }
+    };
+
+    View createView() const {
+        return View(this->data, columns.data());
+    }
+
+    iterator begin() const {
+        return data.begin();
+    }
+
+    iterator end() const {
+        return data.end();
+    }
+
+    Order getOrder() const {
+        return order;
+    }
+
+    bool empty() const {
+        return data.empty();
+    }
+
+    std::size_t size() const {
+        return data.size();
+    }
+
+    /**
+     * Inserts a row of the relation into this index.
+     */
+    bool insert(const Tuple& row) {
+        return data.insert(row.withOrder(columns.data()));
+    }
+
+    bool contains(const Tuple& tuple) const {
+        return data.contains(tuple.withOrder(columns.data()));
+    }
+
+    bool contains(const Tuple& low, const Tuple& high) const {
+        return !range(low, high).empty();
+    }
+
+    souffle::range<iterator> scan() const {
+        return {data.begin(), data.end()};
+    }
+
+    souffle::range<iterator> range(const Tuple& low, const Tuple& high) const {
+        const Tuple lowKey = low.withOrder(columns.data());
+        const Tuple highKey = high.withOrder(columns.data());
+        if (cmp(lowKey, highKey) > 0) {
+            return {data.end(), data.end()};
+        }
+        return {data.lower_bound(lowKey), data.upper_bound(highKey)};
+    }
+
+    std::vector<souffle::range<iterator>> partitionScan(std::size_t partitionCount) const {
+        auto chunks = data.partition(partitionCount);
+        std::vector<souffle::range<iterator>> res;
+        res.reserve(chunks.size());
+        for (const auto& cur : chunks) {
+            res.push_back({cur.begin(), cur.end()});
+        }
+        return res;
+    }
+
+    std::vector<souffle::range<iterator>> partitionRange(
+            const Tuple& low, const Tuple& high, std::size_t partitionCount) const {
+        auto chunks = this->range(low, high).partition(partitionCount);
+        std::vector<souffle::range<iterator>> res;
+        res.reserve(chunks.size());
+        for (const auto& cur : chunks) {
+            res.push_back({cur.begin(), cur.end()});
+        }
+        return res;
+    }
+
+    void clear() {
+        data.clear();
+    }
+
+    void printStats(std::ostream& o) const {
+        data.printStats(o);
+    }
+};
+
 }  // namespace souffle::interpreter
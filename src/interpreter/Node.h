@@ -23,11 +23,13 @@
 
 #pragma once
 
+#include "interpreter/Relation.h"
 #include "interpreter/Util.h"
 #include "ram/Relation.h"
 #include "souffle/RamTypes.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/ParallelUtil.h"
 
 #ifdef USE_LIBFFI
 #include <ffi.h>
@@ -36,6 +38,8 @@
 #include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <regex>
 #include <string>
@@ -100,6 +104,7 @@ struct RelationWrapper;
     Forward(SubroutineReturn)\
     Forward(Sequence)\
     Forward(Parallel)\
+    Forward(AdaptivePlan)\
     Forward(Loop)\
     Forward(Assign)\
     Forward(Exit)\
@@ -112,6 +117,7 @@ struct RelationWrapper;
     Forward(IO)\
     Forward(Query)\
     Forward(MergeExtend)\
+    Forward(MergeInsert)\
     Forward(Swap)\
     Forward(Call)
 
@@ -142,7 +148,7 @@ enum NodeType {
  *
  * Add reflective from string to NodeType.
  */
-inline NodeType constructNodeType(Global&, std::string tokBase, const ram::Relation& rel) {
+inline NodeType constructNodeType(Global& glb, std::string tokBase, const ram::Relation& rel) {
 
     static const std::unordered_map<std::string, NodeType> map = {
             FOR_EACH_INTERPRETER_TOKEN(SINGLE_TOKEN_ENTRY, EXPAND_TOKEN_ENTRY)
@@ -157,6 +163,8 @@ inline NodeType constructNodeType(Global&, std::string tokBase, const ram::Relat
         return map.at("I_" + tokBase + "_Eqrel_" + arity + "_" + auxiliaryArity);
     } else if(rel.getRepresentation() == RelationRepresentation::BTREE_DELETE) {
         return map.at("I_" + tokBase + "_BtreeDelete_" + arity + "_" + auxiliaryArity);
+    } else if (isGenericRelation(glb, rel)) {
+        return map.at("I_" + tokBase + "_Generic_0_0");
     } else  {
         return map.at("I_" + tokBase + "_Btree_" + arity + "_" + auxiliaryArity);
     }
@@ -327,8 +335,19 @@ public:
         viewContext = v;
     }
 
+    /** @brief get the nested loop whose iterations threads may share instead, if any */
+    inline const Node* getSplitLoop() const {
+        return splitLoop;
+    }
+
+    /** @brief set the nested loop whose iterations threads may share instead */
+    inline void setSplitLoop(const Node* loop) {
+        splitLoop = loop;
+    }
+
 protected:
     std::shared_ptr<ViewContext> viewContext = nullptr;
+    const Node* splitLoop = nullptr;
 };
 
 /**
@@ -351,7 +370,7 @@ protected:
 /**
  * @class BinRelOperation
  * @brief  operation that involves with two relations should inherit from this class.
- *        E.g. Swap, MergeExtend
+ *        E.g. Swap, MergeExtend, MergeInsert
  */
 class BinRelOperation {
 public:
@@ -661,7 +680,17 @@ class Constraint : public BinaryNode {
  * @class TupleOperation
  */
 class TupleOperation : public UnaryNode {
-    using UnaryNode::UnaryNode;
+public:
+    TupleOperation(enum NodeType ty, const ram::Node* sdw, Own<Node> child, bool scan)
+            : UnaryNode(ty, sdw, std::move(child)), scan(scan) {}
+
+    /** @brief Check whether the operation binds the tuples of a relation it scans */
+    bool isScan() const {
+        return scan;
+    }
+
+private:
+    const bool scan;
 };
 
 /**
@@ -832,8 +861,18 @@ public:
  */
 class Insert : public Node, public SuperOperation, public RelationalOperation {
 public:
-    Insert(enum NodeType ty, const ram::Node* sdw, RelationHandle* relHandle, SuperInstruction superInst)
-            : Node(ty, sdw), SuperOperation(std::move(superInst)), RelationalOperation(relHandle) {}
+    Insert(enum NodeType ty, const ram::Node* sdw, RelationHandle* relHandle, SuperInstruction superInst,
+            bool buffered)
+            : Node(ty, sdw), SuperOperation(std::move(superInst)), RelationalOperation(relHandle),
+              buffered(buffered) {}
+
+    /** @brief Whether tuples are collected in the insert buffers of the context */
+    bool isBuffered() const {
+        return buffered;
+    }
+
+private:
+    const bool buffered;
 };
 
 /**
@@ -851,8 +890,48 @@ public:
 class GuardedInsert : public Insert, public ConditionalOperation {
 public:
     GuardedInsert(enum NodeType ty, const ram::Node* sdw, RelationHandle* relHandle,
-            SuperInstruction superInst, Own<Node> condition)
-            : Insert(ty, sdw, relHandle, std::move(superInst)), ConditionalOperation(std::move(condition)) {}
+            SuperInstruction superInst, bool buffered, Own<Node> condition, bool synchronised,
+            std::vector<std::vector<std::size_t>> keys)
+            : Insert(ty, sdw, relHandle, std::move(superInst), buffered),
+              ConditionalOperation(std::move(condition)), synchronised(synchronised), keys(std::move(keys)) {}
+
+    /** @brief Whether threads of a parallel query must check the guard and insert as one step */
+    bool isSynchronised() const {
+        return synchronised;
+    }
+
+    /** @brief Locks serialising the guard checks and insertions of tuples sharing a key */
+    StripedLock& getLock() const {
+        return lock;
+    }
+
+    /**
+     * @brief The stripes of the lock covering the keys of the given tuple
+     *
+     * Tuples that may conflict agree on the columns of some key and hence share a stripe;
+     * a guard without keys conflicts with everything.
+     */
+    template <typename Tuple>
+    StripedLock::StripeSet getStripes(const Tuple& tuple) const {
+        if (keys.empty()) {
+            return StripedLock::AllStripes;
+        }
+        StripedLock::StripeSet stripes = 0;
+        for (const auto& key : keys) {
+            std::uint64_t hash = StripedLock::EmptyHash;
+            for (std::size_t column : key) {
+                hash = StripedLock::hash(hash, tuple[column]);
+            }
+            stripes |= StripedLock::stripe(hash);
+        }
+        return stripes;
+    }
+
+private:
+    const bool synchronised;
+    /** Column sets on which the guard compares the inserted tuple with existing ones */
+    const std::vector<std::vector<std::size_t>> keys;
+    mutable StripedLock lock;
 };
 
 /**
@@ -880,7 +959,66 @@ class Assign : public BinaryNode {
  * @class Parallel
  */
 class Parallel : public CompoundNode {
-    using CompoundNode::CompoundNode;
+public:
+    Parallel(enum NodeType ty, const ram::Node* sdw, VecOwn<Node> children, bool concurrent)
+            : CompoundNode(ty, sdw, std::move(children)), concurrent(concurrent) {}
+
+    /** @brief whether the statements may be executed concurrently */
+    bool isConcurrent() const {
+        return concurrent;
+    }
+
+protected:
+    const bool concurrent;
+};
+
+/**
+ * @class AdaptivePlan
+ * @brief Alternative plans of a rule, of which the cheapest is executed
+ *
+ * The cost of a plan is estimated from the relations it iterates over, from
+ * the outermost to the innermost one.
+ */
+class AdaptivePlan : public CompoundNode {
+public:
+    using RelationHandle = Own<RelationWrapper>;
+
+    /** An iteration over a relation within a plan */
+    struct Step {
+        RelationHandle* relation;
+        /** the index searched, and the number of its leading columns bound by the search */
+        std::size_t indexPos;
+        std::size_t boundColumns;
+        /** whether at most one tuple is passed on, e.g. by an existence check or an aggregate */
+        bool single;
+        /** the size of the relation when the fanout was last estimated, and that estimate */
+        mutable std::size_t sampledSize;
+        mutable double fanout;
+    };
+
+    AdaptivePlan(enum NodeType ty, const ram::Node* sdw, VecOwn<Node> children,
+            std::vector<std::vector<Step>> steps)
+            : CompoundNode(ty, sdw, std::move(children)), steps(std::move(steps)) {}
+
+    /** @brief the iterations of a plan */
+    const std::vector<Step>& getSteps(std::size_t plan) const {
+        return steps[plan];
+    }
+
+    /** @brief the plan executed last, or none */
+    std::size_t getCurrentPlan() const {
+        return current;
+    }
+
+    void setCurrentPlan(std::size_t plan) const {
+        current = plan;
+    }
+
+    static constexpr std::size_t NoPlan = std::numeric_limits<std::size_t>::max();
+
+protected:
+    const std::vector<std::vector<Step>> steps;
+    mutable std::size_t current = NoPlan;
 };
 
 /**
@@ -988,6 +1126,15 @@ public:
             : Node(ty, sdw), BinRelOperation(src, target) {}
 };
 
+/**
+ * @class MergeInsert
+ */
+class MergeInsert : public Node, public BinRelOperation {
+public:
+    MergeInsert(enum NodeType ty, const ram::Node* sdw, std::size_t src, std::size_t target)
+            : Node(ty, sdw), BinRelOperation(src, target) {}
+};
+
 /**
  * @class Swap
  */
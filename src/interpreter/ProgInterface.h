@@ -58,6 +58,11 @@ public:
         relation.insert(t.data);
     }
 
+    /** Insert tuples stored one after another */
+    void insertBatch(std::vector<RamDomain>& tuples) override {
+        relation.insertBatch(tuples);
+    }
+
     /** Check whether tuple exists */
     bool contains(const tuple& t) const override {
         return relation.contains(t.data);
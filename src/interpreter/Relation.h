@@ -16,11 +16,13 @@
 
 #pragma once
 
+#include "interpreter/Arena.h"
 #include "interpreter/Index.h"
 #include "ram/analysis/Index.h"
 #include "souffle/RamTypes.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/utility/MiscUtil.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
@@ -105,6 +107,16 @@ public:
 
     virtual Iterator end() const = 0;
 
+    /** Number of ranges requested from the main index by partition(). */
+    static constexpr std::size_t PartitionCount = 10000;
+
+    /** Split the relation into ranges of tuples that can be traversed concurrently. */
+    virtual std::vector<souffle::range<Iterator>> partition() const {
+        std::vector<souffle::range<Iterator>> res;
+        res.emplace_back(begin(), end());
+        return res;
+    }
+
     virtual void insert(const RamDomain*) = 0;
 
     virtual bool contains(const RamDomain*) const = 0;
@@ -129,19 +141,38 @@ public:
 
     // -- Defines methods and interfaces for Interpreter execution. --
 public:
-    using IndexViewPtr = Own<ViewWrapper>;
+    using IndexViewPtr = ArenaOwn<ViewWrapper>;
+
+    /**
+     * Add all tuples of the given relation, which must have the same signature, to this relation.
+     */
+    virtual void insertAll(const RelationWrapper& source) = 0;
+
+    /**
+     * Add a batch of tuples, stored one after another, to this relation and clear the batch.
+     */
+    virtual void insertBatch(std::vector<RamDomain>& tuples) = 0;
 
     /**
      * Return the order of an index.
      */
     virtual Order getIndexOrder(std::size_t) const = 0;
 
+    /**
+     * Estimate the average number of tuples sharing the values of the given number of
+     * leading columns of an index, from at most the given number of tuples at the start
+     * of the index; returns 0 for an empty relation.
+     */
+    virtual double estimateFanout(
+            std::size_t indexPos, std::size_t prefixLength, std::size_t sampleSize) const = 0;
+
     /**
      * Obtains a view on an index of this relation, facilitating hint-supported accesses.
      *
      * This function is virtual because view creation require at least one indirect dispatch.
+     * The view is created in the given arena.
      */
-    virtual IndexViewPtr createView(const std::size_t&) const = 0;
+    virtual IndexViewPtr createView(const std::size_t&, Arena&) const = 0;
 
 protected:
     std::string relName;
@@ -175,6 +206,16 @@ public:
         return tuple;
     }
 
+    /** Temporary tuples live on the stack, hence need no scope in the arena */
+    using TemporaryScope = Arena::NoScope;
+
+    /**
+     * Create a tuple for the evaluation; the arity is known already.
+     */
+    static Tuple createTuple(Arena&, std::size_t) {
+        return {};
+    }
+
     /**
      * Cast an abstract view into a view of Index::View type.
      */
@@ -224,8 +265,43 @@ public:
         return contains(constructTuple(data));
     }
 
-    IndexViewPtr createView(const std::size_t& indexPos) const override {
-        return mk<View>(indexes[indexPos]->createView());
+    void insertAll(const RelationWrapper& source) override {
+        if constexpr (Arity > 0 && AuxiliaryArity == 0) {
+            if (const auto* other = as<Relation>(source)) {
+                insertSorted(*other);
+                return;
+            }
+        }
+        // fall back to inserting tuple by tuple
+        for (const RamDomain* tuple : source) {
+            insert(tuple);
+        }
+    }
+
+    void insertBatch(std::vector<RamDomain>& tuples) override {
+        if constexpr (Arity > 0 && AuxiliaryArity == 0) {
+            // merge the batch into each index as a whole
+            std::vector<Tuple> batch;
+            batch.reserve(tuples.size() / Arity);
+            for (auto& index : indexes) {
+                const Order order = index->getOrder();
+                batch.clear();
+                for (std::size_t i = 0; i < tuples.size(); i += Arity) {
+                    batch.push_back(order.encode(constructTuple(&tuples[i])));
+                }
+                index->insertAll(batch.begin(), batch.end());
+            }
+        } else if constexpr (Arity > 0) {
+            // fall back to inserting tuple by tuple
+            for (std::size_t i = 0; i < tuples.size(); i += Arity) {
+                insert(constructTuple(&tuples[i]));
+            }
+        }
+        tuples.clear();
+    }
+
+    IndexViewPtr createView(const std::size_t& indexPos, Arena& arena) const override {
+        return IndexViewPtr(arena.create<View>(indexes[indexPos]->createView()));
     }
 
     std::size_t size() const override {
@@ -236,6 +312,31 @@ public:
         return indexes[idx]->getOrder();
     }
 
+    double estimateFanout(
+            std::size_t indexPos, std::size_t prefixLength, std::size_t sampleSize) const override {
+        std::size_t sampled = 0;
+        std::size_t distinct = 0;
+        if constexpr (Arity > 0) {
+            // the tuples sharing a prefix are adjacent in the index
+            Tuple prev{};
+            for (const auto& tuple : indexes[indexPos]->scan()) {
+                if (sampled == sampleSize) {
+                    break;
+                }
+                bool samePrefix = sampled > 0;
+                for (std::size_t i = 0; samePrefix && i < prefixLength; ++i) {
+                    samePrefix = tuple[i] == prev[i];
+                }
+                if (!samePrefix) {
+                    ++distinct;
+                }
+                prev = tuple;
+                ++sampled;
+            }
+        }
+        return distinct == 0 ? 0.0 : static_cast<double>(sampled) / static_cast<double>(distinct);
+    }
+
     class iterator_base : public RelationWrapper::iterator_base {
         iterator iter;
         Order order;
@@ -279,6 +380,16 @@ public:
         return Iterator(new iterator_base(main->end(), main->getOrder()));
     }
 
+    std::vector<souffle::range<Iterator>> partition() const override {
+        std::vector<souffle::range<Iterator>> res;
+        const Order order = main->getOrder();
+        for (const auto& chunk : main->partitionScan(PartitionCount)) {
+            res.emplace_back(Iterator(new iterator_base(chunk.begin(), order)),
+                    Iterator(new iterator_base(chunk.end(), order)));
+        }
+        return res;
+    }
+
     // -----
     // Following section defines and implement interfaces for interpreter execution.
     //
@@ -308,6 +419,26 @@ public:
         }
     }
 
+    /**
+     * Add all entries of the given relation to this relation as sorted batches.
+     *
+     * The entries are re-encoded for each index and merged into the index as a
+     * whole instead of being inserted one at a time.
+     */
+    void insertSorted(const Relation<Arity, AuxiliaryArity, Structure>& other) {
+        const Order srcOrder = other.main->getOrder();
+        std::vector<Tuple> tuples;
+        tuples.reserve(other.__size());
+        for (auto& index : indexes) {
+            const Order order = index->getOrder();
+            tuples.clear();
+            for (const auto& tuple : other.scan()) {
+                tuples.push_back(order.encode(srcOrder.decode(tuple)));
+            }
+            index->insertAll(tuples.begin(), tuples.end());
+        }
+    }
+
     /**
      * Tests whether this relation contains the given tuple.
      */
@@ -410,6 +541,259 @@ protected:
     Index* main;
 };
 
+/**
+ * A relation of an arity only known at run time, composed of generic indexes.
+ *
+ * It provides the interface of the relations specialised to an arity, with
+ * generic tuples in place of fixed-size ones, so that the engine evaluates its
+ * operations with the same code. The indexes share the rows of the relation,
+ * which stay in the natural order; hence all index orders are reported as the
+ * natural order, so that the engine neither encodes nor decodes tuples.
+ */
+template <>
+class Relation<0, 0, Generic> : public RelationWrapper {
+public:
+    using Index = GenericIndex;
+    using Tuple = GenericTuple;
+    using View = Index::View;
+    using iterator = Index::iterator;
+
+    /** Temporary tuples are allocated in the arena of the evaluation */
+    using TemporaryScope = Arena::Scope;
+
+    /**
+     * Create a tuple for the evaluation in the given arena.
+     */
+    static Tuple createTuple(Arena& arena, std::size_t arity) {
+        return Tuple(arena.allocate<RamDomain>(arity), arity);
+    }
+
+    static View* castView(ViewWrapper* view) {
+        return static_cast<View*>(view);
+    }
+
+    Relation(std::size_t arity, const std::string& name, const ram::analysis::IndexCluster& indexSelection)
+            : RelationWrapper(arity, 0, name), rows(mk<GenericRows>(arity)) {
+        for (const auto& order : indexSelection.getAllOrders()) {
+            ram::analysis::LexOrder fullOrder = order;
+            // Expand the order to a total order
+            ram::analysis::AttributeSet set{order.begin(), order.end()};
+            for (std::size_t i = 0; i < arity; ++i) {
+                if (set.find(i) == set.end()) {
+                    fullOrder.push_back(i);
+                }
+            }
+            indexes.push_back(mk<Index>(fullOrder));
+        }
+        main = indexes[0].get();
+    }
+
+    Relation(Relation& other) = delete;
+
+    // -- Implement all virtual interface from Wrapper. --
+public:
+    void purge() override {
+        __purge();
+    }
+
+    void insert(const RamDomain* data) override {
+        // the values are only read, to be copied into a row of the relation
+        insert(Tuple(const_cast<RamDomain*>(data), arity));
+    }
+
+    bool contains(const RamDomain* data) const override {
+        return contains(Tuple(const_cast<RamDomain*>(data), arity));
+    }
+
+    void insertAll(const RelationWrapper& source) override {
+        if (const auto* other = as<Relation>(source)) {
+            // the rows of the other relation are in the natural order as well
+            for (const auto& tuple : other->scan()) {
+                insert(tuple);
+            }
+            return;
+        }
+        for (const RamDomain* tuple : source) {
+            insert(tuple);
+        }
+    }
+
+    void insertBatch(std::vector<RamDomain>& tuples) override {
+        for (std::size_t i = 0; i < tuples.size(); i += arity) {
+            insert(Tuple(&tuples[i], arity));
+        }
+        tuples.clear();
+    }
+
+    IndexViewPtr createView(const std::size_t& indexPos, Arena& arena) const override {
+        return IndexViewPtr(arena.create<View>(indexes[indexPos]->createView()));
+    }
+
+    std::size_t size() const override {
+        return __size();
+    }
+
+    Order getIndexOrder(std::size_t) const override {
+        return Order::create(arity);
+    }
+
+    double estimateFanout(
+            std::size_t indexPos, std::size_t prefixLength, std::size_t sampleSize) const override {
+        std::size_t sampled = 0;
+        std::size_t distinct = 0;
+        // the tuples sharing a prefix are adjacent in the index
+        Tuple prev;
+        for (const auto& tuple : indexes[indexPos]->scan()) {
+            if (sampled == sampleSize) {
+                break;
+            }
+            bool samePrefix = sampled > 0;
+            for (std::size_t i = 0; samePrefix && i < prefixLength; ++i) {
+                samePrefix = tuple.key(i) == prev.key(i);
+            }
+            if (!samePrefix) {
+                ++distinct;
+            }
+            prev = tuple;
+            ++sampled;
+        }
+        return distinct == 0 ? 0.0 : static_cast<double>(sampled) / static_cast<double>(distinct);
+    }
+
+    class iterator_base : public RelationWrapper::iterator_base {
+        iterator iter;
+
+    public:
+        iterator_base(iterator iter) : iter(std::move(iter)) {}
+
+        iterator_base& operator++() override {
+            ++iter;
+            return *this;
+        }
+
+        const RamDomain* operator*() override {
+            return (*iter).data();
+        }
+
+        iterator_base* clone() const override {
+            return new iterator_base(iter);
+        }
+
+        bool equal(const RelationWrapper::iterator_base& other) const override {
+            if (auto* o = as<iterator_base>(other)) {
+                return iter == o->iter;
+            }
+            return false;
+        }
+    };
+
+    Iterator begin() const override {
+        return Iterator(new iterator_base(main->begin()));
+    }
+
+    Iterator end() const override {
+        return Iterator(new iterator_base(main->end()));
+    }
+
+    std::vector<souffle::range<Iterator>> partition() const override {
+        std::vector<souffle::range<Iterator>> res;
+        for (const auto& chunk : main->partitionScan(PartitionCount)) {
+            res.emplace_back(
+                    Iterator(new iterator_base(chunk.begin())), Iterator(new iterator_base(chunk.end())));
+        }
+        return res;
+    }
+
+    // -- Interfaces for the interpreter engine, as for the specialised relations. --
+public:
+    bool insert(const Tuple& tuple) {
+        // the values are stored up front and given back if the tuple is present already
+        const std::size_t slot = rows->allocate();
+        Tuple row = rows->get(slot);
+        std::copy_n(tuple.begin(), arity, row.begin());
+        if (!(main->insert(row))) {
+            rows->reclaim(slot);
+            return false;
+        }
+        for (std::size_t i = 1; i < indexes.size(); ++i) {
+            indexes[i]->insert(row);
+        }
+        return true;
+    }
+
+    bool contains(const Tuple& tuple) const {
+        return main->contains(tuple);
+    }
+
+    bool contains(const std::size_t& indexPos, const Tuple& low, const Tuple& high) const {
+        return indexes[indexPos]->contains(low, high);
+    }
+
+    souffle::range<iterator> scan() const {
+        return main->scan();
+    }
+
+    std::vector<souffle::range<iterator>> partitionScan(std::size_t partitionCount) const {
+        return main->partitionScan(partitionCount);
+    }
+
+    souffle::range<iterator> range(const std::size_t& indexPos, const Tuple& low, const Tuple& high) const {
+        return indexes[indexPos]->range(low, high);
+    }
+
+    std::vector<souffle::range<iterator>> partitionRange(const std::size_t& indexPos, const Tuple& low,
+            const Tuple& high, std::size_t partitionCount) const {
+        return indexes[indexPos]->partitionRange(low, high, partitionCount);
+    }
+
+    void swap(Relation& other) {
+        indexes.swap(other.indexes);
+        rows.swap(other.rows);
+    }
+
+    std::size_t __size() const {
+        return main->size();
+    }
+
+    bool empty() const {
+        return main->empty();
+    }
+
+    void __purge() {
+        for (auto& idx : indexes) {
+            idx->clear();
+        }
+        rows->clear();
+    }
+
+    bool exists(const Tuple& tuple) const {
+        return main->contains(tuple);
+    }
+
+    Index* getIndex(std::size_t idx) const {
+        return indexes.at(idx).get();
+    }
+
+    void printStats(std::ostream& o) const override {
+        for (std::size_t i = 0; i < indexes.size(); ++i) {
+            o << "Index " << i << ":\n";
+            indexes[i]->printStats(o);
+        }
+    }
+
+protected:
+    // a map of managed indexes
+    VecOwn<Index> indexes;
+
+    // a pointer to the main index within the managed index
+    Index* main;
+
+    // the rows of the relation, shared by all indexes
+    Own<GenericRows> rows;
+};
+
+using GenericRelation = Relation<0, 0, Generic>;
+
 template <std::size_t _Arity, std::size_t _AuxiliaryArity>
 class BtreeDeleteRelation : public Relation<_Arity, _AuxiliaryArity, BtreeDelete> {
 public:
@@ -469,4 +853,11 @@ Own<RelationWrapper> createBrieRelation(
 // A factory for Eqrel index.
 Own<RelationWrapper> createEqrelRelation(
         const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
+
+// A factory for relations of any arity.
+Own<RelationWrapper> createGenericRelation(
+        const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
+
+// Tells whether a relation is created as a generic relation instead of one specialised to its arity.
+bool isGenericRelation(Global& glb, const ram::Relation& id);
 }  // namespace souffle::interpreter
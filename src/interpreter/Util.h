@@ -23,6 +23,8 @@
 #include "souffle/datastructure/EquivalenceRelation.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
+#include <cassert>
+#include <cstddef>
 
 namespace souffle::interpreter {
 // clang-format off
@@ -144,12 +146,18 @@ namespace souffle::interpreter {
 #define FOR_EACH_EQREL(func, ...)\
     func(Eqrel, 2, 0, __VA_ARGS__)
 
+// The generic structure holds tuples of any arity, which is set at run time.
+// Its operations are instantiated once, for arity 0.
+#define FOR_EACH_GENERIC(func, ...)\
+    func(Generic, 0, 0, __VA_ARGS__)
+
 #define FOR_EACH(func, ...)                 \
     FOR_EACH_BTREE(func, __VA_ARGS__)       \
     FOR_EACH_BTREE_DELETE(func, __VA_ARGS__)\
     FOR_EACH_BRIE(func, __VA_ARGS__)        \
     FOR_EACH_PROVENANCE(func, __VA_ARGS__)  \
-    FOR_EACH_EQREL(func, __VA_ARGS__)
+    FOR_EACH_EQREL(func, __VA_ARGS__)       \
+    FOR_EACH_GENERIC(func, __VA_ARGS__)
 
 // clang-format on
 
@@ -243,6 +251,114 @@ struct get_full_index<0> {
 template <std::size_t Arity>
 using t_tuple = typename souffle::Tuple<RamDomain, Arity>;
 
+/**
+ * A tuple of an arity only known at run time, referring to values stored elsewhere.
+ *
+ * The values are in the natural order of the relation. A tuple viewed through an
+ * index also refers to the order of the index, which its keys follow.
+ */
+class GenericTuple {
+public:
+    GenericTuple() = default;
+    GenericTuple(RamDomain* values, std::size_t arity, const std::size_t* columns = nullptr)
+            : values(values), arity(arity), columns(columns) {}
+
+    std::size_t size() const {
+        return arity;
+    }
+
+    RamDomain* data() {
+        return values;
+    }
+
+    const RamDomain* data() const {
+        return values;
+    }
+
+    RamDomain& operator[](std::size_t i) {
+        return values[i];
+    }
+
+    const RamDomain& operator[](std::size_t i) const {
+        return values[i];
+    }
+
+    /** Obtains the i-th key in the order of the index the tuple is viewed through */
+    RamDomain key(std::size_t i) const {
+        assert(columns != nullptr && "tuple is not viewed through an index");
+        return values[columns[i]];
+    }
+
+    /** Views the same values through an index of the given order */
+    GenericTuple withOrder(const std::size_t* order) const {
+        return GenericTuple(values, arity, order);
+    }
+
+    RamDomain* begin() {
+        return values;
+    }
+
+    RamDomain* end() {
+        return values + arity;
+    }
+
+    const RamDomain* begin() const {
+        return values;
+    }
+
+    const RamDomain* end() const {
+        return values + arity;
+    }
+
+private:
+    RamDomain* values = nullptr;
+    std::size_t arity = 0;
+    const std::size_t* columns = nullptr;
+};
+
+/**
+ * The lexicographical order on the keys of generic tuples of the same arity.
+ */
+struct GenericComparator {
+    int operator()(const GenericTuple& a, const GenericTuple& b) const {
+        const std::size_t i = mismatch(a, b);
+        return (i == a.size()) ? 0 : ((a.key(i) < b.key(i)) ? -1 : 1);
+    }
+    bool less(const GenericTuple& a, const GenericTuple& b) const {
+        const std::size_t i = mismatch(a, b);
+        return i < a.size() && a.key(i) < b.key(i);
+    }
+    bool equal(const GenericTuple& a, const GenericTuple& b) const {
+        return mismatch(a, b) == a.size();
+    }
+
+private:
+    /**
+     * Obtains the first key in which the given tuples differ, or their arity if they are equal.
+     *
+     * The keys are compared in blocks without branching inside a block, which compilers
+     * turn into vector instructions.
+     */
+    static std::size_t mismatch(const GenericTuple& a, const GenericTuple& b) {
+        constexpr std::size_t BlockSize = 4;
+        const std::size_t arity = a.size();
+        std::size_t i = 0;
+        for (; i + BlockSize <= arity; i += BlockSize) {
+            RamDomain diff = 0;
+            for (std::size_t j = 0; j < BlockSize; ++j) {
+                diff |= a.key(i + j) ^ b.key(i + j);
+            }
+            if (diff != 0) {
+                break;
+            }
+        }
+        while (i < arity && a.key(i) == b.key(i)) {
+            ++i;
+        }
+        return i;
+    }
+};
+
 // The comparator to be used for B-tree nodes.
 template <std::size_t Arity>
 using comparator = typename index_utils::get_full_index<Arity>::type::comparator;
@@ -302,6 +418,11 @@ using Provenance = btree_set<t_tuple<Arity>, comparator<Arity>, std::allocator<t
         typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity - AuxiliaryArity>,
         ProvenanceUpdater<Arity, AuxiliaryArity>>;
 
+// Alias for Generic
+// Note: the arity is not part of the type; all instances are the same.
+template <std::size_t Arity, std::size_t AuxiliaryArity>
+using Generic = btree_set<GenericTuple, GenericComparator, std::allocator<GenericTuple>, 256>;
+
 // Alias for Eqrel
 // Note: require Arity = 2.
 template <std::size_t Arity, std::size_t AuxiliaryArity>
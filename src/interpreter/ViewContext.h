@@ -84,6 +84,9 @@ public:
     /** If this context has information for parallel operation.  */
     bool isParallel = false;
 
+    /** If the query collects insertions in insert buffers. */
+    bool hasInsertBuffers = false;
+
 private:
     /** Vector of filter operation, views required */
     VecOwn<Node> outerFilterViewOps;
@@ -0,0 +1,104 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file arena_test.cpp
+ *
+ * Tests the arena allocator of the interpreter
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "interpreter/Arena.h"
+#include "souffle/RamTypes.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace souffle::interpreter::test {
+
+TEST(Arena, Allocate) {
+    Arena arena;
+    RamDomain* a = arena.allocate<RamDomain>(3);
+    RamDomain* b = arena.allocate<RamDomain>(5);
+    for (int i = 0; i < 3; i++) {
+        a[i] = i;
+    }
+    for (int i = 0; i < 5; i++) {
+        b[i] = 10 + i;
+    }
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(i, a[i]);
+    }
+
+    // allocations are aligned and do not overlap
+    auto* c = arena.allocate<double>(1);
+    EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(c) % alignof(double));
+    EXPECT_TRUE(reinterpret_cast<char*>(c) >= reinterpret_cast<char*>(b + 5));
+
+    // allocations larger than a block are supported
+    RamDomain* large = arena.allocate<RamDomain>(Arena::BlockSize);
+    large[Arena::BlockSize - 1] = 42;
+    EXPECT_EQ(42, large[Arena::BlockSize - 1]);
+}
+
+TEST(Arena, Release) {
+    Arena arena;
+    RamDomain* first = arena.allocate<RamDomain>(1);
+    Arena::Mark mark = arena.mark();
+    RamDomain* second = arena.allocate<RamDomain>(1);
+    arena.release(mark);
+
+    // memory after the mark is reused, memory before it is kept
+    EXPECT_EQ(second, arena.allocate<RamDomain>(1));
+    EXPECT_NE(first, second);
+
+    // repeated scopes do not grow the arena
+    for (std::size_t i = 0; i < 1000; i++) {
+        Arena::Scope scope(arena);
+        arena.allocate<RamDomain>(1000);
+    }
+    EXPECT_TRUE(arena.capacity() <= 2 * Arena::BlockSize);
+}
+
+TEST(Arena, Bounded) {
+    Arena arena;
+    {
+        // a temporary peak of memory is returned, up to the retained blocks
+        Arena::Scope scope(arena);
+        for (std::size_t i = 0; i < 100; i++) {
+            arena.allocate(Arena::BlockSize);
+        }
+        EXPECT_TRUE(100 * Arena::BlockSize <= arena.capacity());
+    }
+    EXPECT_TRUE(arena.capacity() <= (Arena::RetainedBlocks + 1) * Arena::BlockSize);
+}
+
+TEST(Arena, Create) {
+    struct Counter {
+        Counter(int& count) : count(count) {
+            ++count;
+        }
+        ~Counter() {
+            --count;
+        }
+        int& count;
+    };
+
+    Arena arena;
+    int count = 0;
+    {
+        ArenaOwn<Counter> a(arena.create<Counter>(count));
+        ArenaOwn<Counter> b(arena.create<Counter>(count));
+        EXPECT_EQ(2, count);
+    }
+    EXPECT_EQ(0, count);
+}
+
+}  // namespace souffle::interpreter::test
@@ -21,9 +21,13 @@
 #include "ram/analysis/Index.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/datastructure/SymbolTableImpl.h"
+#include <algorithm>
 #include <iosfwd>
+#include <numeric>
+#include <random>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace souffle::interpreter::test {
 
@@ -287,4 +291,295 @@ TEST(Reordering, Iteration) {
     }
 }
 
+TEST(Fanout, Estimate) {
+    // create a relation with an index of order {1, 0}
+    SignatureOrderMap mapping;
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(2);
+    SearchSet searches = {existenceCheck};
+    LexOrder fullOrder = {1, 0};
+    OrderCollection orders = {fullOrder};
+    mapping.insert({existenceCheck, fullOrder});
+    IndexCluster indexSelection(mapping, searches, orders);
+
+    Relation<2, 0, interpreter::Btree> rel("test", indexSelection);
+    const RelationWrapper& wrapper = rel;
+    EXPECT_EQ(0.0, wrapper.estimateFanout(0, 1, 100));
+
+    // 10 distinct values in the second column, each with 4 values in the first column
+    for (RamDomain i = 0; i < 4; ++i) {
+        for (RamDomain j = 0; j < 10; ++j) {
+            rel.insert(souffle::Tuple<RamDomain, 2>{i, j});
+        }
+    }
+    EXPECT_EQ(4.0, wrapper.estimateFanout(0, 1, 100));
+    EXPECT_EQ(1.0, wrapper.estimateFanout(0, 2, 100));
+
+    // only the first 6 tuples are sampled, which share 2 prefixes
+    EXPECT_EQ(3.0, wrapper.estimateFanout(0, 1, 6));
+}
+
+TEST(Generic, Construction) {
+    // create a relation wider than any specialised relation
+    const std::size_t arity = 30;
+    SignatureOrderMap mapping;
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(arity);
+    SearchSet searches = {existenceCheck};
+    LexOrder fullOrder;
+    for (std::size_t i = 0; i < arity; ++i) {
+        fullOrder.push_back(i);
+    }
+    OrderCollection orders = {fullOrder};
+    mapping.insert({existenceCheck, fullOrder});
+    IndexCluster indexSelection(mapping, searches, orders);
+
+    GenericRelation rel(arity, "test", indexSelection);
+    const RelationWrapper& wrapper = rel;
+    EXPECT_EQ(arity, wrapper.getArity());
+
+    std::vector<RamDomain> tuple(arity, 0);
+    EXPECT_EQ(0, rel.size());
+    rel.insert(tuple.data());
+    EXPECT_EQ(1, rel.size());
+    rel.insert(tuple.data());
+    EXPECT_EQ(1, rel.size());
+
+    // tuples that only differ in the last column are distinct
+    tuple[arity - 1] = 1;
+    EXPECT_FALSE(wrapper.contains(tuple.data()));
+    rel.insert(tuple.data());
+    EXPECT_EQ(2, rel.size());
+    EXPECT_TRUE(wrapper.contains(tuple.data()));
+
+    // iteration yields the tuples in order
+    std::size_t count = 0;
+    for (const RamDomain* t : wrapper) {
+        EXPECT_EQ(static_cast<RamDomain>(count), t[arity - 1]);
+        ++count;
+    }
+    EXPECT_EQ(2, count);
+
+    rel.purge();
+    EXPECT_EQ(0, rel.size());
+    EXPECT_FALSE(wrapper.contains(tuple.data()));
+}
+
+TEST(Generic, Reordering) {
+    // create a generic relation with an index of order {0, 2, 1}
+    SignatureOrderMap mapping;
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(3);
+    SearchSet searches = {existenceCheck};
+    LexOrder fullOrder = {0, 2, 1};
+    OrderCollection orders = {fullOrder};
+    mapping.insert({existenceCheck, fullOrder});
+    IndexCluster indexSelection(mapping, searches, orders);
+
+    GenericRelation rel(3, "test", indexSelection);
+    RamDomain data[3] = {0, 1, 2};
+    rel.insert(data);
+
+    // Scan should give the tuple in the natural order, with keys in the order of the index.
+    {
+        const auto& t = *(rel.scan().begin());
+        EXPECT_EQ(0, t[0]);
+        EXPECT_EQ(1, t[1]);
+        EXPECT_EQ(2, t[2]);
+        EXPECT_EQ(0, t.key(0));
+        EXPECT_EQ(2, t.key(1));
+        EXPECT_EQ(1, t.key(2));
+    }
+
+    // For-each should give decoded tuple.
+    {
+        auto t = rel.begin();
+        EXPECT_EQ(0, (*t)[0]);
+        EXPECT_EQ(1, (*t)[1]);
+        EXPECT_EQ(2, (*t)[2]);
+    }
+}
+
+TEST(Generic, Specialised) {
+    // a generic relation and a specialised relation hold the same tuples
+    SignatureOrderMap mapping;
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(3);
+    SearchSet searches = {existenceCheck};
+    LexOrder fullOrder = {2, 0, 1};
+    OrderCollection orders = {fullOrder};
+    mapping.insert({existenceCheck, fullOrder});
+    IndexCluster indexSelection(mapping, searches, orders);
+
+    GenericRelation generic(3, "generic", indexSelection);
+    Relation<3, 0, interpreter::Btree> specialised("specialised", indexSelection);
+    for (RamDomain i = 0; i < 10; ++i) {
+        for (RamDomain j = 0; j < 10; ++j) {
+            RamDomain data[3] = {i, j, (i * j) % 7};
+            generic.insert(data);
+            specialised.insert(data);
+        }
+    }
+    EXPECT_EQ(specialised.size(), generic.size());
+
+    // both relations visit the tuples in the same order; the keys of the generic tuples are encoded
+    auto it = specialised.scan().begin();
+    for (const auto& tuple : generic.scan()) {
+        for (std::size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ((*it)[i], tuple.key(i));
+            EXPECT_EQ((*it)[i], tuple[fullOrder[i]]);
+        }
+        ++it;
+    }
+    EXPECT_TRUE(it == specialised.scan().end());
+
+    // copying between the relations preserves their contents
+    GenericRelation copy(3, "copy", indexSelection);
+    copy.insertAll(generic);
+    copy.insertAll(specialised);
+    EXPECT_EQ(generic.size(), copy.size());
+    for (const auto& tuple : specialised.scan()) {
+        RamDomain data[3];
+        for (std::size_t i = 0; i < 3; ++i) {
+            data[fullOrder[i]] = tuple[i];
+        }
+        EXPECT_TRUE(static_cast<const RelationWrapper&>(copy).contains(data));
+    }
+}
+
+namespace {
+
+/** Creates an index selection with a single full index of the given order */
+IndexCluster createIndexSelection(const LexOrder& fullOrder) {
+    SignatureOrderMap mapping;
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(fullOrder.size());
+    SearchSet searches = {existenceCheck};
+    OrderCollection orders = {fullOrder};
+    mapping.insert({existenceCheck, fullOrder});
+    return IndexCluster(mapping, searches, orders);
+}
+
+/** Obtains the natural order of the given arity */
+LexOrder naturalOrder(std::size_t arity) {
+    LexOrder order(arity);
+    std::iota(order.begin(), order.end(), 0);
+    return order;
+}
+
+}  // namespace
+
+TEST(Generic, ParallelInsert) {
+    const std::size_t arity = 3;
+    const RamDomain N = 10000;
+    GenericRelation rel(arity, "test", createIndexSelection({1, 2, 0}));
+    const RelationWrapper& wrapper = rel;
+
+    // every tuple is inserted twice, by arbitrary threads
+#pragma omp parallel for num_threads(4)
+    for (RamDomain i = 0; i < 2 * N; ++i) {
+        RamDomain data[arity] = {i % N, (i % N) / 100, (i % N) % 7};
+        rel.insert(data);
+    }
+    EXPECT_EQ(static_cast<std::size_t>(N), rel.size());
+
+    bool allPresent = true;
+    for (RamDomain i = 0; i < N; ++i) {
+        RamDomain data[arity] = {i, i / 100, i % 7};
+        allPresent = wrapper.contains(data) && allPresent;
+    }
+    EXPECT_TRUE(allPresent);
+
+    // the rows hold the inserted values
+    std::size_t count = 0;
+    bool allValid = true;
+    for (const RamDomain* t : wrapper) {
+        allValid = t[1] == t[0] / 100 && t[2] == t[0] % 7 && allValid;
+        ++count;
+    }
+    EXPECT_TRUE(allValid);
+    EXPECT_EQ(static_cast<std::size_t>(N), count);
+}
+
+TEST(Generic, ReclaimRows) {
+    GenericRows rows(2);
+
+    // the row of a rejected duplicate is reused even if other rows were allocated since
+    const std::size_t first = rows.allocate();
+    const std::size_t second = rows.allocate();
+    rows.reclaim(first);
+    EXPECT_EQ(first, rows.allocate());
+    EXPECT_EQ(second + 1, rows.allocate());
+}
+
+namespace {
+
+/**
+ * Runs the operations of the interpreter on the given relation, filled with the given tuples;
+ * returns whether they all gave the expected results
+ */
+template <typename Rel>
+bool checkOperations(Rel& rel, const std::vector<RamDomain>& in, const std::vector<RamDomain>& out) {
+    const std::size_t arity = rel.getArity();
+    const std::size_t count = in.size() / arity;
+    RelationWrapper& wrapper = rel;
+    for (std::size_t i = 0; i < in.size(); i += arity) {
+        wrapper.insert(&in[i]);
+    }
+    bool valid = count == rel.size();
+    std::size_t counter = 0;
+    for (const auto& tuple : rel.scan()) {
+        counter += (tuple[0] >= 0) ? 1 : 0;
+    }
+    valid = valid && count == counter;
+    for (std::size_t i = 0; i < in.size(); i += arity) {
+        valid = wrapper.contains(&in[i]) && valid;
+    }
+    for (std::size_t i = 0; i < out.size(); i += arity) {
+        valid = !wrapper.contains(&out[i]) && valid;
+    }
+    Rel copy(arity, "copy", createIndexSelection(naturalOrder(arity)));
+    copy.insertAll(rel);
+    return valid && count == copy.size();
+}
+
+/** Generates the given number of distinct tuples of the given arity, shuffled */
+std::vector<RamDomain> getTuples(std::size_t arity, std::size_t count, std::size_t offset) {
+    std::vector<RamDomain> res;
+    std::vector<std::size_t> perm(count);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::shuffle(perm.begin(), perm.end(), std::mt19937(42));
+    for (std::size_t i : perm) {
+        for (std::size_t j = 0; j < arity; ++j) {
+            // the leading columns repeat, as join columns do, the last one sets the tuples apart
+            const std::size_t value = (j + 1 == arity) ? i + offset : i % 97;
+            res.push_back(static_cast<RamDomain>(value));
+        }
+    }
+    return res;
+}
+
+/** A specialised relation, constructed like a generic one */
+template <std::size_t Arity>
+class Specialised : public Relation<Arity, 0, interpreter::Btree> {
+public:
+    Specialised(std::size_t, const std::string& name, const IndexCluster& indexSelection)
+            : Relation<Arity, 0, interpreter::Btree>(name, indexSelection) {}
+};
+
+template <std::size_t Arity>
+bool compareOperations(std::size_t count) {
+    const LexOrder order = naturalOrder(Arity);
+    const auto in = getTuples(Arity, count, 0);
+    const auto out = getTuples(Arity, count, count);
+    Specialised<Arity> specialised(Arity, "specialised", createIndexSelection(order));
+    GenericRelation generic(Arity, "generic", createIndexSelection(order));
+    return checkOperations(specialised, in, out) && checkOperations(generic, in, out);
+}
+
+}  // namespace
+
+TEST(Generic, Operations) {
+    // generic relations behave as the relations specialised to the same arity
+    EXPECT_TRUE(compareOperations<2>(5000));
+    EXPECT_TRUE(compareOperations<4>(5000));
+    EXPECT_TRUE(compareOperations<8>(5000));
+    EXPECT_TRUE(compareOperations<16>(5000));
+}
+
 }  // namespace souffle::interpreter::test
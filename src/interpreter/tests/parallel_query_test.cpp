@@ -0,0 +1,308 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file parallel_query_test.cpp
+ *
+ * Tests the evaluation of parallel queries by the Interpreter.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "Global.h"
+#include "RelationTag.h"
+#include "interpreter/Engine.h"
+#include "interpreter/ProgInterface.h"
+#include "ram/Break.h"
+#include "ram/ExistenceCheck.h"
+#include "ram/Expression.h"
+#include "ram/GuardedInsert.h"
+#include "ram/IO.h"
+#include "ram/IndexScan.h"
+#include "ram/Insert.h"
+#include "ram/Negation.h"
+#include "ram/ParallelScan.h"
+#include "ram/Program.h"
+#include "ram/Query.h"
+#include "ram/Relation.h"
+#include "ram/Scan.h"
+#include "ram/Sequence.h"
+#include "ram/SignedConstant.h"
+#include "ram/Statement.h"
+#include "ram/TranslationUnit.h"
+#include "ram/TupleElement.h"
+#include "ram/UndefValue.h"
+#include "reports/DebugReport.h"
+#include "reports/ErrorReport.h"
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/BTree.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/json11.h"
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace souffle::interpreter::test {
+
+using json11::Json;
+
+constexpr std::size_t NumThreads = 4;
+
+/** Directives reading the binary relation of the given name from stdin */
+std::map<std::string, std::string> stdinDirectives(const std::string& name) {
+    std::vector<std::string> attribsTypes = {"i", "i"};
+    Json types = Json::object{{"relation",
+            Json::object{{"arity", 2LL}, {"types", Json::array(attribsTypes.begin(), attribsTypes.end())}}}};
+    return {{"operation", "input"}, {"IO", "stdin"}, {"auxArity", "0"}, {"attributeNames", "x\ty"},
+            {"name", name}, {"types", types.dump()}};
+}
+
+/** Create a binary relation of signed attributes */
+Own<ram::Relation> mkBinaryRelation(const std::string& name) {
+    return mk<ram::Relation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+            std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE);
+}
+
+/** Run the given main statement, with relation edge read from the given input */
+template <typename Check>
+void runParallel(Global& glb, VecOwn<ram::Relation> rels, Own<ram::Statement> query,
+        const std::string& input, Check check) {
+    std::streambuf* backupCin = std::cin.rdbuf();
+    std::istringstream testInput(input);
+    std::cin.rdbuf(testInput.rdbuf());
+
+    glb.config().set("jobs", std::to_string(NumThreads));
+    Own<ram::Statement> main =
+            mk<ram::Sequence>(mk<ram::IO>("edge", stdinDirectives("edge")), std::move(query));
+    std::map<std::string, Own<ram::Statement>> subs;
+    Own<ram::Program> prog = mk<ram::Program>(std::move(rels), std::move(main), std::move(subs));
+
+    ErrorReport errReport;
+    DebugReport debugReport(glb);
+    ram::TranslationUnit translationUnit(glb, std::move(prog), errReport, debugReport);
+    Engine engine(translationUnit, NumThreads);
+    engine.executeMain();
+
+    std::cin.rdbuf(backupCin);
+
+    ProgInterface program(engine);
+    check(program);
+}
+
+/** The edges (i, i + 1) for i in [0, n) */
+std::string chain(RamSigned n) {
+    std::ostringstream input;
+    for (RamSigned i = 0; i < n; i++) {
+        input << i << "\t" << i + 1 << "\n";
+    }
+    return input.str();
+}
+
+TEST(ParallelQuery, InsertBuffers) {
+    const RamSigned N = 10000;
+
+    // out(y, x) :- edge(x, y), with the insertions of all threads buffered and merged at once
+    Global glb;
+    glb.config().set("insert-buffers");
+    VecOwn<ram::Relation> rels;
+    rels.push_back(mkBinaryRelation("edge"));
+    rels.push_back(mkBinaryRelation("out"));
+    VecOwn<ram::Expression> values;
+    values.push_back(mk<ram::TupleElement>(0, 1));
+    values.push_back(mk<ram::TupleElement>(0, 0));
+    auto query = mk<ram::Query>(mk<ram::ParallelScan>("edge", 0, mk<ram::Insert>("out", std::move(values))));
+
+    // the threads never insert into the same tree concurrently, hence never restart
+    const std::size_t restarts = souffle::detail::btreeLockRestarts();
+    runParallel(glb, std::move(rels), std::move(query), chain(N), [&](ProgInterface& program) {
+        EXPECT_EQ(restarts, souffle::detail::btreeLockRestarts());
+        souffle::Relation* out = program.getRelation("out");
+        ASSERT_TRUE(out != nullptr);
+        EXPECT_EQ(N, out->size());
+        for (RamSigned i = 0; i < N; i++) {
+            EXPECT_TRUE(program.contains(std::make_tuple(i + 1, i), out));
+        }
+    });
+}
+
+TEST(ParallelQuery, GuardedInsert) {
+    const RamSigned Keys = 1000;
+    const RamSigned Values = 16;
+
+    // out(x, y) :- edge(x, y), with x functionally determining y, i.e., only the first y of each x is kept
+    Global glb;
+    VecOwn<ram::Relation> rels;
+    rels.push_back(mkBinaryRelation("edge"));
+    rels.push_back(mkBinaryRelation("out"));
+    VecOwn<ram::Expression> values;
+    values.push_back(mk<ram::TupleElement>(0, 0));
+    values.push_back(mk<ram::TupleElement>(0, 1));
+    VecOwn<ram::Expression> key;
+    key.push_back(mk<ram::TupleElement>(0, 0));
+    key.push_back(mk<ram::UndefValue>());
+    auto guard = mk<ram::Negation>(mk<ram::ExistenceCheck>("out", std::move(key)));
+    auto query = mk<ram::Query>(mk<ram::ParallelScan>(
+            "edge", 0, mk<ram::GuardedInsert>("out", std::move(values), std::move(guard))));
+
+    std::ostringstream input;
+    for (RamSigned y = 0; y < Values; y++) {
+        for (RamSigned x = 0; x < Keys; x++) {
+            input << x << "\t" << y << "\n";
+        }
+    }
+
+    runParallel(glb, std::move(rels), std::move(query), input.str(), [&](ProgInterface& program) {
+        souffle::Relation* out = program.getRelation("out");
+        ASSERT_TRUE(out != nullptr);
+        EXPECT_EQ(Keys, out->size());
+        std::set<RamSigned> keys;
+        for (auto tuple : *out) {
+            RamSigned x;
+            RamSigned y;
+            tuple >> x >> y;
+            EXPECT_TRUE(0 <= y && y < Values);
+            EXPECT_TRUE(keys.insert(x).second);
+        }
+        EXPECT_EQ(Keys, keys.size());
+    });
+}
+
+TEST(ParallelQuery, SplitNestedLoop) {
+    const RamSigned Keys = 3;
+    const RamSigned N = 2000;
+
+    // the outer loops over seed have too few tuples to keep the threads busy, hence share the nested loops
+    Global glb;
+    VecOwn<ram::Relation> rels;
+    rels.push_back(mkBinaryRelation("edge"));
+    rels.push_back(mkBinaryRelation("seed"));
+    rels.push_back(mkBinaryRelation("product"));
+    rels.push_back(mkBinaryRelation("join"));
+    VecOwn<ram::Statement> queries;
+    for (RamSigned k = 0; k < Keys; k++) {
+        VecOwn<ram::Expression> values;
+        values.push_back(mk<ram::SignedConstant>(k));
+        values.push_back(mk<ram::SignedConstant>(k));
+        queries.push_back(mk<ram::Query>(mk<ram::Insert>("seed", std::move(values))));
+    }
+
+    // product(x, z) :- seed(x, _), edge(_, z).
+    VecOwn<ram::Expression> product;
+    product.push_back(mk<ram::TupleElement>(0, 0));
+    product.push_back(mk<ram::TupleElement>(1, 1));
+    queries.push_back(mk<ram::Query>(mk<ram::ParallelScan>(
+            "seed", 0, mk<ram::Scan>("edge", 1, mk<ram::Insert>("product", std::move(product))))));
+
+    // join(z, x) :- seed(x, _), edge(x, z).
+    VecOwn<ram::Expression> join;
+    join.push_back(mk<ram::TupleElement>(1, 1));
+    join.push_back(mk<ram::TupleElement>(0, 0));
+    ram::RamBound low;
+    low.push_back(mk<ram::TupleElement>(0, 0));
+    low.push_back(mk<ram::UndefValue>());
+    ram::RamBound high;
+    high.push_back(mk<ram::TupleElement>(0, 0));
+    high.push_back(mk<ram::UndefValue>());
+    queries.push_back(mk<ram::Query>(mk<ram::ParallelScan>("seed", 0,
+            mk<ram::IndexScan>("edge", 1, ram::RamPattern(std::move(low), std::move(high)),
+                    mk<ram::Insert>("join", std::move(join))))));
+
+    std::ostringstream input;
+    for (RamSigned x = 0; x <= Keys; x++) {
+        for (RamSigned z = 0; z < N; z++) {
+            input << x << "\t" << z << "\n";
+        }
+    }
+
+    runParallel(glb, std::move(rels), mk<ram::Sequence>(std::move(queries)), input.str(),
+            [&](ProgInterface& program) {
+                souffle::Relation* product = program.getRelation("product");
+                souffle::Relation* join = program.getRelation("join");
+                ASSERT_TRUE(product != nullptr && join != nullptr);
+                EXPECT_EQ(Keys * N, product->size());
+                EXPECT_EQ(Keys * N, join->size());
+                for (RamSigned x = 0; x < Keys; x++) {
+                    for (RamSigned z = 0; z < N; z++) {
+                        EXPECT_TRUE(program.contains(std::make_tuple(x, z), product));
+                        EXPECT_TRUE(program.contains(std::make_tuple(z, x), join));
+                    }
+                }
+            });
+}
+
+TEST(ParallelQuery, SplitNestedLoopBreak) {
+    const RamSigned Keys = 3;
+    const RamSigned N = 2000;
+
+    // first(x, z) :- seed(x, _), edge(x, z), with the nested loop left once first has a tuple for x
+    Global glb;
+    VecOwn<ram::Relation> rels;
+    rels.push_back(mkBinaryRelation("edge"));
+    rels.push_back(mkBinaryRelation("seed"));
+    rels.push_back(mkBinaryRelation("first"));
+    VecOwn<ram::Statement> queries;
+    for (RamSigned k = 0; k < Keys; k++) {
+        VecOwn<ram::Expression> values;
+        values.push_back(mk<ram::SignedConstant>(k));
+        values.push_back(mk<ram::SignedConstant>(k));
+        queries.push_back(mk<ram::Query>(mk<ram::Insert>("seed", std::move(values))));
+    }
+    VecOwn<ram::Expression> values;
+    values.push_back(mk<ram::TupleElement>(0, 0));
+    values.push_back(mk<ram::TupleElement>(1, 1));
+    VecOwn<ram::Expression> key;
+    key.push_back(mk<ram::TupleElement>(0, 0));
+    key.push_back(mk<ram::UndefValue>());
+    ram::RamBound low;
+    low.push_back(mk<ram::TupleElement>(0, 0));
+    low.push_back(mk<ram::UndefValue>());
+    ram::RamBound high;
+    high.push_back(mk<ram::TupleElement>(0, 0));
+    high.push_back(mk<ram::UndefValue>());
+    queries.push_back(mk<ram::Query>(mk<ram::ParallelScan>("seed", 0,
+            mk<ram::IndexScan>("edge", 1, ram::RamPattern(std::move(low), std::move(high)),
+                    mk<ram::Break>(mk<ram::ExistenceCheck>("first", std::move(key)),
+                            mk<ram::Insert>("first", std::move(values)))))));
+
+    std::ostringstream input;
+    for (RamSigned x = 0; x <= Keys; x++) {
+        for (RamSigned z = 0; z < N; z++) {
+            input << x << "\t" << z << "\n";
+        }
+    }
+
+    // threads that passed the check before the first insertion may still insert, but no thread goes on
+    runParallel(glb, std::move(rels), mk<ram::Sequence>(std::move(queries)), input.str(),
+            [&](ProgInterface& program) {
+                souffle::Relation* first = program.getRelation("first");
+                ASSERT_TRUE(first != nullptr);
+                std::map<RamSigned, std::size_t> counts;
+                for (auto tuple : *first) {
+                    RamSigned x;
+                    RamSigned z;
+                    tuple >> x >> z;
+                    counts[x]++;
+                }
+                EXPECT_EQ(Keys, counts.size());
+                for (const auto& [x, count] : counts) {
+                    EXPECT_TRUE(0 <= x && x < Keys);
+                    EXPECT_TRUE(1 <= count && count <= NumThreads);
+                }
+            });
+}
+
+}  // namespace souffle::interpreter::test
@@ -19,6 +19,7 @@
 #include "Global.h"
 #include "RelationTag.h"
 #include "interpreter/Engine.h"
+#include "interpreter/ProgInterface.h"
 #include "ram/Expression.h"
 #include "ram/IO.h"
 #include "ram/Insert.h"
@@ -625,4 +626,53 @@ meow	-3	3	0.5
     std::cin.rdbuf(backupCin);
 }
 
+/** A program reading relation test with attributes of all primitive types from stdin */
+Own<Program> makeSnapshotProgram() {
+    std::vector<std::string> attribs = {"l", "u", "b", "a"};
+    std::vector<std::string> attribsTypes = {"s", "i", "u", "f"};
+    VecOwn<ram::Relation> rels;
+    rels.push_back(mk<ram::Relation>("test", 4, 0, attribs, attribsTypes, RelationRepresentation::BTREE));
+
+    Json types = Json::object{
+            {"relation", Json::object{{"arity", static_cast<long long>(attribsTypes.size())},
+                                 {"types", Json::array(attribsTypes.begin(), attribsTypes.end())}}}};
+    std::map<std::string, std::string> readDirs = {{"operation", "input"}, {"IO", "stdin"}, {"auxArity", "0"},
+            {"attributeNames", "l\tu\tb\ta"}, {"name", "test"}, {"types", types.dump()}};
+
+    std::map<std::string, Own<Statement>> subs;
+    return mk<Program>(std::move(rels), mk<ram::Sequence>(mk<ram::IO>("test", readDirs)), std::move(subs));
+}
+
+TEST(Snapshot, RoundTrip) {
+    std::streambuf* backupCin = std::cin.rdbuf();
+    std::istringstream testInput("meow\t-3\t3\t0.5\nwoof\t7\t1\t-1.5\n");
+    std::cin.rdbuf(testInput.rdbuf());
+
+    Global glb;
+    glb.config().set("jobs", "1");
+    ErrorReport errReport;
+    DebugReport debugReport(glb);
+
+    TranslationUnit savedUnit(glb, makeSnapshotProgram(), errReport, debugReport);
+    Engine saved(savedUnit, 1);
+    saved.executeMain();
+    saved.saveSnapshot("ram_relation_test.snapshot");
+
+    std::cin.rdbuf(backupCin);
+
+    TranslationUnit restoredUnit(glb, makeSnapshotProgram(), errReport, debugReport);
+    Engine restored(restoredUnit, 1);
+    restored.loadSnapshot("ram_relation_test.snapshot");
+
+    ProgInterface program(restored);
+    souffle::Relation* rel = program.getRelation("test");
+    ASSERT_TRUE(rel != nullptr);
+    EXPECT_EQ(2, rel->size());
+    EXPECT_TRUE(program.contains(
+            std::make_tuple(std::string("meow"), RamSigned(-3), RamUnsigned(3), RamFloat(0.5)), rel));
+    EXPECT_TRUE(program.contains(
+            std::make_tuple(std::string("woof"), RamSigned(7), RamUnsigned(1), RamFloat(-1.5)), rel));
+    EXPECT_EQ(saved.getSymbolTable().decode(0), restored.getSymbolTable().decode(0));
+}
+
 }  // namespace souffle::interpreter::test
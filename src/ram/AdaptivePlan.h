@@ -0,0 +1,91 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file AdaptivePlan.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/ListStatement.h"
+#include "ram/Node.h"
+#include "ram/Statement.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include "souffle/utility/StringUtil.h"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram {
+
+/**
+ * @class AdaptivePlan
+ * @brief Alternative plans of a rule, of which one is executed
+ *
+ * The plans compute the same result with different join orders. Each time
+ * the statement is executed, the evaluation chooses one of them, e.g. based
+ * on the current sizes of the relations. The first plan is the one chosen
+ * at compile time. If the message is not empty, the choices are logged to
+ * the profile with it.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * ADAPTIVE PLAN "..."
+ *  QUERY
+ *   ...
+ *  QUERY
+ *   ...
+ * END ADAPTIVE PLAN
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class AdaptivePlan : public ListStatement {
+public:
+    AdaptivePlan(VecOwn<Statement> plans, std::string msg)
+            : ListStatement(NK_AdaptivePlan, std::move(plans)), message(std::move(msg)) {}
+
+    /** @brief Get the profile message */
+    const std::string& getMessage() const {
+        return message;
+    }
+
+    AdaptivePlan* cloning() const override {
+        VecOwn<Statement> plans;
+        for (auto& cur : statements) {
+            plans.push_back(clone(cur));
+        }
+        return new AdaptivePlan(std::move(plans), message);
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_AdaptivePlan;
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "ADAPTIVE PLAN \"" << stringify(message) << "\"" << std::endl;
+        for (auto const& stmt : statements) {
+            Statement::print(stmt.get(), os, tabpos + 1);
+        }
+        os << times(" ", tabpos) << "END ADAPTIVE PLAN" << std::endl;
+    }
+
+    bool equal(const Node& node) const override {
+        const auto& other = asAssert<AdaptivePlan>(node);
+        return ListStatement::equal(other) && message == other.message;
+    }
+
+    /** Profile message */
+    const std::string message;
+};
+
+}  // namespace souffle::ram
@@ -0,0 +1,74 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file MergeInsert.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/BinRelationStatement.h"
+#include "ram/Relation.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace souffle::ram {
+
+/**
+ * @class MergeInsert
+ * @brief Insert all tuples of the source relation into the target relation
+ *
+ * Both relations must share the same signature. In contrast to a
+ * query scanning the source relation and inserting tuple by tuple,
+ * the tuples are merged into the indexes of the target relation
+ * as sorted batches.
+ *
+ * The following example inserts all tuples of A into B:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * MERGE-INSERT B WITH A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class MergeInsert : public BinRelationStatement {
+public:
+    MergeInsert(std::string tRef, const std::string& sRef)
+            : BinRelationStatement(NK_MergeInsert, sRef, tRef) {}
+
+    /** @brief Get source relation */
+    const std::string& getSourceRelation() const {
+        return getFirstRelation();
+    }
+
+    /** @brief Get target relation */
+    const std::string& getTargetRelation() const {
+        return getSecondRelation();
+    }
+
+    MergeInsert* cloning() const override {
+        auto* res = new MergeInsert(second, first);
+        return res;
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_MergeInsert;
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "MERGE-INSERT " << getTargetRelation() << " WITH " << getSourceRelation();
+        os << std::endl;
+    }
+};
+
+}  // namespace souffle::ram
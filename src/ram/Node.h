@@ -174,6 +174,7 @@ public:
 
             NK_BinRelationStatement,
                 NK_MergeExtend,
+                NK_MergeInsert,
                 NK_Swap,
             NK_LastBinRelationStatement,
 
@@ -181,6 +182,7 @@ public:
             NK_DebugInfo,
             NK_Exit,
             NK_ListStatement,
+                NK_AdaptivePlan,
                 NK_Parallel,
                 NK_Sequence,
             NK_LastListStatement,
@@ -18,6 +18,7 @@
 
 #include "FunctorOps.h"
 #include "RelationTag.h"
+#include "ram/AdaptivePlan.h"
 #include "ram/Break.h"
 #include "ram/Clear.h"
 #include "ram/Condition.h"
@@ -36,6 +37,7 @@
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
 #include "ram/MergeExtend.h"
+#include "ram/MergeInsert.h"
 #include "ram/Negation.h"
 #include "ram/Operation.h"
 #include "ram/Parallel.h"
@@ -107,6 +109,21 @@ TEST(MergeExtend, CloneAndEquals) {
     delete c;
 }
 
+TEST(MergeInsert, CloneAndEquals) {
+    // MERGE-INSERT B WITH A
+    Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    Relation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    MergeInsert a("B", "A");
+    MergeInsert b("B", "A");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    MergeInsert* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(Swap, CloneAndEquals) {
     // SWAP(A,B)
     Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
@@ -264,6 +281,58 @@ TEST(Parallel, CloneAndEquals) {
     EXPECT_NE(&a, c);
     delete c;
 }
+TEST(AdaptivePlan, CloneAndEquals) {
+    Relation A("A", 2, 1, {"a", "b"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    Relation B("B", 2, 1, {"a", "b"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+    Relation C("C", 2, 1, {"a", "b"}, {"i", "i"}, RelationRepresentation::DEFAULT);
+
+    /* ADAPTIVE PLAN "plan"
+     *  QUERY
+     *   FOR t0 IN A
+     *    FOR t1 IN B
+     *     IF (t0.1 = t1.0)
+     *      INSERT (t0.0, t1.1) INTO C
+     *  QUERY
+     *   FOR t0 IN B
+     *    FOR t1 IN A
+     *     IF (t1.1 = t0.0)
+     *      INSERT (t1.0, t0.1) INTO C
+     * END ADAPTIVE PLAN
+     * */
+    auto makePlan = [](const std::string& outer, const std::string& inner, std::size_t aLevel) {
+        const std::size_t bLevel = 1 - aLevel;
+        VecOwn<Expression> expressions;
+        expressions.emplace_back(new TupleElement(aLevel, 0));
+        expressions.emplace_back(new TupleElement(bLevel, 1));
+        auto insert = mk<Insert>("C", std::move(expressions));
+        auto cond = mk<Filter>(mk<Constraint>(BinaryConstraintOp::EQ, mk<TupleElement>(aLevel, 1),
+                                       mk<TupleElement>(bLevel, 0)),
+                std::move(insert), "");
+        auto innerScan = mk<Scan>(inner, 1, std::move(cond), "");
+        return mk<Query>(mk<Scan>(outer, 0, std::move(innerScan), ""));
+    };
+    auto makeAdaptivePlan = [&](const std::string& message) {
+        VecOwn<Statement> plans;
+        plans.push_back(makePlan("A", "B", 0));
+        plans.push_back(makePlan("B", "A", 1));
+        return AdaptivePlan(std::move(plans), message);
+    };
+
+    AdaptivePlan a = makeAdaptivePlan("plan");
+    AdaptivePlan b = makeAdaptivePlan("plan");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    AdaptivePlan* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+
+    // the message is part of the statement
+    AdaptivePlan d = makeAdaptivePlan("other plan");
+    EXPECT_NE(a, d);
+}
+
 TEST(Loop, CloneAndEquals) {
     Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
     Relation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
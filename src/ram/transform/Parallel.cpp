@@ -39,9 +39,8 @@ bool ParallelTransformer::parallelizeOperations(Program& program) {
     // parallelize the most outer loop only
     // most outer loops can be scan/if-exists/indexScan/indexIfExists
     forEachQuery(program, [&](Query& query) {
-        // guardedInsert cannot be parallelized
-        if (visitExists(query, [&](const GuardedInsert&) { return true; })) return;
-        // erase cannot be parallelized
+        // erase cannot be parallelized; the deletion sets it consumes are computed
+        // by separate queries, which are parallelized
         if (visitExists(query, [&](const Erase&) { return true; })) return;
 
         query.apply(nodeMapper<Node>([&](auto&& go, Own<Node> node) -> Own<Node> {
@@ -20,6 +20,7 @@
 #include "ram/AbstractConditional.h"
 #include "ram/AbstractExistenceCheck.h"
 #include "ram/AbstractOperator.h"
+#include "ram/AdaptivePlan.h"
 #include "ram/Aggregate.h"
 #include "ram/Aggregator.h"
 #include "ram/Assign.h"
@@ -56,6 +57,7 @@
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
 #include "ram/MergeExtend.h"
+#include "ram/MergeInsert.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
 #include "ram/NestedOperation.h"
@@ -177,12 +179,14 @@ struct Visitor : souffle::detail::VisitorBase<R, NodeType, Params...> {
 
         SOUFFLE_VISITOR_FORWARD(Swap);
         SOUFFLE_VISITOR_FORWARD(MergeExtend);
+        SOUFFLE_VISITOR_FORWARD(MergeInsert);
 
         // Control-flow
         SOUFFLE_VISITOR_FORWARD(Program);
         SOUFFLE_VISITOR_FORWARD(Sequence);
         SOUFFLE_VISITOR_FORWARD(Loop);
         SOUFFLE_VISITOR_FORWARD(Parallel);
+        SOUFFLE_VISITOR_FORWARD(AdaptivePlan);
         SOUFFLE_VISITOR_FORWARD(Exit);
         SOUFFLE_VISITOR_FORWARD(LogTimer);
         SOUFFLE_VISITOR_FORWARD(LogRelationTimer);
@@ -206,8 +210,10 @@ protected:
 
     SOUFFLE_VISITOR_LINK(Swap, BinRelationStatement);
     SOUFFLE_VISITOR_LINK(MergeExtend, BinRelationStatement);
+    SOUFFLE_VISITOR_LINK(MergeInsert, BinRelationStatement);
     SOUFFLE_VISITOR_LINK(BinRelationStatement, Statement);
 
+    SOUFFLE_VISITOR_LINK(AdaptivePlan, ListStatement);
     SOUFFLE_VISITOR_LINK(Sequence, ListStatement);
     SOUFFLE_VISITOR_LINK(Loop, Statement);
     SOUFFLE_VISITOR_LINK(Parallel, ListStatement);
@@ -169,6 +169,11 @@ void DirectRelation::computeIndices() {
     computedIndices = inds;
 }
 
+/** Direct relations without auxiliary attributes or deletion merge batches into their btrees */
+bool DirectRelation::hasInsertAll() const {
+    return !hasAuxiliary && !hasErase;
+}
+
 /** Generate type name of a direct indexed relation */
 std::string DirectRelation::getTypeNamespace() {
     // collect all attributes used in the lex-order
@@ -447,6 +452,58 @@ void DirectRelation::generateTypeStruct(GenDb& db) {
     def << "return insert(data);\n";
     def << "}\n";  // end of insert(RamDomain x1, RamDomain x2, ...)
 
+    // bulk insertion of another relation as sorted batches
+    if (hasInsertAll()) {
+        decl << "template <typename Other>\n";
+        decl << "void insertAll(const Other& other) {\n";
+        decl << "std::vector<t_tuple> tuples;\n";
+        decl << "tuples.reserve(other.size());\n";
+        decl << "for (const auto& tuple : other) {\n";
+        decl << "tuples.push_back(t_tuple(tuple));\n";
+        decl << "}\n";
+        decl << "insertBatch(tuples);\n";
+        decl << "}\n";  // end of insertAll(const Other&)
+
+        decl << "void insertBatch(std::vector<t_tuple>& tuples);\n";
+
+        // batches of tuples stored one after another, as produced by readers
+        decl << "void insertBatch(std::vector<RamDomain>& data) {\n";
+        decl << "std::vector<t_tuple> tuples(data.size() / " << arity << ");\n";
+        decl << "for (std::size_t i = 0; i < tuples.size(); ++i) {\n";
+        decl << "std::copy_n(data.begin() + i * " << arity << ", " << arity << ", tuples[i].begin());\n";
+        decl << "}\n";
+        decl << "insertBatch(tuples);\n";
+        decl << "}\n";  // end of insertBatch(std::vector<RamDomain>&)
+        def << "void Type::insertBatch(std::vector<t_tuple>& tuples) {\n";
+        def << "t_comparator_" << masterIndex << " cmp_" << masterIndex << ";\n";
+        def << "auto less_" << masterIndex << " = [&](const t_tuple& a, const t_tuple& b) { return cmp_"
+            << masterIndex << ".less(a, b); };\n";
+        def << "if (!std::is_sorted(tuples.begin(), tuples.end(), less_" << masterIndex << ")) {\n";
+        def << "std::sort(tuples.begin(), tuples.end(), less_" << masterIndex << ");\n";
+        def << "}\n";
+        // batches collected from several sources may hold duplicates
+        def << "tuples.erase(std::unique(tuples.begin(), tuples.end(), [&](const t_tuple& a, const t_tuple& b) "
+            << "{ return cmp_" << masterIndex << ".equal(a, b); }), tuples.end());\n";
+        // secondary indexes may be multisets, hence only the tuples not yet present are merged
+        def << "context h;\n";
+        def << "tuples.erase(std::remove_if(tuples.begin(), tuples.end(), [&](const t_tuple& t) { return ind_"
+            << masterIndex << ".contains(t, h.hints_" << masterIndex << "_lower); }), tuples.end());\n";
+        def << "ind_" << masterIndex << ".insertSorted(tuples.begin(), tuples.end());\n";
+        for (std::size_t i = 0; i < numIndexes; i++) {
+            if (i == masterIndex) {
+                continue;
+            }
+            // an index ordered by a prefix of the master index receives the tuples in master order
+            const auto& ind = inds[i];
+            if (std::equal(ind.begin(), ind.end(), inds[masterIndex].begin())) {
+                def << "ind_" << i << ".insertSorted(tuples.begin(), tuples.end());\n";
+            } else {
+                def << "ind_" << i << ".insertAll(tuples.begin(), tuples.end());\n";
+            }
+        }
+        def << "}\n";  // end of insertBatch(std::vector<t_tuple>&)
+    }
+
     // contains methods
     decl << "bool contains(const t_tuple& t, context& h) const;\n";
     def << "bool Type::contains(const t_tuple& t, context& h) const {\n";
@@ -68,6 +68,11 @@ public:
     /** Generate relation type struct */
     virtual void generateTypeStruct(GenDb& db) = 0;
 
+    /** Whether the relation type provides insertAll, inserting another relation as sorted batches */
+    virtual bool hasInsertAll() const {
+        return false;
+    }
+
     /** Factory method to generate a SynthesiserRelation */
     static Own<Relation> getSynthesiserRelation(
             const ram::Relation& ramRel, const ram::analysis::IndexCluster& indexSelection);
@@ -123,6 +128,7 @@ public:
     std::string getTypeNamespace();
     std::string getTypeName() override;
     void generateTypeStruct(GenDb& db) override;
+    bool hasInsertAll() const override;
 
 private:
     const bool hasAuxiliary;
@@ -21,9 +21,13 @@
 #include "Global.h"
 #include "RelationTag.h"
 #include "config.h"
+#include "ram/AbstractAggregate.h"
+#include "ram/AbstractExistenceCheck.h"
 #include "ram/AbstractParallel.h"
+#include "ram/AdaptivePlan.h"
 #include "ram/Aggregate.h"
 #include "ram/Aggregator.h"
+#include "ram/Assign.h"
 #include "ram/AutoIncrement.h"
 #include "ram/Break.h"
 #include "ram/Call.h"
@@ -53,6 +57,7 @@
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
 #include "ram/MergeExtend.h"
+#include "ram/MergeInsert.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
 #include "ram/NestedOperation.h"
@@ -112,6 +117,7 @@
 #include <iterator>
 #include <limits>
 #include <map>
+#include <set>
 #include <sstream>
 #include <tuple>
 #include <type_traits>
@@ -274,6 +280,43 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
         std::ostringstream preamble;
         bool preambleIssued = false;
 
+        // relations whose insertions are collected in thread-local buffers in the current query
+        std::set<std::string> bufferedRelations;
+
+        // relations whose guarded insertions are serialised between the threads of the current query
+        std::set<std::string> guardedRelations;
+
+        // relations inserted into but not read by the given operation, which support batch insertion
+        std::set<std::string> getBufferableRelations(const Operation& op) {
+            std::set<std::string> inserted;
+            std::set<std::string> accessed;
+            visit(op, [&](const Node& node) {
+                if (const auto* insert = as<Insert>(node)) {
+                    inserted.insert(insert->getRelation());
+                } else if (const auto* erase = as<Erase>(node)) {
+                    accessed.insert(erase->getRelation());
+                } else if (const auto* scan = as<RelationOperation>(node)) {
+                    accessed.insert(scan->getRelation());
+                } else if (const auto* exists = as<AbstractExistenceCheck>(node)) {
+                    accessed.insert(exists->getRelation());
+                } else if (const auto* emptiness = as<EmptinessCheck>(node)) {
+                    accessed.insert(emptiness->getRelation());
+                } else if (const auto* size = as<RelationSize>(node)) {
+                    accessed.insert(size->getRelation());
+                }
+            });
+
+            std::set<std::string> res;
+            for (const auto& name : inserted) {
+                const auto* rel = synthesiser.lookup(name);
+                auto relationType = Relation::getSynthesiserRelation(*rel, isa->getIndexSelection(name));
+                if (!contains(accessed, name) && rel->getArity() > 0 && relationType->hasInsertAll()) {
+                    res.insert(name);
+                }
+            }
+            return res;
+        }
+
     public:
         CodeEmitter(Synthesiser& syn) : synthesiser(syn), glb(synthesiser.glb) {
             rec = [&](auto& out, const auto* value) {
@@ -290,6 +333,19 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             };
         }
 
+        // insert the tuple into the relation or into its local buffer unless already present
+        void emitInsert(const ram::Relation& rel, const std::string& ctxName, std::ostream& out) {
+            const auto& relName = synthesiser.getRelationName(rel);
+            if (contains(bufferedRelations, rel.getName())) {
+                out << "if (!" << relName << "->contains(tuple," << ctxName << ")) {\n";
+                out << relName << "_local_buffer.push_back(tuple);\n";
+                out << "}\n";
+            } else {
+                out << relName << "->"
+                    << "insert(tuple," << ctxName << ");\n";
+            }
+        }
+
         std::pair<std::stringstream, std::stringstream> getPaddedRangeBounds(const ram::Relation& rel,
                 const std::vector<Expression*>& rangePatternLower,
                 const std::vector<Expression*>& rangePatternUpper) {
@@ -467,6 +523,32 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 preamble << "->createContext());\n";
             }
 
+            // threads collect the tuples of relations not read by this operation in local buffers
+            bufferedRelations.clear();
+            if (isParallel && glb.config().has("insert-buffers")) {
+                bufferedRelations = getBufferableRelations(*next);
+            }
+            for (const auto& name : bufferedRelations) {
+                const auto* rel = synthesiser.lookup(name);
+                const auto& relName = synthesiser.getRelationName(rel);
+                out << "std::vector<Tuple<RamDomain," << rel->getArity() << ">> " << relName << "_buffer;\n";
+                out << "Lock " << relName << "_buffer_lock;\n";
+                preamble << "std::vector<Tuple<RamDomain," << rel->getArity() << ">> " << relName
+                         << "_local_buffer;\n";
+            }
+
+            // threads check the guard of a guarded insertion and insert as one step
+            guardedRelations.clear();
+            if (isParallel) {
+                visit(*next, [&](const GuardedInsert& guardedInsert) {
+                    guardedRelations.insert(guardedInsert.getRelation());
+                });
+            }
+            for (const auto& name : guardedRelations) {
+                out << "StripedLock " << synthesiser.getRelationName(synthesiser.lookup(name))
+                    << "_guard_lock;\n";
+            }
+
             // discharge conditions that require a context
             if (isParallel) {
                 if (requireCtx.size() > 0) {
@@ -491,10 +573,28 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 }
             }
 
+            // hand the local buffers over to the shared ones
+            for (const auto& name : bufferedRelations) {
+                const auto& relName = synthesiser.getRelationName(synthesiser.lookup(name));
+                out << "{\n";
+                out << "auto lease = " << relName << "_buffer_lock.acquire();\n";
+                out << relName << "_buffer.insert(" << relName << "_buffer.end(), " << relName
+                    << "_local_buffer.begin(), " << relName << "_local_buffer.end());\n";
+                out << "}\n";
+            }
+
             if (isParallel) {
                 out << "PARALLEL_END\n";  // end parallel
             }
 
+            // merge the collected tuples as one batch
+            for (const auto& name : bufferedRelations) {
+                const auto& relName = synthesiser.getRelationName(synthesiser.lookup(name));
+                out << relName << "->insertBatch(" << relName << "_buffer);\n";
+            }
+            bufferedRelations.clear();
+            guardedRelations.clear();
+
             out << "}\n";
             out << "();";  // call lambda
 
@@ -512,6 +612,14 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             bool isIntermediate =
                     !contains(synthesiser.storeRelations, Relation->getName()) && !Relation->isTemp();
 
+            // incremental programs keep expired relations, so their relations are only
+            // cleared to be recomputed
+            if (glb.config().has("incremental")) {
+                out << synthesiser.getRelationName(Relation) << "->purge();\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
             if (isIntermediate) {
                 out << "if (pruneImdtRels) ";
             }
@@ -540,6 +648,13 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visit_(type_identity<AdaptivePlan>, const AdaptivePlan& plan, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            // there are no run-time statistics to choose from => use the plan chosen at compile time
+            dispatch(*plan.getStatements().front(), out);
+            PRINT_END_COMMENT(out);
+        }
+
         void visit_(type_identity<Parallel>, const Parallel& parallel, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             auto stmts = parallel.getStatements();
@@ -557,6 +672,19 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 return;
             }
 
+            // loops share the iteration counter and exits/assignments affect the
+            // enclosing statements => keep them in sequence
+            bool concurrent = !visitExists(parallel, [](const Node& node) {
+                return isA<Loop>(node) || isA<Exit>(node) || isA<Assign>(node);
+            });
+            if (!concurrent) {
+                for (const auto& cur : stmts) {
+                    dispatch(*cur, out);
+                }
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
             // more than one => parallel sections
 
             // start parallel section
@@ -616,6 +744,52 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visit_(type_identity<MergeInsert>, const MergeInsert& merge, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto* source = synthesiser.lookup(merge.getSourceRelation());
+            const auto* target = synthesiser.lookup(merge.getTargetRelation());
+            const auto& sourceName = synthesiser.getRelationName(source);
+            const auto& targetName = synthesiser.getRelationName(target);
+            auto relationType =
+                    Relation::getSynthesiserRelation(*target, isa->getIndexSelection(target->getName()));
+
+            if (relationType->hasInsertAll()) {
+                out << targetName << "->insertAll(*" << sourceName << ");\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+
+            // insert the partitions of the source relation in parallel
+            out << "{\n";
+            out << "auto part = " << sourceName << "->partition();\n";
+            out << "PARALLEL_START\n";
+            out << "CREATE_OP_CONTEXT(" << synthesiser.getOpContextName(*target) << "," << targetName
+                << "->createContext());\n";
+            out << R"cpp(
+                   #if defined _OPENMP && _OPENMP < 200805
+                           auto count = std::distance(part.begin(), part.end());
+                           auto base = part.begin();
+                           pfor(int index  = 0; index < count; index++) {
+                               auto it = base + index;
+                   #else
+                           pfor(auto it = part.begin(); it < part.end(); it++) {
+                   #endif
+                   )cpp";
+            out << "for(const auto& env0 : *it) {\n";
+            out << "Tuple<RamDomain," << target->getArity() << "> tuple{{";
+            for (std::size_t i = 0; i < target->getArity(); i++) {
+                out << (i > 0 ? "," : "") << "env0[" << i << "]";
+            }
+            out << "}};\n";
+            out << targetName << "->insert(tuple,READ_OP_CONTEXT(" << synthesiser.getOpContextName(*target)
+                << "));\n";
+            out << "}\n";
+            out << "}\n";
+            out << "PARALLEL_END\n";
+            out << "}\n";
+            PRINT_END_COMMENT(out);
+        }
+
         void visit_(type_identity<Exit>, const Exit& exit, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             out << "if(";
@@ -695,6 +869,11 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
 
         void visit_(type_identity<TupleOperation>, const TupleOperation& search, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
+            // the tuples bound by scans are counted along with the performance counters
+            if (glb.config().has("profile") && glb.config().has("profile-counters") &&
+                    isA<RelationOperation>(search) && !isA<AbstractAggregate, AllowCrossCast>(search)) {
+                out << "profile::PerfCounters::countTuple();\n";
+            }
             visit_(type_identity<NestedOperation>(), search, out);
             PRINT_END_COMMENT(out);
         }
@@ -712,19 +891,10 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
 
             PRINT_BEGIN_COMMENT(out);
 
-            out << "auto part = " << relName << "->partition();\n";
+            out << "WorkStealingRange part(" << relName << "->partition());\n";
             out << "PARALLEL_START\n";
             out << preamble.str();
-            out << R"cpp(
-                   #if defined _OPENMP && _OPENMP < 200805
-                           auto count = std::distance(part.begin(), part.end());
-                           auto base = part.begin();
-                           pfor(int index  = 0; index < count; index++) {
-                               auto it = base + index;
-                   #else
-                           pfor(auto it = part.begin(); it < part.end(); it++) {
-                   #endif
-                   )cpp";
+            out << "while (auto it = part.next()) {\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
 
@@ -996,19 +1166,10 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 // TODO (b-scholz): context may be missing here?
                 << "lowerUpperRange_" << keys << "(" << rangeBounds.first.str() << ","
                 << rangeBounds.second.str() << ");\n";
-            out << "auto part = range.partition();\n";
+            out << "WorkStealingRange part(range);\n";
             out << "PARALLEL_START\n";
             out << preamble.str();
-            out << R"cpp(
-                   #if defined _OPENMP && _OPENMP < 200805
-                           auto count = std::distance(part.begin(), part.end());
-                           auto base = part.begin();
-                           pfor(int index  = 0; index < count; index++) {
-                               auto it = base + index;
-                   #else
-                           pfor(auto it = part.begin(); it < part.end(); it++) {
-                   #endif
-                   )cpp";
+            out << "while (auto it = part.next()) {\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
 
@@ -1757,25 +1918,53 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_BEGIN_COMMENT(out);
             const auto* rel = synthesiser.lookup(guardedInsert.getRelation());
             auto arity = rel->getArity();
-            auto relName = synthesiser.getRelationName(rel);
             auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(*rel) + ")";
 
             auto condition = guardedInsert.getCondition();
-            // guarded conditions
-            out << "if( ";
-            dispatch(*condition, out);
-            out << ") {\n";
+            bool isSerialised = contains(guardedRelations, rel->getName());
 
             // create inserted tuple
+            out << "{\n";
             out << "Tuple<RamDomain," << arity << "> tuple{{" << join(guardedInsert.getValues(), ",", rec)
                 << "}};\n";
 
+            // lock the stripes of the columns on which the guard looks up existing tuples
+            if (isSerialised) {
+                std::vector<std::string> stripes;
+                visit(*condition, [&](const ExistenceCheck& exists) {
+                    std::vector<std::string> key;
+                    const auto& values = exists.getValues();
+                    for (std::size_t i = 0; i < values.size(); ++i) {
+                        if (!isUndefValue(values[i])) {
+                            key.push_back("tuple[" + std::to_string(i) + "]");
+                        }
+                    }
+                    std::string stripe = "StripedLock::stripe(StripedLock::EmptyHash)";
+                    if (!key.empty()) {
+                        stripe = "StripedLock::stripe({" + toString(join(key, ",")) + "})";
+                    }
+                    if (!contains(stripes, stripe)) {
+                        stripes.push_back(stripe);
+                    }
+                });
+                if (stripes.empty()) {
+                    stripes.push_back("StripedLock::AllStripes");
+                }
+                out << "auto lease = " << synthesiser.getRelationName(rel) << "_guard_lock.acquire("
+                    << join(stripes, " | ") << ");\n";
+            }
+
+            // guarded conditions
+            out << "if( ";
+            dispatch(*condition, out);
+            out << ") {\n";
+
             // insert tuple
-            out << relName << "->"
-                << "insert(tuple," << ctxName << ");\n";
+            emitInsert(*rel, ctxName, out);
 
             // end of conseq body.
             out << "}\n";
+            out << "}\n";
 
             PRINT_END_COMMENT(out);
         }
@@ -1784,7 +1973,6 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_BEGIN_COMMENT(out);
             const auto* rel = synthesiser.lookup(insert.getRelation());
             auto arity = rel->getArity();
-            auto relName = synthesiser.getRelationName(rel);
             auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(*rel) + ")";
 
             // create inserted tuple
@@ -1792,8 +1980,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 << "}};\n";
 
             // insert tuple
-            out << relName << "->"
-                << "insert(tuple," << ctxName << ");\n";
+            emitInsert(*rel, ctxName, out);
 
             PRINT_END_COMMENT(out);
         }
@@ -2845,6 +3032,10 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         mainClass.addField("std::string", "profiling_fname", Visibility::Public);
         constructor.setNextArg("std::string", "pf", std::make_optional("\"profile.log\""));
         constructor.setNextInitializer("profiling_fname", "std::move(pf)");
+        mainClass.addField("std::string", "profiling_trace_fname", Visibility::Public);
+        constructor.setNextArg("std::string", "ptf",
+                std::make_optional(raw_str(glb.config().get("profile-trace"))));
+        constructor.setNextInitializer("profiling_trace_fname", "std::move(ptf)");
     }
 
     // issue symbol table with string constants
@@ -2942,6 +3133,7 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
 
     if (glb.config().has("profile")) {
         constructor.body() << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
+        constructor.body() << "ProfileEventSingleton::instance().setTraceFile(profiling_trace_fname);\n";
     }
 
     for (const auto& f : functors) {
@@ -2994,8 +3186,14 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
     if (glb.config().has("profile")) {
         runFunction.body() << "ProfileEventSingleton::instance().startTimer();\n"
                            << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_"
-                           << '\n'
-                           << "{\n"
+                           << '\n';
+        if (glb.config().has("profile-counters")) {
+            // the counters are opened before the worker threads, which inherit them, are started
+            runFunction.body() << "profile::PerfCounters::instance().enable();\n"
+                               << R"_(ProfileEventSingleton::instance().makeConfigRecord("perf-counters", )_"
+                               << "toString(join(profile::PerfCounters::instance().getNames(), \",\")));\n";
+        }
+        runFunction.body() << "{\n"
                            << R"_(Logger logger("@runtime;", 0);)_" << '\n';
         // Store count of relations
         std::size_t relationCount = 0;
@@ -3017,6 +3215,13 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
     if (glb.config().has("profile")) {
         runFunction.body() << "}\n"
                            << "ProfileEventSingleton::instance().stopTimer();\n"
+                           << R"_(ProfileEventSingleton::instance().makeConfigRecord("lockRestarts", )_"
+                           << "std::to_string(souffle::detail::btreeLockRestarts()));\n"
+                           << "{ const auto symbolCache = symTable.getCacheStatistics();\n"
+                           << R"_(ProfileEventSingleton::instance().makeConfigRecord("symbolCacheHits", )_"
+                           << "std::to_string(symbolCache.hits()));\n"
+                           << R"_(ProfileEventSingleton::instance().makeConfigRecord("symbolCacheMisses", )_"
+                           << "std::to_string(symbolCache.misses())); }\n"
                            << "dumpFreqs();\n";
     }
 
@@ -3260,6 +3465,9 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         hook << raw_str("") << ",\n";
     }
     hook << std::stoi(glb.config().get("jobs"));
+    if (glb.config().has("profile")) {
+        hook << ",\n" << raw_str(glb.config().get("profile-trace"));
+    }
     hook << ");\n";
 
     hook << "if (!opt.parse(argc,argv)) return 1;\n";
@@ -3268,7 +3476,7 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         hook << db.getNS(false) << "::";
     }
     if (glb.config().has("profile")) {
-        hook << classname + " obj(opt.getProfileName());\n";
+        hook << classname + " obj(opt.getProfileName(), opt.getProfileTraceName());\n";
     } else {
         hook << classname + " obj;\n";
     }
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <iostream>
 #include <random>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -525,6 +526,38 @@ TEST(EqRelTest, IterPartition) {
     EXPECT_EQ(br.size(), values.size());
 }
 
+TEST(EqRelTest, IterPartitionMixed) {
+    // a large set among many small ones, split up by anterior elements
+    EqRel br;
+    for (RamDomain i = 0; i < 100; ++i) {
+        br.insert(1000, 1000 + i);
+    }
+    for (RamDomain i = 0; i < 300; i += 3) {
+        br.insert(i, i + 1);
+        br.insert(i + 2, i + 2);
+    }
+    EXPECT_EQ((std::size_t)100 * 100 + 100 * 4 + 100, br.size());
+
+    using PairSet = std::set<std::pair<RamDomain, RamDomain>>;
+    PairSet expected;
+    for (auto x : br) {
+        expected.insert(std::make_pair(x[0], x[1]));
+    }
+    EXPECT_EQ(br.size(), expected.size());
+
+    auto chunks = br.partition(50);
+    EXPECT_TRUE(chunks.size() > 100);
+
+    std::vector<std::pair<RamDomain, RamDomain>> values;
+    for (auto chunk : chunks) {
+        for (auto x : chunk) {
+            values.push_back(std::make_pair(x[0], x[1]));
+        }
+    }
+    EXPECT_EQ(br.size(), values.size());
+    EXPECT_TRUE(expected == PairSet(values.begin(), values.end()));
+}
+
 TEST(EqRelTest, Scaling) {
     const int N = 100;
 
@@ -570,6 +603,38 @@ TEST(EqRelTest, ParallelScaling) {
         throw std::runtime_error("here's a gdb trap");
     }
 }
+
+TEST(EqRelTest, ParallelUnion) {
+    // concurrent unions must keep the member lists and the number of pairs consistent
+    const int N = 100000;
+    std::vector<int> data(N);
+    for (int i = 0; i < N; ++i) {
+        data[i] = i;
+    }
+    std::mt19937 generator(3);
+    shuffle(data.begin(), data.end(), generator);
+
+    // pairs joining the elements into sets by their remainder modulo 7
+    EqRel br;
+#pragma omp parallel for
+    for (int i = 0; i < N; i++) {
+        br.insert(data[i], data[i] % 7);
+    }
+
+    std::size_t expected = 0;
+    for (int r = 0; r < 7; ++r) {
+        std::size_t s = N / 7 + (r < N % 7 ? 1 : 0);
+        expected += s * s;
+    }
+    EXPECT_EQ(expected, br.size());
+
+    std::size_t members = 0;
+    for (auto it = br.anteriorIt(5); it != br.end(); ++it) {
+        EXPECT_EQ(5, (*it)[1] % 7);
+        members++;
+    }
+    EXPECT_EQ((std::size_t)(N / 7), members);
+}
 #endif
 
 }  // namespace test
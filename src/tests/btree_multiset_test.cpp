@@ -365,6 +365,29 @@ TEST(BTreeMultiSet, Load) {
     }
 }
 
+TEST(BTreeMultiSet, InsertSorted) {
+    using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N : {0, 1, 10, 100, 1000, 10000}) {
+        test_set t;
+        std::multiset<int> ref;
+
+        // empty tree, similar sized and small ranges
+        for (int step : {3, 2, 700}) {
+            std::vector<int> data;
+            for (int i = 0; i < N * 2 / step; i++) {
+                data.push_back(i / 2 * step);
+            }
+            t.insertSorted(data.begin(), data.end());
+            ref.insert(data.begin(), data.end());
+        }
+
+        EXPECT_TRUE(t.check());
+        EXPECT_EQ(ref.size(), t.size());
+        EXPECT_TRUE(std::equal(ref.begin(), ref.end(), t.begin()));
+    }
+}
+
 TEST(BTreeMultiSet, Clear) {
     using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -484,6 +484,92 @@ TEST(BTreeSet, Load) {
     }
 }
 
+TEST(BTreeSet, LoadLarge) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    // multi-level trees, including all remainders of the last nodes
+    for (int N = 100; N < 2000; N += 37) {
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back(i);
+        }
+
+        auto t = test_set::load(data.begin(), data.end());
+        EXPECT_EQ(data.size(), t.size());
+        EXPECT_TRUE(t.check());
+        EXPECT_TRUE(std::equal(data.begin(), data.end(), t.begin()));
+
+        // the tree remains usable for insertions
+        t.insert(N);
+        t.insert(-1);
+        EXPECT_EQ(data.size() + 2, t.size());
+        EXPECT_TRUE(t.check());
+    }
+}
+
+TEST(BTreeSet, InsertAll) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    std::random_device rd;
+    std::mt19937 generator(rd());
+    std::uniform_int_distribution<int> distribution(0, 100000);
+
+    for (int N : {0, 1, 10, 1000, 100000}) {
+        test_set t;
+        std::set<int> ref;
+        for (int round = 0; round < 3; round++) {
+            std::vector<int> data;
+            for (int i = 0; i < N; i++) {
+                data.push_back(distribution(generator));
+            }
+            t.insertAll(data.begin(), data.end());
+            ref.insert(data.begin(), data.end());
+        }
+
+        EXPECT_TRUE(t.check());
+        EXPECT_EQ(ref.size(), t.size());
+        EXPECT_TRUE(std::equal(ref.begin(), ref.end(), t.begin()));
+    }
+}
+
+TEST(BTreeSet, InsertSorted) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    // covers the bulk-load, the rebuild and the parallel insertion of a sorted range
+    for (int N : {0, 1, 10, 100, 1000, 10000}) {
+        test_set t;
+        std::set<int> ref;
+
+        // empty tree, range containing duplicates
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back(i / 2 * 3);
+        }
+        t.insertSorted(data.begin(), data.end());
+        ref.insert(data.begin(), data.end());
+
+        // overlapping range of similar size
+        data.clear();
+        for (int i = 0; i < N; i++) {
+            data.push_back(i * 2);
+        }
+        t.insertSorted(data.begin(), data.end());
+        ref.insert(data.begin(), data.end());
+
+        // small range
+        data.clear();
+        for (int i = 0; i < N / 100; i++) {
+            data.push_back(i * 7 + 1);
+        }
+        t.insertSorted(data.begin(), data.end());
+        ref.insert(data.begin(), data.end());
+
+        EXPECT_TRUE(t.check());
+        EXPECT_EQ(ref.size(), t.size());
+        EXPECT_TRUE(std::equal(ref.begin(), ref.end(), t.begin()));
+    }
+}
+
 TEST(BTreeSet, Clear) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -576,6 +662,34 @@ TEST(BTreeSet, ChunkSplitStress) {
     }
 }
 
+TEST(BTreeSet, RangeSplit) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    test_set t;
+    EXPECT_TRUE(t.begin().split(t.end()) == t.end());
+
+    for (int i = 0; i < 1000; i++) {
+        t.insert(i);
+    }
+
+    for (int low = 0; low < 1000; low += 7) {
+        for (int high = low; high <= 1000; high += 13) {
+            auto a = t.lower_bound(low);
+            auto b = t.lower_bound(high);
+            auto mid = a.split(b);
+
+            // ranges with at least two elements are split into non-empty halves
+            if (high - low < 2) {
+                EXPECT_TRUE(mid == b);
+            } else {
+                EXPECT_TRUE(mid != b);
+                EXPECT_LT(low, *mid);
+                EXPECT_LT(*mid, high);
+            }
+        }
+    }
+}
+
 using Entry = std::tuple<int, int64_t>;
 
 std::vector<Entry> getData(unsigned numEntries) {
@@ -286,6 +286,44 @@ TEST(DjTest, UnionRoot) {
     }
 }
 
+// Concurrent unions keep the member lists, the set sizes and the number of pairs consistent
+TEST(DjTest, ParallelUnionMembers) {
+    const int numNodes = 10000;
+    const int numSets = 7;
+    souffle::DisjointSet ds;
+    for (int i = 0; i < numNodes; ++i) {
+        ds.makeNode();
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (int i = numSets; i < numNodes; ++i) {
+        // link to an earlier node with the same remainder, such that each remainder forms one set
+        const int earlier = (i * 31) % (i / numSets) * numSets + i % numSets;
+        ds.unionNodes(i, earlier);
+    }
+
+    std::size_t pairs = 0;
+    for (int root = 0; root < numNodes; ++root) {
+        if (!ds.isRoot(root)) {
+            continue;
+        }
+        std::size_t members = 0;
+        parent_t node = root;
+        do {
+            EXPECT_EQ(root % numSets, node % numSets);
+            EXPECT_EQ(root, ds.findNode(node));
+            ++members;
+            node = ds.nextInSet(node);
+        } while (node != static_cast<parent_t>(root) && members <= numNodes);
+        EXPECT_EQ(ds.setSize(root), members);
+        EXPECT_EQ(numNodes / numSets + (root % numSets < numNodes % numSets ? 1 : 0), members);
+        pairs += members * members;
+    }
+    EXPECT_EQ(pairs, ds.numPairs());
+}
+
 TEST(DjTest, ClearClear) {
     for (int i = 0; i < RANDOM_TESTS; ++i) {
         souffle::DisjointSet ds;
@@ -0,0 +1,244 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file gzfstream_test.cpp
+ *
+ * Tests the gzip file streams.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/io/gzfstream.h"
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <zlib.h>
+
+namespace souffle::test {
+
+namespace {
+
+std::string tempFile(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("souffle_gzfstream_test_" + name)).string();
+}
+
+/** Text of several members that does not compress to nothing. */
+std::string sampleText() {
+    std::stringstream text;
+    for (int i = 0; i < 300000; ++i) {
+        text << i << "\t" << (i * 31) % 1000 << "\tsymbol" << i % 97 << "\n";
+    }
+    return text.str();
+}
+
+std::string readAll(std::istream& in) {
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+/** Read a file through zlib alone, as gunzip would. */
+std::string readZlib(const std::string& filename) {
+    gzFile file = gzopen(filename.c_str(), "rb");
+    std::string text;
+    char buffer[4096];
+    int count;
+    while ((count = gzread(file, buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, count);
+    }
+    gzclose(file);
+    return text;
+}
+
+/** Write a file of members that record their size. */
+void writeMembers(const std::string& filename, const std::string& text) {
+    gzfstream::ogzfstream out(filename, std::ios::out | std::ios::binary, 1);
+    out.rdbuf()->setThreads(4);
+    out << text;
+}
+
+/** Write a file through zlib alone, as gzip would. */
+void writeZlib(const std::string& filename, const std::string& text) {
+    gzFile file = gzopen(filename.c_str(), "wb");
+    gzwrite(file, text.data(), static_cast<unsigned int>(text.size()));
+    gzclose(file);
+}
+
+std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::stringstream data;
+    data << file.rdbuf();
+    return data.str();
+}
+
+void writeFile(const std::string& filename, const std::string& data) {
+    std::ofstream file(filename, std::ios::binary);
+    file << data;
+}
+
+/** Read the lines of a stream that reports errors by exceptions; return the error, if any. */
+std::string readError(std::istream& in) {
+    in.exceptions(std::ios::badbit);
+    try {
+        std::string line;
+        while (std::getline(in, line)) {
+        }
+    } catch (std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+}  // namespace
+
+TEST(GZipStream, Members) {
+    const std::string text = sampleText();
+    EXPECT_LT(3 * gzfstream::internal::member::BlockSize, text.size());
+    const std::string filename = tempFile("members.gz");
+
+    {
+        gzfstream::ogzfstream out(filename, std::ios::out | std::ios::binary, 1);
+        out.rdbuf()->setThreads(4);
+        out << text;
+    }
+
+    // members are readable by zlib, and concurrently by the stream
+    EXPECT_EQ(text, readZlib(filename));
+    for (std::size_t threads : {1, 3}) {
+        gzfstream::igzfstream in(filename, std::ios::in | std::ios::binary);
+        in.rdbuf()->setThreads(threads);
+        EXPECT_EQ(text, readAll(in));
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(GZipStream, Levels) {
+    const std::string text = sampleText();
+    const std::string fast = tempFile("fast.gz");
+    const std::string best = tempFile("best.gz");
+    {
+        gzfstream::ogzfstream out(fast, std::ios::out | std::ios::binary, 1);
+        out << text;
+    }
+    {
+        gzfstream::ogzfstream out(best, std::ios::out | std::ios::binary, 9);
+        out << text;
+    }
+    EXPECT_LT(std::filesystem::file_size(best), std::filesystem::file_size(fast));
+    std::remove(fast.c_str());
+    std::remove(best.c_str());
+}
+
+TEST(GZipStream, Foreign) {
+    // files not written in members that record their size are read through zlib
+    const std::string text = sampleText();
+    const std::string filename = tempFile("foreign.gz");
+    gzFile file = gzopen(filename.c_str(), "wb");
+    gzwrite(file, text.data(), static_cast<unsigned int>(text.size()));
+    gzclose(file);
+
+    gzfstream::igzfstream in(filename, std::ios::in | std::ios::binary);
+    in.rdbuf()->setThreads(2);
+    EXPECT_EQ(text, readAll(in));
+
+    std::remove(filename.c_str());
+}
+
+TEST(GZipStream, Concatenated) {
+    // files of members of either writer, concatenated like `cat a.gz b.gz`
+    const std::string text = sampleText();
+    const std::string other = "other\ttext\n";
+    const std::string members = tempFile("concat_members.gz");
+    const std::string foreign = tempFile("concat_foreign.gz");
+    const std::string filename = tempFile("concat.gz");
+    writeMembers(members, text);
+    writeZlib(foreign, other);
+
+    const std::map<std::string, std::string> contents = {{members, text}, {foreign, other}};
+    for (const auto& files : {std::vector<std::string>{members, foreign, foreign},
+                 std::vector<std::string>{foreign, members}, std::vector<std::string>{members, members}}) {
+        std::string data;
+        std::string expected;
+        for (const auto& file : files) {
+            data += readFile(file);
+            expected += contents.at(file);
+        }
+        writeFile(filename, data);
+        EXPECT_EQ(expected, readZlib(filename));
+        for (std::size_t threads : {1, 3}) {
+            gzfstream::igzfstream in(filename, std::ios::in | std::ios::binary);
+            in.rdbuf()->setThreads(threads);
+            EXPECT_EQ(expected, readAll(in));
+        }
+    }
+
+    std::remove(members.c_str());
+    std::remove(foreign.c_str());
+    std::remove(filename.c_str());
+}
+
+TEST(GZipStream, Corrupt) {
+    const std::string text = sampleText();
+    const std::string members = tempFile("corrupt_members.gz");
+    const std::string foreign = tempFile("corrupt_foreign.gz");
+    const std::string filename = tempFile("corrupt.gz");
+    writeMembers(members, text);
+    writeZlib(foreign, text);
+
+    // damaged compressed data in a member that records its size, and in a member that does not
+    std::string data = readFile(members);
+    data[data.size() / 2] ^= 0x55;
+    data[data.size() / 2 + 1] ^= 0x55;
+    writeFile(filename, data);
+    {
+        gzfstream::igzfstream in(filename, std::ios::in | std::ios::binary);
+        in.rdbuf()->setThreads(2);
+        EXPECT_EQ("corrupt gzip member", readError(in));
+    }
+
+    data = readFile(members) + readFile(foreign);
+    data[data.size() - 100] ^= 0x55;
+    writeFile(filename, data);
+    {
+        gzfstream::igzfstream in(filename, std::ios::in | std::ios::binary);
+        EXPECT_EQ("corrupt gzip data", readError(in));
+    }
+
+    data.resize(data.size() - 100);
+    writeFile(filename, data);
+    {
+        gzfstream::igzfstream in(filename, std::ios::in | std::ios::binary);
+        in.rdbuf()->setThreads(2);
+        EXPECT_EQ("truncated gzip member", readError(in));
+    }
+
+    std::remove(members.c_str());
+    std::remove(foreign.c_str());
+    std::remove(filename.c_str());
+}
+
+TEST(GZipStream, Empty) {
+    const std::string filename = tempFile("empty.gz");
+    {
+        gzfstream::ogzfstream out(filename, std::ios::out | std::ios::binary);
+    }
+    EXPECT_EQ("", readZlib(filename));
+    gzfstream::igzfstream in(filename, std::ios::in | std::ios::binary);
+    EXPECT_EQ("", readAll(in));
+    std::remove(filename.c_str());
+}
+
+}  // namespace souffle::test
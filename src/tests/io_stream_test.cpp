@@ -0,0 +1,407 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file io_stream_test.cpp
+ *
+ * Tests the readers and writers of fact files.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/RecordTableImpl.h"
+#include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/io/ReadStreamBinary.h"
+#include "souffle/io/ReadStreamCSV.h"
+#include "souffle/io/WriteStreamBinary.h"
+#include "souffle/io/WriteStreamCSV.h"
+#ifdef USE_SQLITE
+#include "souffle/io/WriteStreamSQLite.h"
+#endif
+#include "souffle/utility/Iteration.h"
+#include "souffle/utility/json11.h"
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+namespace {
+
+std::string tempFile(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("souffle_io_stream_test_" + name)).string();
+}
+
+void writeFile(const std::string& fileName, const std::string& text) {
+    std::ofstream file(fileName, std::ios::binary);
+    file << text;
+}
+
+/** A relation keeping the tuples in the order they are inserted */
+struct TupleList {
+    explicit TupleList(std::size_t arity) : arity(arity) {}
+
+    void insert(const RamDomain* tuple) {
+        tuples.emplace_back(tuple, tuple + arity);
+    }
+
+    void insertBatch(std::vector<RamDomain>& batch) {
+        for (std::size_t i = 0; i < batch.size(); i += arity) {
+            insert(&batch[i]);
+        }
+    }
+
+    std::size_t size() const {
+        return tuples.size();
+    }
+
+    auto begin() const {
+        return tuples.begin();
+    }
+
+    auto end() const {
+        return tuples.end();
+    }
+
+    std::size_t arity;
+    std::vector<std::vector<RamDomain>> tuples;
+};
+
+/** A relation keeping the tuples in the order they are inserted, handing them out in ranges */
+struct PartitionedTupleList : public TupleList {
+    using Iter = std::vector<std::vector<RamDomain>>::const_iterator;
+
+    PartitionedTupleList(std::size_t arity, std::size_t rangeSize) : TupleList(arity), rangeSize(rangeSize) {}
+
+    std::vector<range<Iter>> partition() const {
+        std::vector<range<Iter>> res;
+        for (std::size_t i = 0; i < tuples.size(); i += rangeSize) {
+            const std::size_t end = std::min(i + rangeSize, tuples.size());
+            res.emplace_back(tuples.begin() + i, tuples.begin() + end);
+        }
+        return res;
+    }
+
+    std::size_t rangeSize;
+};
+
+std::string readFile(const std::string& fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+#ifdef USE_LIBZ
+/** Read a gzip file through zlib alone, as gunzip would */
+std::string readGZipFile(const std::string& fileName) {
+    std::string text;
+    gzFile file = gzopen(fileName.c_str(), "rb");
+    char buffer[4096];
+    int count = 0;
+    while ((count = gzread(file, buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, count);
+    }
+    gzclose(file);
+    return text;
+}
+#endif
+
+/** Directives of a relation with the given attribute types */
+std::map<std::string, std::string> directives(
+        const std::string& fileName, const std::vector<std::string>& attribsTypes) {
+    json11::Json types = json11::Json::object{
+            {"relation", json11::Json::object{{"arity", static_cast<long long>(attribsTypes.size())},
+                                 {"types", json11::Json::array(attribsTypes.begin(), attribsTypes.end())}}}};
+    std::string names;
+    for (std::size_t i = 0; i < attribsTypes.size(); ++i) {
+        names += (i == 0 ? "a" : "\ta") + std::to_string(i);
+    }
+    return {{"IO", "file"}, {"name", "test"}, {"filename", fileName}, {"auxArity", "0"},
+            {"attributeNames", names}, {"types", types.dump()}};
+}
+
+/** Lines of a number, a symbol and a negated number, some ending in CRLF, the last one without a break */
+std::string sampleFacts(int numLines) {
+    std::stringstream text;
+    for (int i = 0; i < numLines; ++i) {
+        text << i << "\tsymbol" << i % 7 << "\t" << -i;
+        if (i + 1 < numLines) {
+            text << (i % 5 == 0 ? "\r\n" : "\n");
+        }
+    }
+    return text.str();
+}
+
+}  // namespace
+
+TEST(ReadFileCSV, Chunks) {
+    const int numLines = 5000;
+    const std::string fileName = tempFile("chunks.facts");
+    writeFile(fileName, sampleFacts(numLines));
+#ifdef _OPENMP
+    // parse the chunks of each batch concurrently
+    omp_set_num_threads(4);
+#endif
+
+    // chunks of a few lines, such that most lines straddle a chunk boundary; 1 << 30 reads a single chunk
+    for (std::size_t chunkSize : {1, 7, 64, 1 << 30}) {
+        auto rwOperation = directives(fileName, {"i", "s", "i"});
+        rwOperation["chunkSize"] = std::to_string(chunkSize);
+        SymbolTableImpl symbolTable;
+        SpecializedRecordTable<0> recordTable;
+        TupleList relation(3);
+        ReadFileCSV(rwOperation, symbolTable, recordTable).readAll(relation);
+
+        ASSERT_TRUE(relation.tuples.size() == numLines);
+        for (int i = 0; i < numLines; ++i) {
+            const auto& tuple = relation.tuples[i];
+            EXPECT_EQ(i, tuple[0]);
+            EXPECT_EQ("symbol" + std::to_string(i % 7), symbolTable.decode(tuple[1]));
+            EXPECT_EQ(-i, tuple[2]);
+        }
+
+        // symbols are encoded in the order of the input, as if read line by line
+        for (int i = 0; i < 7; ++i) {
+            EXPECT_EQ(i, symbolTable.encode("symbol" + std::to_string(i)));
+        }
+    }
+    std::remove(fileName.c_str());
+}
+
+TEST(ReadFileCSV, ChunkErrors) {
+    const int numLines = 2000;
+    std::stringstream text;
+    for (int i = 1; i <= numLines; ++i) {
+        // errors in several chunks, the first one in line 1237
+        text << (i == 1237 || i == 1500 || i == 1900 ? "x" : std::to_string(i)) << "\tsymbol\n";
+    }
+    const std::string fileName = tempFile("errors.facts");
+    writeFile(fileName, text.str());
+#ifdef _OPENMP
+    // parse the chunks of each batch concurrently, such that later errors may be found first
+    omp_set_num_threads(4);
+#endif
+
+    for (std::size_t chunkSize : {16, 1 << 30}) {
+        auto rwOperation = directives(fileName, {"i", "s"});
+        rwOperation["chunkSize"] = std::to_string(chunkSize);
+        SymbolTableImpl symbolTable;
+        SpecializedRecordTable<0> recordTable;
+        TupleList relation(2);
+        std::string error;
+        try {
+            ReadFileCSV(rwOperation, symbolTable, recordTable).readAll(relation);
+        } catch (std::invalid_argument& e) {
+            error = e.what();
+        }
+        EXPECT_NE(std::string::npos, error.find("Error converting <x> in column 1 in line 1237;")) << error;
+        EXPECT_NE(std::string::npos, error.find("cannot parse fact file")) << error;
+    }
+    std::remove(fileName.c_str());
+}
+
+TEST(WriteFileCSV, PartitionedOrder) {
+    const std::string serialFile = tempFile("serial.csv");
+    const std::string parallelFile = tempFile("parallel.csv");
+#ifdef _OPENMP
+    // format the ranges concurrently
+    omp_set_num_threads(4);
+#endif
+
+    // many more tuples than in a range, the last range being a partial one
+    const RamDomain numTuples = 10000;
+    TupleList serial(3);
+    PartitionedTupleList parallel(3, 64);
+    std::stringstream expected;
+    expected << std::setprecision(std::numeric_limits<RamFloat>::max_digits10);
+    for (RamDomain i = 0; i < numTuples; ++i) {
+        const RamUnsigned u = static_cast<RamUnsigned>(i) * 2654435761u;
+        const RamFloat f = (i % 3 == 0) ? RamFloat(i) / 3 : RamFloat(-i) * RamFloat(1e-7) + RamFloat(1e30);
+        const std::vector<RamDomain> tuple = {i - numTuples / 2, ramBitCast(u), ramBitCast(f)};
+        serial.tuples.push_back(tuple);
+        parallel.tuples.push_back(tuple);
+        expected << i - numTuples / 2 << "\t" << u << "\t" << f << "\n";
+    }
+
+    SymbolTableImpl symbolTable;
+    SpecializedRecordTable<0> recordTable;
+    WriteFileCSV(directives(serialFile, {"i", "u", "f"}), symbolTable, recordTable).writeAll(serial);
+    WriteFileCSV(directives(parallelFile, {"i", "u", "f"}), symbolTable, recordTable).writeAll(parallel);
+
+    // the ranges are written in order, and the values as formatted by a stream
+    const std::string serialText = readFile(serialFile);
+    const std::string parallelText = readFile(parallelFile);
+    EXPECT_TRUE(serialText == parallelText);
+    EXPECT_TRUE(expected.str() == serialText);
+    std::remove(serialFile.c_str());
+    std::remove(parallelFile.c_str());
+}
+
+#ifdef USE_LIBZ
+TEST(WriteGZipFileCSV, PartitionedOrder) {
+    const std::string serialFile = tempFile("serial.csv.gz");
+    const std::string parallelFile = tempFile("parallel.csv.gz");
+#ifdef _OPENMP
+    // format and compress the ranges concurrently
+    omp_set_num_threads(4);
+#endif
+
+    // ranges of about a member each, behind a header written through the stream
+    const RamDomain numTuples = 200000;
+    TupleList serial(2);
+    PartitionedTupleList parallel(2, 60000);
+    std::stringstream expected;
+    expected << "a0\ta1\n";
+    for (RamDomain i = 0; i < numTuples; ++i) {
+        const std::vector<RamDomain> tuple = {i, i * 7 % 1000};
+        serial.tuples.push_back(tuple);
+        parallel.tuples.push_back(tuple);
+        expected << tuple[0] << "\t" << tuple[1] << "\n";
+    }
+
+    SymbolTableImpl symbolTable;
+    SpecializedRecordTable<0> recordTable;
+    auto serialDirectives = directives(serialFile, {"i", "i"});
+    auto parallelDirectives = directives(parallelFile, {"i", "i"});
+    serialDirectives["headers"] = parallelDirectives["headers"] = "true";
+    WriteGZipFileCSV(serialDirectives, symbolTable, recordTable).writeAll(serial);
+    WriteGZipFileCSV(parallelDirectives, symbolTable, recordTable).writeAll(parallel);
+
+    // both files decompress to the tuples in order, through zlib as well as through the reading stream
+    EXPECT_TRUE(expected.str() == readGZipFile(serialFile));
+    EXPECT_TRUE(expected.str() == readGZipFile(parallelFile));
+    gzfstream::igzfstream in(parallelFile, std::ios::in | std::ios::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    EXPECT_TRUE(expected.str() == text.str());
+    std::remove(serialFile.c_str());
+    std::remove(parallelFile.c_str());
+}
+#endif
+
+TEST(WriteFileBinary, RoundTrip) {
+    const std::string fileName = tempFile("round_trip.bin");
+    const auto rwOperation = directives(fileName, {"s", "i", "u", "f"});
+
+    SymbolTableImpl writeSymbols;
+    SpecializedRecordTable<0> recordTable;
+    TupleList written(4);
+    written.tuples.push_back({writeSymbols.encode("meow"), -3, 3, ramBitCast(RamFloat(0.5))});
+    written.tuples.push_back({writeSymbols.encode("woof"), 7, 1, ramBitCast(RamFloat(-1.5))});
+    written.tuples.push_back({writeSymbols.encode("meow"), 4, 0, ramBitCast(RamFloat(2))});
+    WriteFileBinary(rwOperation, writeSymbols, recordTable).writeAll(written);
+
+    // symbols are stored by value, hence may be read with different ordinals
+    SymbolTableImpl readSymbols;
+    readSymbols.encode("woof");
+    TupleList read(4);
+    ReadFileBinary(rwOperation, readSymbols, recordTable).readAll(read);
+
+    EXPECT_EQ(written.tuples.size(), read.tuples.size());
+    for (std::size_t i = 0; i < written.tuples.size() && i < read.tuples.size(); ++i) {
+        EXPECT_EQ(writeSymbols.decode(written.tuples[i][0]), readSymbols.decode(read.tuples[i][0]));
+        for (std::size_t j = 1; j < 4; ++j) {
+            EXPECT_EQ(written.tuples[i][j], read.tuples[i][j]);
+        }
+    }
+    std::remove(fileName.c_str());
+}
+
+TEST(WriteFileBinary, WriteError) {
+    // writes to /dev/full fail as if the disk was full
+    if (!std::filesystem::exists("/dev/full")) {
+        return;
+    }
+    SymbolTableImpl symbolTable;
+    SpecializedRecordTable<0> recordTable;
+    TupleList relation(2);
+    for (RamDomain i = 0; i < 100000; ++i) {
+        relation.tuples.push_back({i, -i});
+    }
+    std::string error;
+    try {
+        WriteFileBinary(directives("/dev/full", {"i", "i"}), symbolTable, recordTable).writeAll(relation);
+    } catch (std::invalid_argument& e) {
+        error = e.what();
+    }
+    EXPECT_EQ("Cannot write output file /dev/full", error);
+}
+
+#ifdef USE_SQLITE
+/** A writer that is given tuples but never closed, as when the program fails during the output */
+class AbortedWriteSQLite : public WriteStreamSQLite {
+public:
+    using WriteStreamSQLite::WriteStreamSQLite;
+
+    void write(const RamDomain* tuple) {
+        writeNextTuple(tuple);
+    }
+};
+
+/** The rows of the given view or table, joined by newlines */
+std::string queryRows(const std::string& fileName, const std::string& name) {
+    sqlite3* db = nullptr;
+    sqlite3_open(fileName.c_str(), &db);
+    sqlite3_stmt* statement = nullptr;
+    sqlite3_prepare_v2(db, ("SELECT * FROM '" + name + "';").c_str(), -1, &statement, nullptr);
+    std::string rows;
+    while (statement != nullptr && sqlite3_step(statement) == SQLITE_ROW) {
+        for (int i = 0; i < sqlite3_column_count(statement); ++i) {
+            rows += (i == 0 ? "" : "\t");
+            rows += reinterpret_cast<const char*>(sqlite3_column_text(statement, i));
+        }
+        rows += "\n";
+    }
+    sqlite3_finalize(statement);
+    sqlite3_close(db);
+    return rows;
+}
+
+TEST(WriteSQLite, Rollback) {
+    const std::string fileName = tempFile("rollback.sqlite");
+    std::remove(fileName.c_str());
+    const auto rwOperation = directives(fileName, {"s", "i"});
+
+    SymbolTableImpl symbolTable;
+    SpecializedRecordTable<0> recordTable;
+    TupleList written(2);
+    written.tuples.push_back({symbolTable.encode("meow"), 1});
+    written.tuples.push_back({symbolTable.encode("woof"), 2});
+    WriteStreamSQLite(rwOperation, symbolTable, recordTable).writeAll(written);
+    EXPECT_EQ("meow\t1\nwoof\t2\n", queryRows(fileName, "test"));
+
+    // a writer destroyed before it is closed leaves neither its tuples nor its symbols behind
+    {
+        AbortedWriteSQLite aborted(rwOperation, symbolTable, recordTable);
+        const RamDomain tuple[] = {symbolTable.encode("purr"), 3};
+        aborted.write(tuple);
+    }
+    EXPECT_EQ("meow\t1\nwoof\t2\n", queryRows(fileName, "test"));
+    EXPECT_EQ("1\tmeow\n2\twoof\n", queryRows(fileName, "__SymbolTable"));
+
+    // the next writer does not take the ids of the discarded symbols from the cache
+    written.tuples.push_back({symbolTable.encode("purr"), 3});
+    WriteStreamSQLite(rwOperation, symbolTable, recordTable).writeAll(written);
+    EXPECT_EQ("meow\t1\nwoof\t2\npurr\t3\n", queryRows(fileName, "test"));
+    std::remove(fileName.c_str());
+}
+#endif
+
+}  // namespace souffle::test
@@ -16,8 +16,12 @@
 
 #include "tests/test.h"
 
+#include "souffle/datastructure/BTree.h"
 #include "souffle/utility/ParallelUtil.h"
+#include "souffle/utility/WorkStealing.h"
+#include <atomic>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -42,6 +46,36 @@ TEST(ParallelUtils, SpinLock) {
     EXPECT_EQ(N, c);
 }
 
+TEST(ParallelUtils, StripedLock) {
+    const int N = 1000000;
+    const int K = 10;
+
+    StripedLock lock;
+
+    // one counter per key, and one guarded by all stripes
+    std::vector<int> counts(K);
+    volatile int c = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(4)
+#endif
+    for (int i = 0; i < N; i++) {
+        if (i % K == 0) {
+            auto lease = lock.acquire(StripedLock::AllStripes);
+            c++;
+        } else {
+            int key = i % K;
+            auto lease = lock.acquire(StripedLock::stripe({key}) | StripedLock::stripe({key, 0}));
+            counts[key]++;
+        }
+    }
+
+    EXPECT_EQ(N / K, c);
+    for (int key = 1; key < K; key++) {
+        EXPECT_EQ(N / K, counts[key]);
+    }
+}
+
 TEST(ParallelUtils, ReadWriteLock) {
     const int N = 1000000;
     const int K = 10;
@@ -99,5 +133,88 @@ TEST(ParallelUtils, OptimisticReadWriteLock) {
 
     EXPECT_EQ(2 * (N / K), c);
 }
+
+TEST(ParallelUtils, ParallelBranches) {
+    const std::size_t N = 10;
+    const int M = 1000;
+
+    std::atomic<int> total{0};
+    std::vector<int> branchSums(N, 0);
+
+    runParallelBranches(N, 4, [&](std::size_t branch) {
+        int sum = 0;
+        PARALLEL_START
+            int local = 0;
+            pfor(int i = 0; i < M; i++) {
+                local++;
+            }
+            total += local;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+            sum += local;
+        PARALLEL_END
+        branchSums[branch] = sum;
+    });
+
+    EXPECT_EQ(static_cast<int>(N) * M, total);
+    for (std::size_t i = 0; i < N; i++) {
+        EXPECT_EQ(M, branchSums[i]);
+    }
+}
+
+TEST(ParallelUtils, Sections) {
+    std::atomic<int> c{0};
+
+    SECTIONS_START;
+    SECTION_START;
+    c += 1;
+    SECTION_END
+    SECTION_START;
+    c += 2;
+    SECTION_END
+    SECTION_START;
+    c += 4;
+    SECTION_END
+    SECTIONS_END;
+
+    EXPECT_EQ(7, c);
+}
+
+TEST(ParallelUtils, WorkStealingRange) {
+    const int N = 100000;
+
+    btree_set<int> set;
+    std::vector<int> list;
+    for (int i = 0; i < N; i++) {
+        set.insert(i);
+        list.push_back(i);
+    }
+
+    // a splittable range covered by a single chunk, and a list of chunks that cannot be split
+    WorkStealingRange setRange(make_range(set.lower_bound(10), set.end()), 4);
+    WorkStealingRange listRange(make_range(list.begin(), list.end()).partition(3), 4);
+
+    std::vector<std::atomic<int>> seen(N);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(4)
+#endif
+    {
+        while (auto it = setRange.next()) {
+            for (int i : *it) {
+                seen[i]++;
+            }
+        }
+        while (auto it = listRange.next()) {
+            for (int i : *it) {
+                seen[i] += 2;
+            }
+        }
+    }
+
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(i < 10 ? 2 : 3, seen[i]);
+    }
+}
 }  // namespace test
 }  // end namespace souffle
@@ -17,10 +17,16 @@
 #include "tests/test.h"
 
 #include "souffle/profile/CellInterface.h"
+#include "souffle/profile/EventBuffer.h"
+#include "souffle/profile/PerfCounters.h"
+#include "souffle/profile/ProfileEvent.h"
 #include "souffle/profile/StringUtils.h"
+#include "souffle/profile/TraceWriter.h"
+#include "souffle/utility/json11.h"
 #include <chrono>
 #include <cmath>
 #include <iosfwd>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -138,3 +144,142 @@ TEST(StringUtil, cleanJsonOutDouble) {
     EXPECT_EQ("NaN", Tools::cleanJsonOut(NAN));
     EXPECT_EQ("1.234567e+02", Tools::cleanJsonOut(123.4567));
 }
+
+TEST(EventRing, PushDrain) {
+    EventRing ring;
+    EXPECT_TRUE(ring.empty());
+
+    // fill the ring, which then rejects further events
+    for (std::size_t i = 0; i < EventRing::Capacity; ++i) {
+        EventRecord record{};
+        record.values[0] = i;
+        EXPECT_TRUE(ring.push(record));
+    }
+    EXPECT_FALSE(ring.push(EventRecord{}));
+
+    std::size_t next = 0;
+    EXPECT_EQ(EventRing::Capacity, ring.drain([&](const EventRecord& record) {
+        EXPECT_EQ(next, record.values[0]);
+        next++;
+    }));
+    EXPECT_TRUE(ring.empty());
+
+    // events keep their order when wrapping around
+    for (std::size_t i = 0; i < 10; ++i) {
+        EventRecord record{};
+        record.values[0] = EventRing::Capacity + i;
+        EXPECT_TRUE(ring.push(record));
+    }
+    EXPECT_EQ(10, ring.drain([&](const EventRecord& record) {
+        EXPECT_EQ(next, record.values[0]);
+        next++;
+    }));
+}
+
+TEST(EventRing, Database) {
+    auto& events = ProfileEventSingleton::instance();
+
+    // overflow the ring of this thread with quantity events
+    const std::size_t n = EventRing::Capacity + 10;
+    for (std::size_t i = 0; i < n; ++i) {
+        events.makeQuantityEvent("@relation-reads;r" + std::to_string(i), i, 0);
+    }
+    events.makeTimingEvent("@t-nonrecursive-relation;test;test.dl [1:1-1:2];", time_point(microseconds(1)),
+            time_point(microseconds(3)), 4, 5, 6, 0);
+
+    const ProfileDatabase& db = events.getDB();
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::string relation = "r" + std::to_string(i);
+        auto* reads = as<SizeEntry>(db.lookupEntry({"program", "relation", relation, "reads"}));
+        EXPECT_NE(nullptr, reads);
+        EXPECT_EQ(i, reads->getSize());
+    }
+
+    auto* runtime = as<DurationEntry>(db.lookupEntry({"program", "relation", "test", "runtime"}));
+    EXPECT_NE(nullptr, runtime);
+    EXPECT_EQ(2, (runtime->getEnd() - runtime->getStart()).count());
+    auto* tuples = as<SizeEntry>(db.lookupEntry({"program", "relation", "test", "num-tuples"}));
+    EXPECT_NE(nullptr, tuples);
+    EXPECT_EQ(6, tuples->getSize());
+}
+
+TEST(TraceWriter, Spans) {
+    // timestamps are microseconds since the epoch, which exceed 32 bits
+    const long long base = 1LL << 40;
+    TraceWriter trace;
+    trace.addTiming(0, {"@t-recursive-relation", "path", "test.dl [2:1-2:5]", ""}, microseconds(base + 10),
+            microseconds(base + 30), 100, 7, 2);
+    trace.addTiming(1, {"@t-recursive-relation", "path", "test.dl [2:1-2:5]", ""}, microseconds(base + 30),
+            microseconds(base + 35), 120, 3, 3);
+    trace.addUtilisation(microseconds(base + 40), 150);
+
+    std::stringstream ss;
+    trace.print(ss);
+    std::string err;
+    json11::Json json = json11::Json::parse(ss.str(), err);
+    EXPECT_TRUE(err.empty());
+
+    std::size_t spans = 0;
+    std::size_t threads = 0;
+    long long lastSize = 0;
+    for (const auto& event : json["traceEvents"].array_items()) {
+        const std::string& phase = event["ph"].string_value();
+        if (phase == "M") {
+            threads++;
+        } else if (phase == "X") {
+            spans++;
+            EXPECT_EQ("iteration", event["cat"].string_value());
+            EXPECT_LT(base, event["ts"].long_value());
+            EXPECT_EQ(event["tid"].int_value() == 0 ? 20 : 5, event["dur"].int_value());
+        } else if (event["name"].string_value() == "size path") {
+            lastSize = (long long)event["args"]["tuples"].number_value();
+        }
+    }
+    EXPECT_EQ(2, spans);
+    EXPECT_EQ(2, threads);
+    EXPECT_EQ(10, lastSize);
+}
+
+TEST(PerfCounters, Database) {
+    auto& counters = PerfCounters::instance();
+    counters.enable();
+    EXPECT_TRUE(counters.isEnabled());
+    EXPECT_TRUE(counters.getNames().size() <= PerfCounters::MaxCounters);
+
+    const std::size_t scanned = counters.scannedTuples();
+    for (int i = 0; i < 5; ++i) {
+        PerfCounters::countTuple();
+    }
+    EXPECT_EQ(scanned + 5, counters.scannedTuples());
+
+    PerfCounters::Values values{{1, 2, 3, 4}};
+    auto& events = ProfileEventSingleton::instance();
+    events.makeCountersEvent("@p-nonrecursive-rule;c;c.dl [1:1-1:2];c(x) :- d(x).", values, 7, 0);
+    events.makeCountersEvent("@p-recursive-rule;c;1;c.dl [2:1-2:2];c(x) :- c(x).", values, 8, 3);
+
+    const ProfileDatabase& db = events.getDB();
+    auto* nonRecursive = as<SizeEntry>(db.lookupEntry({"program", "relation", "c", "non-recursive-rule",
+            "c(x) :- d(x).", "counters", "tuples-scanned"}));
+    EXPECT_NE(nullptr, nonRecursive);
+    EXPECT_EQ(7, nonRecursive->getSize());
+    auto* recursive = as<SizeEntry>(db.lookupEntry({"program", "relation", "c", "iteration", "3",
+            "recursive-rule", "c(x) :- c(x).", "1", "counters", "tuples-scanned"}));
+    EXPECT_NE(nullptr, recursive);
+    EXPECT_EQ(8, recursive->getSize());
+    for (std::size_t i = 0; i < counters.getNames().size(); ++i) {
+        auto* counter = as<SizeEntry>(db.lookupEntry({"program", "relation", "c", "non-recursive-rule",
+                "c(x) :- d(x).", "counters", counters.getNames()[i]}));
+        EXPECT_NE(nullptr, counter);
+        EXPECT_EQ(values[i], counter->getSize());
+    }
+}
+
+TEST(PerfCounters, Scale) {
+    // a counter running the whole time it was enabled is exact
+    EXPECT_EQ(100, PerfCounters::scale(100, 10, 10));
+    // a multiplexed counter is extrapolated to the whole time
+    EXPECT_EQ(300, PerfCounters::scale(100, 30, 10));
+    EXPECT_EQ(0, PerfCounters::scale(0, 30, 10));
+    // a counter that never ran has no estimate
+    EXPECT_EQ(0, PerfCounters::scale(100, 30, 0));
+}
@@ -29,6 +29,10 @@
 
 #include <cstddef>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace souffle::test {
 
 #define NUMBER_OF_TESTS 100
@@ -209,4 +213,66 @@ INSTANTIATE_TEMPLATE_TEST(PackUnpack, Vector, 11);
 INSTANTIATE_TEMPLATE_TEST(PackUnpack, Vector, 23);
 INSTANTIATE_TEMPLATE_TEST(PackUnpack, Vector, 59);
 
+#ifdef _OPENMP
+
+TEST(PackUnpack, Parallel) {
+    // pack records of specialized and generic arities from concurrent threads
+    const int N = 10000;
+    SpecializedRecordTable<2> recordTable(4);
+    std::vector<RamDomain> pairs(N);
+    std::vector<RamDomain> triples(N);
+
+    omp_set_num_threads(4);
+#pragma omp parallel for
+    for (int i = 0; i < N; ++i) {
+        pairs[i] = recordTable.pack({i, i + 1});
+        triples[i] = recordTable.pack({i, i + 1, i + 2});
+    }
+
+#pragma omp parallel for
+    for (int i = 0; i < N; ++i) {
+        EXPECT_EQ(pairs[i], recordTable.pack({i, i + 1}));
+        const RamDomain* pair = recordTable.unpack(pairs[i], 2);
+        EXPECT_EQ(i + 1, pair[1]);
+        const RamDomain* triple = recordTable.unpack(triples[i], 3);
+        EXPECT_EQ(i + 2, triple[2]);
+    }
+}
+
+TEST(PackUnpack, ParallelScaling) {
+    //        const int N = 10000000;     // real benchmark
+    const int N = 100000;  // to not run to long for unit testing
+    const int Records = 1000;
+
+    SpecializedRecordTable<2> recordTable;
+    std::vector<RamDomain> refs;
+    for (RamDomain i = 0; i < Records; ++i) {
+        refs.push_back(recordTable.pack({i, i + 1, i + 2}));
+        refs.push_back(recordTable.pack({i, i + 1}));
+    }
+
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        recordTable.setNumLanes(threads);
+        omp_set_num_threads(threads);
+        RamDomain sum = 0;
+
+        double start = omp_get_wtime();
+
+#pragma omp parallel for reduction(+ : sum)
+        for (int i = 0; i < N; ++i) {
+            const std::size_t r = (i % Records) * 2;
+            sum += recordTable.unpack(refs[r], 3)[2] + recordTable.unpack(refs[r + 1], 2)[1];
+        }
+
+        double end = omp_get_wtime();
+
+        std::cout << "Number of threads: " << threads << "[" << (end - start) << "s]\n";
+
+        // each record is unpacked N / Records times
+        EXPECT_EQ(static_cast<RamDomain>(N / Records) * (Records * Records + 2 * Records), sum);
+    }
+}
+
+#endif
+
 }  // namespace souffle::test
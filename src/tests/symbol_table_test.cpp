@@ -24,6 +24,7 @@
 #include <iostream>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef _OPENMP
@@ -111,4 +112,68 @@ TEST(SymbolTable, Inserts) {
     }
 }
 
+TEST(SymbolTable, Cache) {
+    SymbolTableImpl table;
+    std::vector<std::string> symbols;
+    for (int i = 0; i < RANDOM_TEST_SIZE; ++i) {
+        symbols.push_back(random_string() + "~" + std::to_string(i));
+    }
+    std::vector<RamDomain> indices;
+    for (const auto& s : symbols) {
+        indices.push_back(table.encode(s));
+    }
+    const auto before = table.getCacheStatistics();
+    EXPECT_EQ(before.encodeHits, std::size_t{0});
+    EXPECT_EQ(before.encodeMisses, symbols.size());
+
+    // repeated lookups are served by the cache and remain consistent
+    for (int i = 0; i < RANDOM_TESTS; ++i) {
+        for (std::size_t j = 0; j < symbols.size(); ++j) {
+            EXPECT_EQ(table.encode(std::string(symbols[j])), indices[j]);
+            EXPECT_STREQ(table.decode(indices[j]), symbols[j]);
+            bool was_new;
+            std::tie(std::ignore, was_new) = table.findOrInsert(symbols[j]);
+            EXPECT_TRUE(!was_new);
+        }
+    }
+    const auto after = table.getCacheStatistics();
+    EXPECT_LT(before.hits(), after.hits());
+    EXPECT_EQ(after.hits() + after.misses(),
+            before.hits() + before.misses() + 2 * RANDOM_TESTS * symbols.size());
+
+    // a second table must not see the entries cached for the first one
+    SymbolTableImpl other;
+    EXPECT_EQ(other.encode("other"), 0);
+    EXPECT_EQ(other.encode(symbols[0]), 1);
+    EXPECT_STREQ(other.decode(0), "other");
+    EXPECT_EQ(table.encode(symbols[0]), indices[0]);
+
+    // alternating between tables keeps the symbols cached for each of them
+    const auto tableBefore = table.getCacheStatistics();
+    const auto otherBefore = other.getCacheStatistics();
+    for (int i = 0; i < RANDOM_TESTS; ++i) {
+        EXPECT_EQ(table.encode(symbols[0]), indices[0]);
+        EXPECT_EQ(other.encode("other"), 0);
+    }
+    EXPECT_EQ(table.getCacheStatistics().misses(), tableBefore.misses());
+    EXPECT_EQ(other.getCacheStatistics().misses(), otherBefore.misses());
+    EXPECT_EQ(table.getCacheStatistics().hits(), tableBefore.hits() + RANDOM_TESTS);
+    EXPECT_EQ(other.getCacheStatistics().hits(), otherBefore.hits() + RANDOM_TESTS);
+}
+
+TEST(SymbolTable, CacheThreads) {
+    // the counts of threads that have exited are kept
+    SymbolTableImpl table;
+    const std::string symbol = "symbol";
+    for (int i = 0; i < 4; ++i) {
+        std::thread([&]() {
+            table.encode(symbol);
+            table.encode(symbol);
+        }).join();
+    }
+    const auto statistics = table.getCacheStatistics();
+    EXPECT_EQ(statistics.misses(), std::size_t{4});
+    EXPECT_EQ(statistics.hits(), std::size_t{4});
+}
+
 }  // namespace souffle::test
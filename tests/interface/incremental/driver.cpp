@@ -0,0 +1,104 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program for updating a Souffle program incrementally after
+ * its input relation changed
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <array>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Insert the given edges into relation "edge"
+ */
+void insertEdges(Relation* edge, const std::vector<std::array<RamSigned, 2>>& edges) {
+    for (const auto& input : edges) {
+        tuple t(edge);
+        t << input[0] << input[1];
+        edge->insert(t);
+    }
+}
+
+/**
+ * Print the content of relations "path" and "unreached"
+ */
+void printResult(SouffleProgram* prog, const std::string& step) {
+    std::cout << step << "\n";
+    if (Relation* path = prog->getRelation("path")) {
+        for (auto& output : *path) {
+            RamSigned src;
+            RamSigned dest;
+            output >> src >> dest;
+            std::cout << "path " << src << "-" << dest << "\n";
+        }
+    } else {
+        error("cannot find relation path");
+    }
+    if (Relation* unreached = prog->getRelation("unreached")) {
+        for (auto& output : *unreached) {
+            RamSigned node;
+            output >> node;
+            std::cout << "unreached " << node << "\n";
+        }
+    } else {
+        error("cannot find relation unreached");
+    }
+}
+
+/**
+ * Main program
+ */
+int main(int /* argc */, char** /* argv */) {
+    // create an instance of program "incremental"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("incremental")) {
+        if (Relation* edge = prog->getRelation("edge")) {
+            insertEdges(edge, {{1, 2}, {2, 3}, {4, 5}});
+            prog->run();
+            printResult(prog, "initial");
+
+            // added edges are propagated without recomputing path
+            insertEdges(edge, {{3, 4}});
+            prog->runIncremental();
+            printResult(prog, "insertion");
+
+            // removed edges require recomputing the affected strata
+            edge->purge();
+            insertEdges(edge, {{1, 2}, {4, 5}});
+            prog->runIncremental();
+            printResult(prog, "deletion");
+
+            // nothing changed
+            prog->runIncremental();
+            printResult(prog, "unchanged");
+
+            delete prog;
+        } else {
+            error("cannot find relation edge");
+        }
+    } else {
+        error("cannot find program incremental");
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program for looking up tuples of a Souffle program through
+ * its query subroutines, between incremental updates of the program
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Insert the given edges into relation "edge"
+ */
+void insertEdges(Relation* edge, const std::vector<std::array<RamSigned, 2>>& edges) {
+    for (const auto& input : edges) {
+        tuple t(edge);
+        t << input[0] << input[1];
+        edge->insert(t);
+    }
+}
+
+/**
+ * Print the tuples matching the given values of the bound attributes
+ */
+void printQuery(SouffleProgram* prog, const std::string& relation, const std::string& pattern,
+        const std::vector<RamDomain>& args) {
+    std::vector<RamDomain> ret;
+    prog->query(relation, pattern, args, ret);
+
+    // the tuples are returned with all their attributes, one after another
+    std::vector<std::vector<RamDomain>> tuples;
+    for (std::size_t i = 0; i < ret.size(); i += pattern.size()) {
+        tuples.emplace_back(ret.begin() + i, ret.begin() + i + pattern.size());
+    }
+    std::sort(tuples.begin(), tuples.end());
+
+    std::cout << relation << ":" << pattern;
+    for (RamDomain arg : args) {
+        std::cout << " " << arg;
+    }
+    std::cout << " ->";
+    for (const auto& tuple : tuples) {
+        std::cout << " (";
+        for (std::size_t i = 0; i < tuple.size(); i++) {
+            std::cout << (i > 0 ? "," : "") << tuple[i];
+        }
+        std::cout << ")";
+    }
+    std::cout << "\n";
+}
+
+/**
+ * Main program
+ */
+int main(int /* argc */, char** /* argv */) {
+    // create an instance of program "magic_incremental"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("magic_incremental")) {
+        if (Relation* edge = prog->getRelation("edge")) {
+            insertEdges(edge, {{1, 2}, {2, 3}, {4, 5}});
+            prog->run();
+            std::cout << "initial\n";
+            printQuery(prog, "path", "bf", {1});
+            printQuery(prog, "node", "b", {4});
+
+            // answers of earlier queries are evaluated again after an update
+            insertEdges(edge, {{3, 4}});
+            prog->runIncremental();
+            std::cout << "insertion\n";
+            printQuery(prog, "path", "bf", {1});
+            printQuery(prog, "node", "b", {4});
+
+            edge->purge();
+            insertEdges(edge, {{1, 2}, {4, 5}});
+            prog->runIncremental();
+            std::cout << "deletion\n";
+            printQuery(prog, "path", "bf", {1});
+            printQuery(prog, "path", "bf", {4});
+            printQuery(prog, "node", "b", {3});
+
+            // nothing changed
+            prog->runIncremental();
+            std::cout << "unchanged\n";
+            printQuery(prog, "path", "bf", {1});
+            printQuery(prog, "node", "b", {3});
+
+            delete prog;
+        } else {
+            error("cannot find relation edge");
+        }
+    } else {
+        error("cannot find program magic_incremental");
+    }
+}
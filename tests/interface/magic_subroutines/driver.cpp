@@ -0,0 +1,105 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file driver.cpp
+ *
+ * Driver program for looking up tuples of a Souffle program through
+ * its query subroutines
+ *
+ ***********************************************************************/
+
+#include "souffle/SouffleInterface.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+/**
+ * Error handler
+ */
+void error(std::string txt) {
+    std::cerr << "error: " << txt << "\n";
+    exit(1);
+}
+
+/**
+ * Print the tuples matching the given values of the bound attributes
+ */
+void printQuery(SouffleProgram* prog, const std::string& relation, const std::string& pattern,
+        const std::vector<RamDomain>& args) {
+    std::vector<RamDomain> ret;
+    prog->query(relation, pattern, args, ret);
+
+    // the tuples are returned with all their attributes, one after another
+    std::vector<std::vector<RamDomain>> tuples;
+    for (std::size_t i = 0; i < ret.size(); i += pattern.size()) {
+        tuples.emplace_back(ret.begin() + i, ret.begin() + i + pattern.size());
+    }
+    std::sort(tuples.begin(), tuples.end());
+
+    std::cout << relation << ":" << pattern;
+    for (RamDomain arg : args) {
+        std::cout << " " << arg;
+    }
+    std::cout << " ->";
+    for (const auto& tuple : tuples) {
+        std::cout << " (";
+        for (std::size_t i = 0; i < tuple.size(); i++) {
+            std::cout << (i > 0 ? "," : "") << tuple[i];
+        }
+        std::cout << ")";
+    }
+    std::cout << "\n";
+}
+
+/**
+ * Main program
+ */
+int main(int /* argc */, char** /* argv */) {
+    // create an instance of program "magic_subroutines"
+    if (SouffleProgram* prog = ProgramFactory::newInstance("magic_subroutines")) {
+        if (Relation* edge = prog->getRelation("edge")) {
+            const std::vector<std::array<RamSigned, 2>> edges = {{1, 2}, {2, 3}, {3, 1}, {3, 4}, {5, 6}};
+            for (const auto& input : edges) {
+                tuple t(edge);
+                t << input[0] << input[1];
+                edge->insert(t);
+            }
+            prog->run();
+
+            // relations only needed by queries are not part of the program
+            if (prog->getRelation("path") != nullptr) {
+                error("relation path is evaluated by the program");
+            }
+
+            printQuery(prog, "path", "bf", {1});
+            printQuery(prog, "path", "bf", {4});
+            printQuery(prog, "path", "fb", {4});
+            printQuery(prog, "path", "fb", {6});
+            printQuery(prog, "unreachable", "bf", {5});
+            printQuery(prog, "node", "b", {4});
+            printQuery(prog, "node", "b", {7});
+            printQuery(prog, "g.reach", "bf", {3});
+
+            // repeated queries are answered from the previous evaluation
+            printQuery(prog, "path", "bf", {1});
+            printQuery(prog, "path", "fb", {4});
+
+            delete prog;
+        } else {
+            error("cannot find relation edge");
+        }
+    } else {
+        error("cannot find program magic_subroutines");
+    }
+}